@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include "../time/Clock.h"
 #include <iostream>
 #include <cmath>
 
@@ -17,7 +18,7 @@ Camera::Camera(GLFWwindow* win, glm::vec3 startPosition, glm::vec3 startUp, floa
 void Camera::update() {
 
     // Get current time to calculate delta time
-    float currentFrame = static_cast<float>(glfwGetTime());
+    float currentFrame = static_cast<float>(Clock::now());
 
     // Calculate time difference between the current frame and the last frame
     float deltaTime = currentFrame - lastFrame;
@@ -41,9 +42,47 @@ glm::mat4 Camera::getViewMatrix() const {
 
 }
 
+// Returns the projection matrix for a framebuffer with the given aspect ratio
+glm::mat4 Camera::getProjectionMatrix(float aspectRatio) const {
+
+    // 60 degrees vertical field of view, seeing from 0.1 to 100 units away
+    return glm::perspective(glm::radians(60.0f), aspectRatio, 0.1f, 100.0f);
+
+}
+
+// Returns the camera's position in world space
+glm::vec3 Camera::getPosition() const {
+    return position;
+}
+
+// Returns the camera's yaw and pitch
+float Camera::getYaw() const {
+    return yaw;
+}
+
+float Camera::getPitch() const {
+    return pitch;
+}
+
+// Sets the camera's orientation directly, e.g. from a scripted camera path
+void Camera::setOrientation(float newYaw, float newPitch) {
+
+    yaw = newYaw;
+
+    // Limit pitch to prevent camera to flip-over
+    pitch = glm::clamp(newPitch, -89.0f, 89.0f);
+
+    updateCameraVectors();
+}
+
 // Process keyboard inputs to adjust the camera's orientation
 void Camera::processKeyboardInput(float deltaTime) {
 
+    // Without a window (headless mode) there is no keyboard
+    if (!window) {
+        return;
+    }
+
     // Adjust yaw (horizontal rotation) with right arrow key
     if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
         yaw -= rotationSpeed * deltaTime;
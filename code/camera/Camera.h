@@ -8,7 +8,7 @@
 class Camera {
 public:
     
-    // Constructor: initializes camera with position, orientation, and control parameters
+    // Constructor: initializes camera with position, orientation, and control parameters. A NULL window disables keyboard input
     Camera(GLFWwindow* window, glm::vec3 startPosition, glm::vec3 startUp, float startYaw, float startPitch);
 
     // Update camera's position and orientation based on user input and time
@@ -17,6 +17,19 @@ public:
     // Get the view matrix, representing the camera's point of view
     glm::mat4 getViewMatrix() const;
 
+    // Get the projection matrix for a framebuffer with the given aspect ratio (width / height)
+    glm::mat4 getProjectionMatrix(float aspectRatio) const;
+
+    // Get the camera's position in world space
+    glm::vec3 getPosition() const;
+
+    // Set the camera's yaw and pitch directly, e.g. from a scripted camera path
+    void setOrientation(float newYaw, float newPitch);
+
+    // Get the camera's yaw and pitch, e.g. to record them
+    float getYaw() const;
+    float getPitch() const;
+
 private:
     
     // Reference to the GLFW window for input handling
@@ -0,0 +1,82 @@
+#include "CameraPath.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Constructor: Creates the default path, a full orbit around the sun while tilting up and down
+CameraPath::CameraPath() {
+    keyframes = {
+        { 0.0f, -90.0f, 0.0f },
+        { 3.0f, 0.0f, 30.0f },
+        { 6.0f, 90.0f, 0.0f },
+        { 9.0f, 180.0f, -30.0f },
+        { 12.0f, 270.0f, 0.0f }
+    };
+}
+
+// Loads keyframes from a text file with one "time yaw pitch" line per keyframe
+bool CameraPath::load(const std::string& path) {
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::CAMERA_PATH::FILE_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<CameraKeyframe> loaded;
+    std::string line;
+    while (std::getline(file, line)) {
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        CameraKeyframe keyframe;
+        std::istringstream values(line);
+        if (!(values >> keyframe.time >> keyframe.yaw >> keyframe.pitch) || (!loaded.empty() && keyframe.time < loaded.back().time)) {
+            std::cerr << "ERROR::CAMERA_PATH::INVALID_KEYFRAME: " << line << std::endl;
+            return false;
+        }
+        loaded.push_back(keyframe);
+    }
+
+    if (loaded.empty()) {
+        std::cerr << "ERROR::CAMERA_PATH::NO_KEYFRAMES: " << path << std::endl;
+        return false;
+    }
+
+    keyframes.swap(loaded);
+    return true;
+}
+
+// Returns the orientation of the camera at the given time
+void CameraPath::sample(float time, float& yaw, float& pitch) const {
+
+    // Before the first keyframe
+    if (time <= keyframes.front().time) {
+        yaw = keyframes.front().yaw;
+        pitch = keyframes.front().pitch;
+        return;
+    }
+
+    // Interpolate between the two keyframes around the given time
+    for (size_t i = 1; i < keyframes.size(); ++i) {
+        const CameraKeyframe& from = keyframes[i - 1];
+        const CameraKeyframe& to = keyframes[i];
+        if (time < to.time) {
+            float t = (time - from.time) / (to.time - from.time);
+            yaw = from.yaw + t * (to.yaw - from.yaw);
+            pitch = from.pitch + t * (to.pitch - from.pitch);
+            return;
+        }
+    }
+
+    // After the last keyframe
+    yaw = keyframes.back().yaw;
+    pitch = keyframes.back().pitch;
+}
+
+// Time of the last keyframe
+float CameraPath::duration() const {
+    return keyframes.back().time;
+}
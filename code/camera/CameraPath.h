@@ -0,0 +1,44 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <string>
+#include <vector>
+
+// Orientation of the camera at a point in time
+struct CameraKeyframe {
+
+    // Time of the keyframe in seconds
+    float time;
+
+    // Horizontal angle (x-axis angle) of the camera
+    float yaw;
+
+    // Vertical angle (y-axis angle) of the camera
+    float pitch;
+
+};
+
+// A scripted camera movement, interpolated linearly between keyframes. Used instead of the keyboard in headless runs
+class CameraPath {
+
+public:
+
+    // Constructor: Creates the default path, a full orbit around the sun while tilting up and down
+    CameraPath();
+
+    // Loads keyframes from a text file with one "time yaw pitch" line per keyframe, sorted by time. Lines starting with '#' are ignored
+    bool load(const std::string& path);
+
+    // Returns the orientation of the camera at the given time. Times past the last keyframe keep its orientation
+    void sample(float time, float& yaw, float& pitch) const;
+
+    // Time of the last keyframe
+    float duration() const;
+
+private:
+
+    std::vector<CameraKeyframe> keyframes;
+
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "CameraUniforms.h"
+#include "../shader/ShaderProgram.h"
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock must match the std140 layout of the Camera block");
+
+// Constructor: Creates the buffer and binds it to the camera block's binding point
+CameraUniforms::CameraUniforms() {
+
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, ShaderProgram::cameraBlockBinding, UBO);
+}
+
+// Uploads the camera data of the frame
+void CameraUniforms::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position) {
+
+    CameraBlock block;
+    block.view = view;
+    block.projection = projection;
+    block.position = glm::vec4(position, 1.0f);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Destructor: Deletes the buffer
+CameraUniforms::~CameraUniforms() {
+
+    if (UBO)
+        glDeleteBuffers(1, &UBO);
+}
@@ -0,0 +1,46 @@
+#ifndef CAMERA_UNIFORMS_H
+#define CAMERA_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Contents of the "Camera" uniform block, laid out following the std140 rules
+struct CameraBlock {
+
+    // View matrix, transforming world coordinates to camera coordinates
+    glm::mat4 view;
+
+    // Projection matrix, projecting camera coordinates onto the screen
+    glm::mat4 projection;
+
+    // Position of the camera in world coordinates (w is unused)
+    glm::vec4 position;
+
+};
+
+// Uniform buffer holding the camera data of the current frame. Updated once per frame and read by every
+// shader program through its "Camera" block, instead of uploading the matrices to each program separately
+class CameraUniforms {
+
+public:
+
+    // Constructor: Creates the buffer and binds it to ShaderProgram::cameraBlockBinding. Requires a current GL context
+    CameraUniforms();
+
+    CameraUniforms(const CameraUniforms&) = delete;
+    CameraUniforms& operator=(const CameraUniforms&) = delete;
+
+    // Uploads the camera data of the frame
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+    // Destructor: Deletes the buffer
+    ~CameraUniforms();
+
+private:
+
+    // OpenGL identifier for the Uniform Buffer Object
+    unsigned int UBO = 0;
+
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+
+namespace {
+
+// Nodes with at most this many objects are not split further
+const uint32_t leafSize = 4;
+
+}
+
+// Builds the tree over the spheres
+void BoundingVolumeHierarchy::build(const std::vector<BoundingSphere>& objectSpheres) {
+
+    spheres = objectSpheres;
+    objects.resize(spheres.size());
+    for (uint32_t i = 0; i < objects.size(); ++i) {
+        objects[i] = i;
+    }
+
+    nodes.clear();
+    if (!objects.empty()) {
+        nodes.reserve(2 * objects.size() / leafSize + 1);
+        buildNode(0, static_cast<uint32_t>(objects.size()));
+    }
+}
+
+// Builds the node covering objects [first, last), splitting at the median along the longest axis of its centers
+void BoundingVolumeHierarchy::buildNode(uint32_t first, uint32_t last) {
+
+    uint32_t node = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(Node());
+
+    // Bounds of the spheres, and of their centers
+    glm::vec3 minimum(spheres[objects[first]].center - glm::vec3(spheres[objects[first]].radius));
+    glm::vec3 maximum(spheres[objects[first]].center + glm::vec3(spheres[objects[first]].radius));
+    glm::vec3 centerMinimum = spheres[objects[first]].center;
+    glm::vec3 centerMaximum = centerMinimum;
+    for (uint32_t i = first + 1; i < last; ++i) {
+        const BoundingSphere& sphere = spheres[objects[i]];
+        minimum = glm::min(minimum, sphere.center - glm::vec3(sphere.radius));
+        maximum = glm::max(maximum, sphere.center + glm::vec3(sphere.radius));
+        centerMinimum = glm::min(centerMinimum, sphere.center);
+        centerMaximum = glm::max(centerMaximum, sphere.center);
+    }
+    nodes[node].minimum = minimum;
+    nodes[node].maximum = maximum;
+    nodes[node].firstObject = first;
+    nodes[node].objectCount = last - first;
+    nodes[node].rightChild = 0;
+
+    if (last - first <= leafSize) {
+        return;
+    }
+
+    // Split at the median along the longest axis
+    glm::vec3 extent = centerMaximum - centerMinimum;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    uint32_t middle = first + (last - first) / 2;
+    std::nth_element(objects.begin() + first, objects.begin() + middle, objects.begin() + last, [&](uint32_t a, uint32_t b) {
+        return spheres[a].center[axis] < spheres[b].center[axis];
+    });
+
+    buildNode(first, middle);
+    nodes[node].rightChild = static_cast<uint32_t>(nodes.size());
+    buildNode(middle, last);
+}
+
+// Walks the tree, skipping the subtrees outside the frustum and accepting those inside it whole
+size_t BoundingVolumeHierarchy::query(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+
+    if (nodes.empty()) {
+        return 0;
+    }
+
+    size_t visibleBefore = visible.size();
+    uint32_t stack[64];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+
+        uint32_t nodeIndex = stack[--stackSize];
+        const Node& node = nodes[nodeIndex];
+        FrustumTest test = frustum.classify(node.minimum, node.maximum);
+        if (test == FrustumTest::Outside) {
+            continue;
+        }
+
+        if (test == FrustumTest::Inside) {
+            visible.insert(visible.end(), objects.begin() + node.firstObject, objects.begin() + node.firstObject + node.objectCount);
+        }
+        else if (node.rightChild == 0) {
+            for (uint32_t i = node.firstObject; i < node.firstObject + node.objectCount; ++i) {
+                if (frustum.intersects(spheres[objects[i]])) {
+                    visible.push_back(objects[i]);
+                }
+            }
+        }
+        else {
+            // Right first, so that the left subtree is visited first and the objects come out in tree order
+            stack[stackSize++] = node.rightChild;
+            stack[stackSize++] = nodeIndex + 1;
+        }
+    }
+    return visible.size() - visibleBefore;
+}
+
+size_t BoundingVolumeHierarchy::objectCount() const {
+    return objects.size();
+}
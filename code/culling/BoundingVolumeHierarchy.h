@@ -0,0 +1,48 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "Frustum.h"
+#include <cstdint>
+#include <vector>
+
+// Binary tree of axis-aligned boxes over a fixed set of bounding spheres, for culling many static objects at once.
+// A box outside the frustum culls its whole subtree with one test, and a box fully inside accepts it without further tests
+class BoundingVolumeHierarchy {
+
+public:
+
+    // Builds the tree over the spheres. Object i of the queries is sphere i
+    void build(const std::vector<BoundingSphere>& spheres);
+
+    // Appends the index of every object whose sphere intersects the frustum to 'visible', in a fixed order. Returns their number
+    size_t query(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    // Number of objects
+    size_t objectCount() const;
+
+private:
+
+    // A node covers the objects [firstObject, firstObject + objectCount) of 'objects'. Its left child follows it, and
+    // 'rightChild' is 0 for leaves
+    struct Node {
+        glm::vec3 minimum;
+        uint32_t firstObject;
+        glm::vec3 maximum;
+        uint32_t objectCount;
+        uint32_t rightChild;
+    };
+
+    std::vector<Node> nodes;
+
+    // Object indices, ordered so that every node's objects are contiguous
+    std::vector<uint32_t> objects;
+
+    // Spheres of the objects, by object index
+    std::vector<BoundingSphere> spheres;
+
+    // Builds the node covering objects [first, last) and its subtree
+    void buildNode(uint32_t first, uint32_t last);
+
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "Frustum.h"
+#include <cmath>
+
+// Constructor: Creates a frustum containing everything, with planes that every point is inside of
+Frustum::Frustum() {
+    for (glm::vec4& plane : planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+// Constructor: Extracts the planes from the rows of projection * view (Gribb and Hartmann)
+Frustum::Frustum(const glm::mat4& viewProjection) {
+
+    // glm matrices are column-major: row i is made of element i of every column
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    // Left, right, bottom, top, near and far
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+
+    // Normalize the planes, so that their equations give distances
+    for (glm::vec4& plane : planes) {
+        float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        plane = plane * (1.0f / length);
+    }
+}
+
+// A sphere is outside if it lies entirely behind one of the planes
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+    for (const glm::vec4& plane : planes) {
+        if (plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tests the corner of the box farthest along each plane's normal, then the nearest one
+FrustumTest Frustum::classify(const glm::vec3& minimum, const glm::vec3& maximum) const {
+
+    FrustumTest result = FrustumTest::Inside;
+    for (const glm::vec4& plane : planes) {
+
+        // If even the farthest corner is behind the plane, the whole box is
+        glm::vec3 farthest(plane.x >= 0.0f ? maximum.x : minimum.x, plane.y >= 0.0f ? maximum.y : minimum.y, plane.z >= 0.0f ? maximum.z : minimum.z);
+        if (plane.x * farthest.x + plane.y * farthest.y + plane.z * farthest.z + plane.w < 0.0f) {
+            return FrustumTest::Outside;
+        }
+
+        // If the nearest corner is behind the plane, the box straddles it
+        glm::vec3 nearest(plane.x >= 0.0f ? minimum.x : maximum.x, plane.y >= 0.0f ? minimum.y : maximum.y, plane.z >= 0.0f ? minimum.z : maximum.z);
+        if (plane.x * nearest.x + plane.y * nearest.y + plane.z * nearest.z + plane.w < 0.0f) {
+            result = FrustumTest::Intersecting;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,67 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include "../mesh/MeshData.h"
+
+// Result of testing a volume against a frustum
+enum class FrustumTest {
+    Outside,
+    Intersecting,
+    Inside
+};
+
+// Number of objects drawn and skipped by culling during a frame, number of triangles drawn, the largest error
+// of the drawn vertices' quantized positions on the screen, in pixels, and the draw calls and binds issued
+struct CullingCounters {
+
+    unsigned int visible = 0;
+
+    unsigned int culled = 0;
+
+    unsigned long triangles = 0;
+
+    float vertexErrorPixels = 0.0f;
+
+    unsigned int drawCalls = 0;
+
+    unsigned int stateChanges = 0;
+
+    // Keeps the largest error of a mesh's vertices on the screen, its error as a fraction of the bounding radius times
+    // the radius in pixels. A camera inside the bounds has no finite bound and is skipped
+    void addVertexError(float quantizationError, float projectedRadius) {
+        float pixels = quantizationError * projectedRadius;
+        if (quantizationError > 0.0f && std::isfinite(pixels)) {
+            vertexErrorPixels = std::max(vertexErrorPixels, pixels);
+        }
+    }
+
+};
+
+// The six planes bounding what a camera sees, extracted from its view-projection matrix. Planes point inwards
+class Frustum {
+
+public:
+
+    // Constructor: Creates a frustum containing everything
+    Frustum();
+
+    // Constructor: Extracts the planes of projection * view
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // Whether any part of a sphere can be inside the frustum. Spheres near a corner may be reported visible while outside
+    bool intersects(const BoundingSphere& sphere) const;
+
+    // Classifies an axis-aligned box as outside, partly inside or fully inside the frustum
+    FrustumTest classify(const glm::vec3& minimum, const glm::vec3& maximum) const;
+
+private:
+
+    // Normal (xyz) and offset (w) of each plane: points p with dot(normal, p) + offset >= 0 are on the inner side
+    glm::vec4 planes[6];
+
+};
+
+#endif
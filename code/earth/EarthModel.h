@@ -3,88 +3,81 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <assimp/scene.h>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
+#include "../resources/ResourceCache.h"
+#include "../mesh/LevelOfDetail.h"
+#include "../render/IndirectRenderer.h"
+#include "../render/RenderQueue.h"
+#include "../scene/BatchTransform.h"
 
 class EarthModel {
 
 public:
 
-    // Constructor: Initializes a new instance of SunModel with paths for model, shaders, and texture
-    EarthModel(const std::string& modelPath, const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& texturePath);
+    // Constructor: Initializes a new instance of EarthModel with paths for model and texture, and its material, loaded through the resource cache
+    EarthModel(ResourceCache& resources, const std::string& modelPath, Material material, const std::string& texturePath);
 
-    // Returns the current position of the Earth. Needed by Moon
-    glm::vec3 getEarthPosition() const;
+    // Models hold references to shared resources, so they cannot be copied
+    EarthModel(const EarthModel&) = delete;
+    EarthModel& operator=(const EarthModel&) = delete;
 
-    // Renders the earth model
-    void render(const glm::mat4& viewMatrix);
+    // Places the mesh at the earth's position as body 'index' of the batch, spun to its angle at the given simulated time and
+    // scaled down, to be placed with the other bodies by computeBatchTransforms()
+    void placeMesh(TransformBatch& batch, size_t index, const glm::vec3& position, double simulatedTime) const;
 
-    // Destructor: Cleans up resources
-    ~EarthModel();
-
-private:
-
-    // Stores the vertex data of the model
-    std::vector<float> vertices;
+    // Sphere enclosing the mesh in model coordinates, for culling
+    const BoundingSphere& bounds() const;
 
-    // OpenGL identifiers for Vertex Array Object and Vertex Buffer Object
-    unsigned int VAO, VBO;
+    // Chooses the level of detail drawn by render(), from the model's bounding sphere in world coordinates
+    void selectLevel(const LevelOfDetailView& view, const BoundingSphere& worldBounds);
 
-    // Number of vertices, set during processMesh() and used in render()
-    unsigned int vertexCount;
+    // Number of triangles drawn by render()
+    unsigned int triangleCount() const;
 
-    // OpenGL identifier for the texture
-    unsigned int texture;
+    // Largest error of the mesh's quantized positions, as a fraction of its bounding radius. 0 for meshes of floats
+    float quantizationError() const;
 
-    // Identifier for the compiled and linked shader program
-    unsigned int shaderProgram;
+    // Whether the mesh and the texture are uploaded. Models requested while the asset loader runs are drawn only once they are
+    bool isLoaded() const;
 
-    // Timestamp of the last update for animations
-    float lastUpdateTime;
+    // Submits the earth model to the render queue with the transform computed from its placeMesh(). It is drawn by the queue's execute(), with
+    // the camera of the shared camera uniform buffer
+    void render(RenderQueue& queue, const BodyTransform& transform) const;
 
-    // Angle of Earth's rotation
-    float rotationAngle;
+    // Queues the selected level of detail with the transform computed from its placeMesh(), to be drawn by the renderer's next submit()
+    void queueDraw(IndirectRenderer& renderer, const BodyTransform& transform) const;
 
-    // Speed of Earth's self-rotation
-    float rotationSpeed;
+    // Destructor: Cleans up resources
+    ~EarthModel();
 
-    // Radius of Earth's orbit around the Sun
-    float orbitRadius;
+private:
 
-    // Speed of Earth's orbit around the Sun
-    float orbitSpeed;
+    // Cache that owns the shared mesh, texture and shader program
+    ResourceCache& resources;
 
-    // Current angle of Earth's orbit
-    float orbitAngle;
+    // Mesh of the model, shared with every model loaded from the same file
+    const MeshResource* mesh;
 
-    // Current position of Earth in the orbit. Neeeded by Moon
-    glm::vec3 earthPosition;
+    // Texture of the model, shared with every model using the same image
+    const TextureResource* texture;
 
-    // Flag to toggle pause-state of the animation
-    bool isPaused ;
+    // Material of the model, and its program, shared with every model of the same material
+    Material material;
+    const ProgramResource* program;
 
-    // Tracks if the space key was pressed in the last frame
-    bool wasSpacePressed ;
-    
-    // Processes an individual mesh of the model
-    void processMesh(aiMesh* mesh, const aiScene* scene);
+    // Level of detail of the mesh drawn by render(), kept between frames for hysteresis
+    unsigned int level = 0;
 
-    // Sets up the vertex buffers and attributes
-    void setupBuffers();
 
-    // Loads the model from a given file path
-    void loadModel(const std::string& path);
+    // Angle of Earth's rotation at simulated time 0
+    float rotationAngle;
 
-    // Compiles and links the vertex and fragment shaders
-    void compileShaders(const std::string& vertexPath, const std::string& fragmentPath);
+    // Speed of Earth's self-rotation, in degrees per simulated second
+    float rotationSpeed;
 
-    // Loads a texture from a given file path
-    void loadTexture(const std::string& texturePath);
 
-    // Sets up the transformation matrices for the model
-    void setupMatrices();
 
 };
 
@@ -0,0 +1,406 @@
+#include "Ephemeris.h"
+#include "../math/SimdTrigonometry.h"
+#include "../threading/ThreadPool.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const double degreesToRadians = pi / 180.0;
+
+// Days per Julian century, the time unit of the elements and of the lunar theory
+const double daysPerCentury = 36525.0;
+
+// Kilometers per astronomical unit
+const double kilometersPerAu = 149597870.7;
+
+// Ratio of the mass of the Earth to the mass of the Moon
+const double earthMoonMassRatio = 81.30057;
+
+// General precession in longitude, in degrees per Julian century, to carry the Moon's longitude of date to the equinox of J2000
+const double precessionPerCentury = 1.3969713;
+
+// Newton iterations solving the Kepler equation. The first guess is within e^2 / 2 of the solution, so 4 reach float precision for e < 0.25
+const int keplerIterations = 4;
+
+const char* const planetNames[planetCount] = { "Mercury", "Venus", "Earth-Moon", "Mars", "Jupiter", "Saturn", "Uranus", "Neptune" };
+
+// JPL approximate Keplerian elements: the value at J2000 (first row) and the rate per Julian century (second row), one column per planet.
+// Standish, "Keplerian Elements for Approximate Positions of the Major Planets", table 1, fitted to DE405 from 1800 to 2050
+
+// Semi-major axis, in AU
+const double semiMajorAxes[2][planetCount] = {
+    { 0.38709927, 0.72333566, 1.00000261, 1.52371034, 5.20288700, 9.53667594, 19.18916464, 30.06992276 },
+    { 0.00000037, 0.00000390, 0.00000562, 0.00001847, -0.00011607, -0.00125060, -0.00196176, 0.00026291 }
+};
+
+// Eccentricity
+const double eccentricities[2][planetCount] = {
+    { 0.20563593, 0.00677672, 0.01671123, 0.09339410, 0.04838624, 0.05386179, 0.04725744, 0.00859048 },
+    { 0.00001906, -0.00004107, -0.00004392, 0.00007882, -0.00013253, -0.00050991, -0.00004397, 0.00005105 }
+};
+
+// Inclination to the ecliptic, in degrees
+const double inclinations[2][planetCount] = {
+    { 7.00497902, 3.39467605, -0.00001531, 1.84969142, 1.30439695, 2.48599187, 0.77263783, 1.77004347 },
+    { -0.00594749, -0.00078890, -0.01294668, -0.00813131, -0.00183714, 0.00193609, -0.00242939, 0.00035372 }
+};
+
+// Mean longitude, in degrees
+const double meanLongitudes[2][planetCount] = {
+    { 252.25032350, 181.97909950, 100.46457166, -4.55343205, 34.39644051, 49.95424423, 313.23810451, -55.12002969 },
+    { 149472.67411175, 58517.81538729, 35999.37244981, 19140.30268499, 3034.74612775, 1222.49362201, 428.48202785, 218.45945325 }
+};
+
+// Longitude of the perihelion, in degrees
+const double perihelionLongitudes[2][planetCount] = {
+    { 77.45779628, 131.60246718, 102.93768193, -23.94362959, 14.72847983, 92.59887831, 170.95427630, 44.96476227 },
+    { 0.16047689, 0.00268329, 0.32327364, 0.44441088, 0.21252668, -0.41897216, 0.40805281, -0.32241464 }
+};
+
+// Longitude of the ascending node, in degrees
+const double nodeLongitudes[2][planetCount] = {
+    { 48.33076593, 76.67984255, 0.0, 49.55953891, 100.47390909, 113.66242448, 74.01692503, 131.78422574 },
+    { -0.12534081, -0.27769418, 0.0, -0.29257343, 0.20469106, -0.28867794, 0.04240589, -0.00508664 }
+};
+
+// Number of periodic terms of each series of the lunar theory, a multiple of 4 so that the SSE loop needs no remainder
+const size_t lunarTermCount = 60;
+
+// Periodic terms of the Moon's longitude and distance (Meeus, table 47.A), as a structure of arrays. Each term is the sine (longitude, in
+// millionths of a degree) or the cosine (distance, in kilometers) of a combination of the mean elongation D, the Sun's mean anomaly M, the Moon's
+// mean anomaly M' and its argument of latitude F
+const float longitudeD[lunarTermCount] = {
+    0, 2, 2, 0, 0, 0, 2, 2, 2, 2, 0, 1, 0, 2, 0, 0, 4, 0, 4, 2, 2, 1, 1, 2, 2, 4, 2, 0, 2, 2,
+    1, 2, 0, 0, 2, 2, 2, 4, 0, 3, 2, 4, 0, 2, 2, 2, 4, 0, 4, 1, 2, 0, 1, 3, 4, 2, 0, 1, 2, 2
+};
+const float longitudeM[lunarTermCount] = {
+    0, 0, 0, 0, 1, 0, 0, -1, 0, -1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, -1, 0, 0, 0, 1, 0, -1,
+    0, -2, 1, 2, -2, 0, 0, -1, 0, 0, 1, -1, 2, 2, 1, -1, 0, 0, -1, 0, 1, 0, 1, 0, 0, -1, 2, 1, 0, 0
+};
+const float longitudeMp[lunarTermCount] = {
+    1, -1, 0, 2, 0, 0, -2, -1, 1, 0, -1, 0, 1, 0, 1, 1, -1, 3, -2, -1, 0, -1, 0, 1, 2, 0, -3, -2, -1, -2,
+    1, 0, 2, 0, -1, 1, 0, -1, 2, -1, 1, -2, -1, -1, -2, 0, 1, 4, 0, -2, 0, 2, 1, -2, -3, 2, 1, -1, 3, -1
+};
+const float longitudeF[lunarTermCount] = {
+    0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, -2, 2, -2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0,
+    0, 0, 0, 0, 0, -2, 2, 0, 2, 0, 0, 0, 0, 0, 0, -2, 0, 0, 0, 0, -2, -2, 0, 0, 0, 0, 0, 0, 0, -2
+};
+const float longitudeSine[lunarTermCount] = {
+    6288774, 1274027, 658314, 213618, -185116, -114332, 58793, 57066, 53322, 45758,
+    -40923, -34720, -30383, 15327, -12528, 10980, 10675, 10034, 8548, -7888,
+    -6766, -5163, 4987, 4036, 3994, 3861, 3665, -2689, -2602, 2390,
+    -2348, 2236, -2120, -2069, 2048, -1773, -1595, 1215, -1110, -892,
+    -810, 759, -713, -700, 691, 596, 549, 537, 520, -487,
+    -399, -381, 351, -340, 330, 327, -323, 299, 294, 0
+};
+const float distanceCosine[lunarTermCount] = {
+    -20905.355, -3699.111, -2955.968, -569.925, 48.888, -3.149, 246.158, -152.138, -170.733, -204.586,
+    -129.62, 108.743, 104.755, 10.321, 0, 79.661, -34.782, -23.21, -21.636, 24.208,
+    30.824, -8.379, -16.675, -12.831, -10.445, -11.65, 14.403, -7.003, 0, 10.056,
+    6.322, -9.884, 5.751, 0, -4.95, 4.13, 0, -3.958, 0, 3.258,
+    2.616, -1.897, -2.117, 2.354, 0, 0, -1.423, -1.117, -1.571, -1.739,
+    0, -4.421, 0, 0, 0, 0, 1.165, 0, 0, 8.752
+};
+
+// Periodic terms of the Moon's latitude (Meeus, table 47.B): the sine of a combination of D, M, M' and F, in millionths of a degree
+const float latitudeD[lunarTermCount] = {
+    0, 0, 0, 2, 2, 2, 2, 0, 2, 0, 2, 2, 2, 2, 2, 2, 2, 0, 4, 0, 0, 0, 1, 0, 0, 0, 1, 0, 4, 4,
+    0, 4, 2, 2, 2, 2, 0, 2, 2, 2, 2, 4, 2, 2, 0, 2, 1, 1, 0, 2, 1, 2, 0, 4, 4, 1, 4, 1, 4, 2
+};
+const float latitudeM[lunarTermCount] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 1, -1, -1, -1, 1, 0, 1, 0, 1, 0, 1, 1, 1, 0, 0, 0, 0,
+    0, 0, 0, 0, -1, 0, 0, 0, 0, 1, 1, 0, -1, -2, 0, 1, 1, 1, 1, 1, 0, -1, 1, 0, -1, 0, 0, 0, -1, -2
+};
+const float latitudeMp[lunarTermCount] = {
+    0, 1, 1, 0, -1, -1, 0, 2, 1, 2, 0, -2, 1, 0, -1, 0, -1, -1, -1, 0, 0, -1, 0, 1, 1, 0, 0, 3, 0, -1,
+    1, -2, 0, 2, 1, -2, 3, 2, -3, -1, 0, 0, 1, 0, 1, 1, 0, 0, -2, -1, 1, -2, 2, -2, -1, 1, 1, -1, 0, 0
+};
+const float latitudeF[lunarTermCount] = {
+    1, 1, -1, -1, 1, -1, 1, 1, -1, -1, -1, -1, 1, -1, 1, 1, -1, -1, -1, 1, 3, 1, 1, 1, -1, -1, -1, 1, -1, 1,
+    -3, 1, -3, -1, -1, 1, -1, 1, -1, 1, 1, 1, 1, -1, 3, -1, -1, 1, -1, -1, 1, -1, 1, -1, -1, -1, -1, -1, -1, 1
+};
+const float latitudeSine[lunarTermCount] = {
+    5128122, 280602, 277693, 173237, 55413, 46271, 32573, 17198, 9266, 8822,
+    8216, 4324, 4200, -3359, 2463, 2211, 2065, -1870, 1828, -1794,
+    -1749, -1565, -1491, -1475, -1410, -1344, -1335, 1107, 1021, 833,
+    777, 671, 607, 596, 491, -451, 439, 422, 421, -366,
+    -351, 331, 315, 302, -283, -229, 223, 223, -220, -220,
+    -185, 181, -177, 176, 166, -164, 132, -119, 115, 107
+};
+
+// Angle in degrees reduced to [-180, 180) and converted to radians
+double reducedRadians(double degrees) {
+    return (degrees - 360.0 * std::floor((degrees + 180.0) / 360.0)) * degreesToRadians;
+}
+
+static_assert(planetCount % 4 == 0, "The SSE loop over the planets needs no remainder");
+
+// Heliocentric position of 'count' planets, a multiple of 4, from their elements, reduced to floats: solves the Kepler equation by Newton's method, places
+// the planet in the plane of its orbit and rotates that plane by the argument of perihelion, the inclination and the node
+void solveOrbits(const float* semiMajorAxis, const float* eccentricity, const float* inclination, const float* meanAnomaly,
+                 const float* perihelionArgument, const float* node, float* x, float* y, float* z, size_t count) {
+
+#ifdef SIMD_TRIGONOMETRY_SSE
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 a = _mm_loadu_ps(semiMajorAxis + i);
+        __m128 e = _mm_loadu_ps(eccentricity + i);
+        __m128 anomaly = _mm_loadu_ps(meanAnomaly + i);
+        __m128 one = _mm_set1_ps(1.0f);
+
+        // E - e sin E = M, from E = M + e sin M
+        __m128 sine, cosine;
+        sinCosSse(anomaly, sine, cosine);
+        __m128 eccentricAnomaly = _mm_add_ps(anomaly, _mm_mul_ps(e, sine));
+        for (int iteration = 0; iteration < keplerIterations; ++iteration) {
+            sinCosSse(eccentricAnomaly, sine, cosine);
+            __m128 residual = _mm_sub_ps(_mm_sub_ps(eccentricAnomaly, _mm_mul_ps(e, sine)), anomaly);
+            eccentricAnomaly = _mm_sub_ps(eccentricAnomaly, _mm_div_ps(residual, _mm_sub_ps(one, _mm_mul_ps(e, cosine))));
+        }
+        sinCosSse(eccentricAnomaly, sine, cosine);
+
+        // Position in the plane of the orbit, with x toward the perihelion
+        __m128 orbitX = _mm_mul_ps(a, _mm_sub_ps(cosine, e));
+        __m128 orbitY = _mm_mul_ps(_mm_mul_ps(a, _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(e, e)))), sine);
+
+        __m128 sinW, cosW, sinN, cosN, sinI, cosI;
+        sinCosSse(_mm_loadu_ps(perihelionArgument + i), sinW, cosW);
+        sinCosSse(_mm_loadu_ps(node + i), sinN, cosN);
+        sinCosSse(_mm_loadu_ps(inclination + i), sinI, cosI);
+        __m128 sinWCosI = _mm_mul_ps(sinW, cosI);
+        __m128 cosWCosI = _mm_mul_ps(cosW, cosI);
+
+        __m128 xx = _mm_sub_ps(_mm_mul_ps(cosW, cosN), _mm_mul_ps(sinWCosI, sinN));
+        __m128 xy = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_mul_ps(sinW, cosN), _mm_mul_ps(cosWCosI, sinN)));
+        __m128 yx = _mm_add_ps(_mm_mul_ps(cosW, sinN), _mm_mul_ps(sinWCosI, cosN));
+        __m128 yy = _mm_sub_ps(_mm_mul_ps(cosWCosI, cosN), _mm_mul_ps(sinW, sinN));
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(xx, orbitX), _mm_mul_ps(xy, orbitY)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(yx, orbitX), _mm_mul_ps(yy, orbitY)));
+        _mm_storeu_ps(z + i, _mm_mul_ps(sinI, _mm_add_ps(_mm_mul_ps(sinW, orbitX), _mm_mul_ps(cosW, orbitY))));
+    }
+#else
+    for (size_t i = 0; i < count; ++i) {
+        float e = eccentricity[i];
+        float eccentricAnomaly = meanAnomaly[i] + e * std::sin(meanAnomaly[i]);
+        for (int iteration = 0; iteration < keplerIterations; ++iteration) {
+            float residual = eccentricAnomaly - e * std::sin(eccentricAnomaly) - meanAnomaly[i];
+            eccentricAnomaly -= residual / (1.0f - e * std::cos(eccentricAnomaly));
+        }
+
+        float orbitX = semiMajorAxis[i] * (std::cos(eccentricAnomaly) - e);
+        float orbitY = semiMajorAxis[i] * std::sqrt(1.0f - e * e) * std::sin(eccentricAnomaly);
+
+        float sinW = std::sin(perihelionArgument[i]), cosW = std::cos(perihelionArgument[i]);
+        float sinN = std::sin(node[i]), cosN = std::cos(node[i]);
+        float sinI = std::sin(inclination[i]), cosI = std::cos(inclination[i]);
+        x[i] = (cosW * cosN - sinW * sinN * cosI) * orbitX - (sinW * cosN + cosW * sinN * cosI) * orbitY;
+        y[i] = (cosW * sinN + sinW * cosN * cosI) * orbitX + (cosW * cosN * cosI - sinW * sinN) * orbitY;
+        z[i] = sinI * (sinW * orbitX + cosW * orbitY);
+    }
+#endif
+}
+
+#ifdef SIMD_TRIGONOMETRY_SSE
+
+// Adds up the 4 lanes of a vector
+float horizontalSum(__m128 value) {
+    __m128 shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(value, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+#endif
+
+// Sums a series of lunar terms: the sine of each term's argument weighted by 'sineCoefficients', and the cosine weighted by
+// 'cosineCoefficients' if it is not null. The terms involving the Sun's mean anomaly M are scaled by E^|M|, where E accounts for
+// the decreasing eccentricity of the Earth's orbit
+void sumLunarSeries(const float* d, const float* m, const float* mp, const float* f, const float* sineCoefficients, const float* cosineCoefficients,
+                    float elongation, float sunAnomaly, float moonAnomaly, float latitudeArgument, float eccentricityFactor,
+                    double& sineSum, double& cosineSum) {
+
+    float e1 = eccentricityFactor - 1.0f;
+
+#ifdef SIMD_TRIGONOMETRY_SSE
+    __m128 sines = _mm_setzero_ps();
+    __m128 cosines = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 e1s = _mm_set1_ps(e1);
+    __m128 absoluteMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (size_t i = 0; i < lunarTermCount; i += 4) {
+        __m128 termM = _mm_loadu_ps(m + i);
+        __m128 argument = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(d + i), _mm_set1_ps(elongation)), _mm_mul_ps(termM, _mm_set1_ps(sunAnomaly))),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mp + i), _mm_set1_ps(moonAnomaly)), _mm_mul_ps(_mm_loadu_ps(f + i), _mm_set1_ps(latitudeArgument))));
+
+        // E^|M| for |M| of 0, 1 or 2, as 1 + |M| (E - 1) (1 + (|M| - 1) (E - 1) / 2)
+        __m128 power = _mm_and_ps(termM, absoluteMask);
+        __m128 factor = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(power, e1s), _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(half, _mm_sub_ps(power, one)), e1s))));
+
+        __m128 sine, cosine;
+        sinCosSse(argument, sine, cosine);
+        sines = _mm_add_ps(sines, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(sineCoefficients + i), factor), sine));
+        if (cosineCoefficients) {
+            cosines = _mm_add_ps(cosines, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(cosineCoefficients + i), factor), cosine));
+        }
+    }
+    sineSum = horizontalSum(sines);
+    cosineSum = horizontalSum(cosines);
+#else
+    sineSum = 0.0;
+    cosineSum = 0.0;
+    for (size_t i = 0; i < lunarTermCount; ++i) {
+        float argument = d[i] * elongation + m[i] * sunAnomaly + mp[i] * moonAnomaly + f[i] * latitudeArgument;
+        float power = std::fabs(m[i]);
+        float factor = 1.0f + power * e1 * (1.0f + 0.5f * (power - 1.0f) * e1);
+        sineSum += sineCoefficients[i] * factor * std::sin(argument);
+        if (cosineCoefficients) {
+            cosineSum += cosineCoefficients[i] * factor * std::cos(argument);
+        }
+    }
+#endif
+}
+
+// Offset of the Moon from the Earth, in AU, in ecliptic coordinates of J2000
+glm::vec3 lunarOffset(const LunarPosition& moon, double centuries) {
+    double longitude = (moon.longitude - precessionPerCentury * centuries) * degreesToRadians;
+    double latitude = moon.latitude * degreesToRadians;
+    double distance = moon.distance / kilometersPerAu;
+    return glm::vec3(static_cast<float>(distance * std::cos(latitude) * std::cos(longitude)),
+                     static_cast<float>(distance * std::cos(latitude) * std::sin(longitude)),
+                     static_cast<float>(distance * std::sin(latitude)));
+}
+
+}
+
+// Name of a planet
+const char* planetName(Planet planet) {
+    return planetNames[static_cast<size_t>(planet)];
+}
+
+// Julian date of a Gregorian calendar date, from Meeus's formula 7.1
+double julianDate(int year, int month, int day, double hours) {
+    if (month <= 2) {
+        year -= 1;
+        month += 12;
+    }
+    int century = year / 100;
+    int gregorianCorrection = 2 - century + century / 4;
+    return std::floor(365.25 * (year + 4716)) + std::floor(30.6001 * (month + 1)) + day + gregorianCorrection - 1524.5 + hours / 24.0;
+}
+
+// Parses a date with an optional time of day
+bool parseJulianDate(const std::string& text, double& date) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0;
+    int fields = std::sscanf(text.c_str(), "%d-%d-%dT%d:%d", &year, &month, &day, &hour, &minute);
+    if ((fields != 3 && fields != 5) || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return false;
+    }
+    date = julianDate(year, month, day, hour + minute / 60.0);
+    return true;
+}
+
+// Evaluates the elements of every planet at the date in double precision, reducing the angles, then solves the orbits in floats
+void computePlanetPositions(double date, glm::vec3 positions[planetCount]) {
+
+    double centuries = (date - julianDateJ2000) / daysPerCentury;
+
+    float semiMajorAxis[planetCount], eccentricity[planetCount], inclination[planetCount];
+    float meanAnomaly[planetCount], perihelionArgument[planetCount], node[planetCount];
+    for (size_t i = 0; i < planetCount; ++i) {
+        double perihelion = perihelionLongitudes[0][i] + perihelionLongitudes[1][i] * centuries;
+        double nodeLongitude = nodeLongitudes[0][i] + nodeLongitudes[1][i] * centuries;
+        semiMajorAxis[i] = static_cast<float>(semiMajorAxes[0][i] + semiMajorAxes[1][i] * centuries);
+        eccentricity[i] = static_cast<float>(eccentricities[0][i] + eccentricities[1][i] * centuries);
+        inclination[i] = static_cast<float>(reducedRadians(inclinations[0][i] + inclinations[1][i] * centuries));
+        meanAnomaly[i] = static_cast<float>(reducedRadians(meanLongitudes[0][i] + meanLongitudes[1][i] * centuries - perihelion));
+        perihelionArgument[i] = static_cast<float>(reducedRadians(perihelion - nodeLongitude));
+        node[i] = static_cast<float>(reducedRadians(nodeLongitude));
+    }
+
+    float x[planetCount], y[planetCount], z[planetCount];
+    solveOrbits(semiMajorAxis, eccentricity, inclination, meanAnomaly, perihelionArgument, node, x, y, z, planetCount);
+    for (size_t i = 0; i < planetCount; ++i) {
+        positions[i] = glm::vec3(x[i], y[i], z[i]);
+    }
+}
+
+// Evaluates the fundamental arguments of the lunar theory in double precision, reduces them, and sums the periodic terms in floats
+LunarPosition computeLunarPosition(double date) {
+
+    double t = (date - julianDateJ2000) / daysPerCentury;
+    double t2 = t * t, t3 = t2 * t, t4 = t3 * t;
+
+    // Mean longitude of the Moon, mean elongation, mean anomalies of the Sun and the Moon, and argument of latitude, in degrees
+    double meanLongitude = 218.3164477 + 481267.88123421 * t - 0.0015786 * t2 + t3 / 538841.0 - t4 / 65194000.0;
+    double elongation = 297.8501921 + 445267.1114034 * t - 0.0018819 * t2 + t3 / 545868.0 - t4 / 113065000.0;
+    double sunAnomaly = 357.5291092 + 35999.0502909 * t - 0.0001536 * t2 + t3 / 24490000.0;
+    double moonAnomaly = 134.9633964 + 477198.8675055 * t + 0.0087414 * t2 + t3 / 69699.0 - t4 / 14712000.0;
+    double latitudeArgument = 93.2720950 + 483202.0175233 * t - 0.0036539 * t2 - t3 / 3526000.0 + t4 / 863310000.0;
+
+    // Arguments of the corrections for Venus, Jupiter and the flattening of the Earth
+    double a1 = 119.75 + 131.849 * t;
+    double a2 = 53.09 + 479264.290 * t;
+    double a3 = 313.45 + 481266.484 * t;
+    double eccentricityFactor = 1.0 - 0.002516 * t - 0.0000074 * t2;
+
+    float reducedElongation = static_cast<float>(reducedRadians(elongation));
+    float reducedSunAnomaly = static_cast<float>(reducedRadians(sunAnomaly));
+    float reducedMoonAnomaly = static_cast<float>(reducedRadians(moonAnomaly));
+    float reducedLatitudeArgument = static_cast<float>(reducedRadians(latitudeArgument));
+
+    double longitudeSum, distanceSum, latitudeSum, unused;
+    sumLunarSeries(longitudeD, longitudeM, longitudeMp, longitudeF, longitudeSine, distanceCosine,
+                   reducedElongation, reducedSunAnomaly, reducedMoonAnomaly, reducedLatitudeArgument, static_cast<float>(eccentricityFactor),
+                   longitudeSum, distanceSum);
+    sumLunarSeries(latitudeD, latitudeM, latitudeMp, latitudeF, latitudeSine, nullptr,
+                   reducedElongation, reducedSunAnomaly, reducedMoonAnomaly, reducedLatitudeArgument, static_cast<float>(eccentricityFactor),
+                   latitudeSum, unused);
+
+    double l = meanLongitude * degreesToRadians;
+    double mp = moonAnomaly * degreesToRadians;
+    double f = latitudeArgument * degreesToRadians;
+    longitudeSum += 3958.0 * std::sin(a1 * degreesToRadians) + 1962.0 * std::sin(l - f) + 318.0 * std::sin(a2 * degreesToRadians);
+    latitudeSum += -2235.0 * std::sin(l) + 382.0 * std::sin(a3 * degreesToRadians) + 175.0 * std::sin(a1 * degreesToRadians - f)
+                 + 175.0 * std::sin(a1 * degreesToRadians + f) + 127.0 * std::sin(l - mp) - 115.0 * std::sin(l + mp);
+
+    LunarPosition moon;
+    moon.longitude = meanLongitude + longitudeSum / 1000000.0;
+    moon.longitude -= 360.0 * std::floor(moon.longitude / 360.0);
+    moon.latitude = latitudeSum / 1000000.0;
+    moon.distance = 385000.56 + distanceSum;
+    return moon;
+}
+
+// Splits the barycenter of the Earth and the Moon by the Moon's offset, weighted by their masses
+EphemerisState computeEphemeris(double date) {
+
+    EphemerisState state;
+    state.julianDate = date;
+    computePlanetPositions(date, state.planets);
+
+    glm::vec3 moonOffset = lunarOffset(computeLunarPosition(date), (date - julianDateJ2000) / daysPerCentury);
+    const glm::vec3& barycenter = state.planets[static_cast<size_t>(Planet::EarthMoonBarycenter)];
+    state.earth = barycenter - moonOffset * static_cast<float>(1.0 / (1.0 + earthMoonMassRatio));
+    state.moon = state.earth + moonOffset;
+    return state;
+}
+
+// Evaluates every date independently, in chunks spread over the pool
+void computeEphemerides(const std::vector<double>& julianDates, std::vector<EphemerisState>& states, ThreadPool* pool) {
+
+    states.resize(julianDates.size());
+    auto evaluate = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            states[i] = computeEphemeris(julianDates[i]);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(julianDates.size(), 256, evaluate);
+    }
+    else {
+        evaluate(0, julianDates.size());
+    }
+}
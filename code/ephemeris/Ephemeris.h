@@ -0,0 +1,71 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Julian date of the J2000 epoch, 2000 January 1 at 12h TT
+const double julianDateJ2000 = 2451545.0;
+
+// Planets of the JPL table of approximate Keplerian elements, in which the Earth is the barycenter of the Earth and the Moon
+enum class Planet { Mercury, Venus, EarthMoonBarycenter, Mars, Jupiter, Saturn, Uranus, Neptune, Count };
+
+// Number of planets
+const size_t planetCount = static_cast<size_t>(Planet::Count);
+
+// Name of a planet, for reports
+const char* planetName(Planet planet);
+
+// Position of the Moon seen from the center of the Earth, in ecliptic coordinates of the mean equinox of the date
+struct LunarPosition {
+
+    // Ecliptic longitude and latitude, in degrees
+    double longitude;
+    double latitude;
+
+    // Distance between the centers of the Earth and the Moon, in kilometers
+    double distance;
+
+};
+
+// Positions of the bodies at one date, heliocentric, in AU, in ecliptic coordinates of J2000: x toward the equinox of J2000 and z toward
+// the north pole of the ecliptic
+struct EphemerisState {
+
+    // Julian date (TT) of the positions
+    double julianDate;
+
+    // Positions of the planets, indexed by Planet
+    glm::vec3 planets[planetCount];
+
+    // Positions of the Earth and the Moon, split from the barycenter of the Earth and the Moon by the lunar theory
+    glm::vec3 earth;
+    glm::vec3 moon;
+
+};
+
+// Julian date of a date of the Gregorian calendar at 'hours' TT (Meeus, Astronomical Algorithms, chapter 7)
+double julianDate(int year, int month, int day, double hours = 0.0);
+
+// Parses "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM" (TT) into a Julian date. Returns false if the text is not a valid date
+bool parseJulianDate(const std::string& text, double& julianDate);
+
+// Heliocentric positions of the planets from the JPL approximate Keplerian elements (Standish, table 1), accurate to about an arcminute
+// from 1800 to 2050. The elements are stored as a structure of arrays over the planets, and the Kepler equation of 4 planets is solved at once with SSE
+void computePlanetPositions(double julianDate, glm::vec3 positions[planetCount]);
+
+// Geocentric position of the Moon from the truncated ELP-2000/82 theory of Meeus, chapter 47, accurate to about 10 arcseconds in longitude
+// and 4 in latitude. Its periodic terms are stored as a structure of arrays, and 4 terms are summed at once with SSE
+LunarPosition computeLunarPosition(double julianDate);
+
+// Positions of every body at one date
+EphemerisState computeEphemeris(double julianDate);
+
+// Positions of every body at each of the dates, spread over the pool if there is one, to precompute the positions of a time warp
+void computeEphemerides(const std::vector<double>& julianDates, std::vector<EphemerisState>& states, ThreadPool* pool = nullptr);
+
+#endif
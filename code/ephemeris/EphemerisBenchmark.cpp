@@ -0,0 +1,136 @@
+#include "EphemerisBenchmark.h"
+#include "Ephemeris.h"
+#include "../threading/ThreadPool.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Time spent repeating each measurement, in seconds
+const double benchmarkDuration = 0.25;
+
+// Number of dates cycled through by the measurements of single evaluations
+const size_t singleDateCount = 1024;
+
+// Arcseconds in a degree and kilometers in an AU
+const double arcsecondsPerDegree = 3600.0;
+const double kilometersPerAstronomicalUnit = 149597870.7;
+
+// General precession in longitude, in degrees per Julian century, turning longitudes of J2000 into longitudes of the date
+const double precessionPerCentury = 1.3969713;
+
+// Random dates between 1900 and 2100. The seed is fixed, so every run uses the same dates
+std::vector<double> randomDates(size_t count) {
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> date(julianDate(1900, 1, 1), julianDate(2100, 1, 1));
+    std::vector<double> dates(count);
+    for (double& value : dates) {
+        value = date(generator);
+    }
+    return dates;
+}
+
+// Repeats 'evaluate' until 'benchmarkDuration' has passed, and returns the average time of a pass in seconds
+template <typename Evaluate>
+double measure(Evaluate evaluate) {
+
+    unsigned int passes = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < benchmarkDuration || passes < 3) {
+        evaluate();
+        ++passes;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds / passes;
+}
+
+// Difference between two angles in arcseconds, wrapped to half a turn
+double angleError(double degrees, double referenceDegrees) {
+    double difference = std::remainder(degrees - referenceDegrees, 360.0);
+    return std::fabs(difference) * arcsecondsPerDegree;
+}
+
+// Prints the evaluations per second of 'count' evaluations taking 'seconds'
+void printRate(const char* name, size_t count, double seconds, std::ostream& stream) {
+    stream << std::fixed << std::setprecision(3)
+           << "  " << std::left << std::setw(28) << name << std::right
+           << static_cast<double>(count) / seconds / 1.0e6 << " M evaluations/s, "
+           << seconds * 1.0e9 / static_cast<double>(count) << " ns each"
+           << std::defaultfloat << std::endl;
+}
+
+}
+
+// Checks the accuracy of the ephemeris, then times it
+void runEphemerisBenchmark(size_t dateCount, ThreadPool* pool, std::ostream& stream) {
+
+    stream << "Ephemeris accuracy" << std::endl;
+
+    // The Moon on 1992 April 12 at 0h TD (Meeus, example 47.a)
+    LunarPosition moon = computeLunarPosition(julianDate(1992, 4, 12));
+    stream << std::fixed << std::setprecision(3)
+           << "  Moon, 1992-04-12:  longitude " << angleError(moon.longitude, 133.162655) << "\", latitude "
+           << angleError(moon.latitude, -3.229126) << "\", distance " << std::fabs(moon.distance - 368409.7) << " km" << std::endl;
+
+    // Venus on 1992 December 20 at 0h TD, heliocentric in the ecliptic of the date (Meeus, example 32.a)
+    double venusDate = julianDate(1992, 12, 20);
+    glm::vec3 planets[planetCount];
+    computePlanetPositions(venusDate, planets);
+    glm::dvec3 venus(planets[static_cast<size_t>(Planet::Venus)]);
+    double venusDistance = glm::length(venus);
+    double venusLongitude = glm::degrees(std::atan2(venus.y, venus.x)) + precessionPerCentury * (venusDate - julianDateJ2000) / 36525.0;
+    double venusLatitude = glm::degrees(std::asin(venus.z / venusDistance));
+    stream << "  Venus, 1992-12-20: longitude " << angleError(venusLongitude, 26.11428) << "\", latitude "
+           << angleError(venusLatitude, -2.62070) << "\", distance " << std::fabs(venusDistance - 0.724603) * kilometersPerAstronomicalUnit << " km" << std::endl;
+
+    // The Earth at J2000, heliocentric in the ecliptic of J2000
+    EphemerisState state = computeEphemeris(julianDateJ2000);
+    glm::dvec3 earthError = glm::dvec3(state.earth) - glm::dvec3(-0.17713, 0.96724, 0.0);
+    stream << "  Earth, J2000:      position " << glm::length(earthError) * kilometersPerAstronomicalUnit << " km" << std::endl;
+    stream << std::defaultfloat;
+
+    stream << "Ephemeris throughput" << std::endl;
+
+    std::vector<double> dates = randomDates(singleDateCount);
+    // Single evaluations, cycling through dates spread over two centuries. Their results go to a volatile so that they are not optimized away
+    volatile float sink = 0.0f;
+    double seconds = measure([&]() {
+        for (double date : dates) {
+            computePlanetPositions(date, planets);
+            sink = planets[0].x;
+        }
+    });
+    printRate("planets", dates.size(), seconds, stream);
+    seconds = measure([&]() {
+        for (double date : dates) {
+            sink = static_cast<float>(computeLunarPosition(date).longitude);
+        }
+    });
+    printRate("Moon", dates.size(), seconds, stream);
+    seconds = measure([&]() {
+        for (double date : dates) {
+            sink = computeEphemeris(date).moon.x;
+        }
+    });
+    printRate("ephemeris", dates.size(), seconds, stream);
+
+    // Batches of dates, as precomputed for a time warp
+    if (dateCount > 0) {
+        std::vector<double> batchDates = randomDates(dateCount);
+        std::vector<EphemerisState> states;
+        seconds = measure([&]() { computeEphemerides(batchDates, states); });
+        printRate("batch, 1 thread", dateCount, seconds, stream);
+        // A pool of one thread would only repeat the row above
+        if (pool && pool->threadCount() > 1) {
+            seconds = measure([&]() { computeEphemerides(batchDates, states, pool); });
+            std::string name = "batch, " + std::to_string(pool->threadCount()) + " threads";
+            printRate(name.c_str(), dateCount, seconds, stream);
+        }
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef EPHEMERIS_BENCHMARK_H
+#define EPHEMERIS_BENCHMARK_H
+
+#include <cstddef>
+#include <ostream>
+
+class ThreadPool;
+
+// Compares the ephemeris to reference positions of the Moon, Venus and the Earth and prints the errors, then prints the evaluations
+// per second of the planets, the Moon and whole ephemerides, one date at a time and for a batch of 'dateCount' dates, with and without the pool
+void runEphemerisBenchmark(size_t dateCount, ThreadPool* pool, std::ostream& stream);
+
+#endif
@@ -0,0 +1,167 @@
+#include "HeadlessContext.h"
+#include <iostream>
+#include <vector>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef _WIN32
+
+// EGL is not available on Windows, where a display is always present
+bool HeadlessContext::create(int, int) {
+    std::cerr << "ERROR::HEADLESS::UNSUPPORTED_PLATFORM" << std::endl;
+    return false;
+}
+
+HeadlessContext::~HeadlessContext() {}
+
+#else
+
+// Creates an EGL context on a surfaceless display and binds an offscreen framebuffer
+bool HeadlessContext::create(int requestedWidth, int requestedHeight) {
+
+    width = requestedWidth;
+    height = requestedHeight;
+
+    // Prefer Mesa's surfaceless platform, which needs neither a display server nor a GPU
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        std::cerr << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED" << std::endl;
+        return false;
+    }
+    display = eglDisplay;
+
+    // Desktop OpenGL, as used by the shaders
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR::HEADLESS::EGL_OPENGL_API_UNAVAILABLE" << std::endl;
+        return false;
+    }
+
+    // Rendering goes to a framebuffer object, so the config needs no surface
+    const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "ERROR::HEADLESS::EGL_NO_CONFIG" << std::endl;
+        return false;
+    }
+
+    // OpenGL version 4.3, core profile, for the indirect submission, or 3.3 if the driver has no 4.3, as in the windowed mode
+    EGLContext eglContext = EGL_NO_CONTEXT;
+    const EGLint versions[][2] = { { 4, 3 }, { 3, 3 } };
+    for (const EGLint* version : versions) {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+        if (eglContext != EGL_NO_CONTEXT) {
+            break;
+        }
+    }
+    if (eglContext == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR::HEADLESS::EGL_CREATE_CONTEXT_FAILED" << std::endl;
+        return false;
+    }
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        std::cerr << "ERROR::HEADLESS::EGL_MAKE_CURRENT_FAILED" << std::endl;
+        return false;
+    }
+
+    // Initialize GLAD
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    std::cout << "Headless context: " << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+
+    return setupFramebuffer();
+}
+
+// Destructor: Deletes the framebuffer and destroys the context
+HeadlessContext::~HeadlessContext() {
+
+    if (context) {
+        if (framebuffer)
+            glDeleteFramebuffers(1, &framebuffer);
+
+        if (colorBuffer)
+            glDeleteRenderbuffers(1, &colorBuffer);
+
+        if (depthBuffer)
+            glDeleteRenderbuffers(1, &depthBuffer);
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+
+    if (display)
+        eglTerminate(display);
+}
+
+#endif
+
+// Creates the framebuffer and binds it in place of the default framebuffer
+bool HeadlessContext::setupFramebuffer() {
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    // Color buffer
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+    // Depth buffer, for depth testing
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        return false;
+    }
+
+    // The framebuffer stays bound, so every draw call renders into it
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+// Writes the color buffer of the framebuffer to a PNG file
+bool HeadlessContext::saveFrame(const std::string& path) const {
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    // OpenGL's first row is the bottom of the image
+    stbi_flip_vertically_on_write(1);
+    if (!stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4)) {
+        std::cerr << "ERROR::HEADLESS::CANNOT_WRITE_FRAME: " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
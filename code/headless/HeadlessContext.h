@@ -0,0 +1,44 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <glad/glad.h>
+#include <string>
+
+// An OpenGL 3.3 core context without any window, created through EGL on a surfaceless display
+// (Mesa's software rasterizer when there is no GPU), rendering into an offscreen framebuffer
+class HeadlessContext {
+
+public:
+
+    HeadlessContext() = default;
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates the context, loads the OpenGL functions and binds a width x height framebuffer. Returns false on failure
+    bool create(int width, int height);
+
+    // Writes the color buffer of the framebuffer to a PNG file
+    bool saveFrame(const std::string& path) const;
+
+    // Destructor: Deletes the framebuffer and destroys the context
+    ~HeadlessContext();
+
+private:
+
+    // EGL display and context, stored as opaque pointers to keep EGL out of this header
+    void* display = nullptr;
+    void* context = nullptr;
+
+    // OpenGL identifiers for the framebuffer and its color and depth renderbuffers
+    unsigned int framebuffer = 0, colorBuffer = 0, depthBuffer = 0;
+
+    // Size of the framebuffer
+    int width = 0, height = 0;
+
+    // Creates the framebuffer and binds it in place of the default framebuffer
+    bool setupFramebuffer();
+
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SIMD_TRIGONOMETRY_H
+#define SIMD_TRIGONOMETRY_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_TRIGONOMETRY_SSE
+#include <emmintrin.h>
+#endif
+
+// 2 / pi, and pi / 2 split in three parts, so that the reduction x - j * pi / 2 stays exact for the first parts
+const float sinCosTwoOverPi = 0.636619772f;
+const float sinCosHalfPi1 = 1.5703125f;
+const float sinCosHalfPi2 = 4.837512969970703125e-4f;
+const float sinCosHalfPi3 = 7.54978995489188216e-8f;
+
+// Coefficients of the polynomials of the sine and cosine on [-pi / 4, pi / 4], from Cephes
+const float sinCosSine1 = -1.6666654611e-1f, sinCosSine2 = 8.3321608736e-3f, sinCosSine3 = -1.9515295891e-4f;
+const float sinCosCosine1 = 4.166664568298827e-2f, sinCosCosine2 = -1.388731625493765e-3f, sinCosCosine3 = 2.443315711809948e-5f;
+
+#ifdef SIMD_TRIGONOMETRY_SSE
+
+// Sine and cosine of 4 angles in radians, accurate to about 1e-7 for angles within a few thousand radians. The angle is reduced to
+// [-pi / 4, pi / 4] around the nearest multiple of pi / 2, whose quadrant swaps and negates the polynomials
+inline void sinCosSse(__m128 angle, __m128& sine, __m128& cosine) {
+
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(sinCosTwoOverPi)));
+    __m128 j = _mm_cvtepi32_ps(quadrant);
+    __m128 y = _mm_sub_ps(angle, _mm_mul_ps(j, _mm_set1_ps(sinCosHalfPi1)));
+    y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(sinCosHalfPi2)));
+    y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(sinCosHalfPi3)));
+    __m128 y2 = _mm_mul_ps(y, y);
+
+    __m128 sineY = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sinCosSine3), y2), _mm_set1_ps(sinCosSine2));
+    sineY = _mm_add_ps(_mm_mul_ps(sineY, y2), _mm_set1_ps(sinCosSine1));
+    sineY = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sineY, y2), y), y);
+
+    __m128 cosineY = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(sinCosCosine3), y2), _mm_set1_ps(sinCosCosine2));
+    cosineY = _mm_add_ps(_mm_mul_ps(cosineY, y2), _mm_set1_ps(sinCosCosine1));
+    cosineY = _mm_mul_ps(_mm_mul_ps(cosineY, y2), y2);
+    cosineY = _mm_add_ps(_mm_sub_ps(cosineY, _mm_mul_ps(y2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // Odd quadrants swap the sine and the cosine. Quadrants 2 and 3 negate the sine, 1 and 2 the cosine
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+    __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosineY), _mm_andnot_ps(swap, sineY)), sineSign);
+    cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sineY), _mm_andnot_ps(swap, cosineY)), cosineSign);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,246 @@
+#include "BinaryMesh.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const char binaryMeshMagic[4] = { 'S', 'S', 'B', 'M' };
+
+// Rounds an offset up to the next multiple of 16 bytes
+uint64_t alignOffset(uint64_t offset) {
+    return (offset + 15) & ~static_cast<uint64_t>(15);
+}
+
+}
+
+// 64-bit FNV-1a hash of a range of bytes, continuing from 'hash'
+uint64_t hashBytes(const unsigned char* bytes, size_t length, uint64_t hash) {
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Computes the size, modification time and, on request, the hash of a file
+bool fingerprintFile(const std::string& path, SourceFingerprint& fingerprint, bool computeHash) {
+
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+    std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+
+    fingerprint.size = static_cast<uint64_t>(size);
+    fingerprint.modifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+    fingerprint.hash = 0;
+
+    if (computeHash) {
+        MappedFile source;
+        if (size > 0 && !source.open(path)) {
+            return false;
+        }
+        fingerprint.hash = hashBytes(source.data(), source.size());
+    }
+
+    return true;
+}
+
+// Compares the size and modification time first, and only hashes the source when they differ
+bool isSourceUnchanged(const std::string& sourcePath, const SourceFingerprint& stored, SourceFingerprint& current) {
+
+    // Without the source file, the cache is all there is
+    current = stored;
+    SourceFingerprint source;
+    if (!fingerprintFile(sourcePath, source, false)) {
+        return true;
+    }
+
+    // An unchanged size and modification time mean an unchanged source
+    if (source.size == stored.size && source.modifiedTime == stored.modifiedTime) {
+        return true;
+    }
+
+    // The modification time also changes on checkouts and copies, so compare the contents before giving up
+    if (source.size != stored.size || !fingerprintFile(sourcePath, source, true) || source.hash != stored.hash) {
+        return false;
+    }
+    current = source;
+    return true;
+}
+
+// Writes the fingerprint over the one in the file, in place
+bool updateFingerprint(const std::string& path, uint64_t offset, const SourceFingerprint& fingerprint) {
+
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (file) {
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    }
+    if (!file) {
+        std::cerr << "ERROR::BINARY_MESH::CANNOT_UPDATE_FINGERPRINT: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Compares against the room left after the offset, which cannot overflow
+bool isRangeInFile(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// Writes a mesh into a binary mesh file. The file is written under a temporary name and renamed,
+// so that a crash never leaves a truncated cache behind
+bool writeBinaryMesh(const std::string& path, const MeshData& mesh, const VertexLayout& layout, const SourceFingerprint& source) {
+
+    BinaryMeshHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binaryMeshMagic, sizeof(header.magic));
+    header.version = binaryMeshVersion;
+    header.source = source;
+    header.layout = layout;
+    header.vertexCount = mesh.vertexCount();
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    header.indexType = GL_UNSIGNED_INT;
+    header.vertexBytes = mesh.vertices.size() * sizeof(float);
+    header.indexBytes = mesh.indices.size() * sizeof(unsigned int);
+    header.vertexOffset = alignOffset(sizeof(BinaryMeshHeader));
+    header.indexOffset = alignOffset(header.vertexOffset + header.vertexBytes);
+
+    BoundingSphere sphere = computeBoundingSphere(mesh);
+    header.boundingSphere[0] = sphere.center.x;
+    header.boundingSphere[1] = sphere.center.y;
+    header.boundingSphere[2] = sphere.center.z;
+    header.boundingSphere[3] = sphere.radius;
+
+    // A mesh without levels of detail is its own single level
+    if (mesh.levels.empty()) {
+        header.levelCount = 1;
+        header.levels[0] = { 0, header.indexCount, 0.0f };
+    }
+    else {
+        header.levelCount = std::min<uint32_t>(static_cast<uint32_t>(mesh.levels.size()), binaryMeshMaxLevels);
+        std::copy(mesh.levels.begin(), mesh.levels.begin() + header.levelCount, header.levels);
+    }
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "ERROR::BINARY_MESH::CANNOT_WRITE: " << temporaryPath << std::endl;
+            return false;
+        }
+
+        // Writes zeros up to the given offset, to align the next blob
+        auto padTo = [&file](uint64_t offset) {
+            static const char zeros[16] = {};
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(zeros, static_cast<std::streamsize>(offset - position));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        padTo(header.vertexOffset);
+        file.write(reinterpret_cast<const char*>(mesh.vertices.data()), static_cast<std::streamsize>(header.vertexBytes));
+        padTo(header.indexOffset);
+        file.write(reinterpret_cast<const char*>(mesh.indices.data()), static_cast<std::streamsize>(header.indexBytes));
+
+        if (!file) {
+            std::cerr << "ERROR::BINARY_MESH::CANNOT_WRITE: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "ERROR::BINARY_MESH::CANNOT_RENAME: " << temporaryPath << " " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+// Maps the binary mesh and validates it against its source file
+bool BinaryMesh::open(const std::string& path, const std::string& sourcePath) {
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // Check that the header and both blobs fit in the file, and that the blobs hold exactly the vertices and indices of the header
+    const BinaryMeshHeader& meshHeader = header();
+    bool valid = file.size() >= sizeof(BinaryMeshHeader)
+        && std::memcmp(meshHeader.magic, binaryMeshMagic, sizeof(meshHeader.magic)) == 0
+        && meshHeader.version == binaryMeshVersion
+        && meshHeader.layout.attributeCount <= VertexLayout::maxAttributes
+        && meshHeader.vertexBytes == static_cast<uint64_t>(meshHeader.vertexCount) * meshHeader.layout.stride
+        && meshHeader.indexType == GL_UNSIGNED_INT
+        && meshHeader.indexBytes == static_cast<uint64_t>(meshHeader.indexCount) * sizeof(uint32_t)
+        && isRangeInFile(meshHeader.vertexOffset, meshHeader.vertexBytes, file.size())
+        && isRangeInFile(meshHeader.indexOffset, meshHeader.indexBytes, file.size())
+        && meshHeader.levelCount >= 1 && meshHeader.levelCount <= binaryMeshMaxLevels;
+    for (uint32_t i = 0; valid && i < meshHeader.levelCount; ++i) {
+        valid = static_cast<uint64_t>(meshHeader.levels[i].firstIndex) + meshHeader.levels[i].indexCount <= meshHeader.indexCount;
+    }
+    if (!valid) {
+        std::cerr << "ERROR::BINARY_MESH::INVALID: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    SourceFingerprint current;
+    if (!isSourceUnchanged(sourcePath, meshHeader.source, current)) {
+        file.close();
+        return false;
+    }
+
+    // Only the modification time of the source changed: store the new one, so that the next launch does not hash the source again.
+    // The file is unmapped while it is written, and mapped again
+    if (current.modifiedTime != meshHeader.source.modifiedTime) {
+        file.close();
+        updateFingerprint(path, offsetof(BinaryMeshHeader, source), current);
+        if (!file.open(path)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Header of the mapped file
+const BinaryMeshHeader& BinaryMesh::header() const {
+    return *reinterpret_cast<const BinaryMeshHeader*>(file.data());
+}
+
+// Start of the vertex blob inside the mapping
+const void* BinaryMesh::vertexData() const {
+    return file.data() + header().vertexOffset;
+}
+
+// Start of the index blob inside the mapping
+const void* BinaryMesh::indexData() const {
+    return file.data() + header().indexOffset;
+}
+
+// Bounding sphere stored in the header
+BoundingSphere BinaryMesh::boundingSphere() const {
+    BoundingSphere sphere;
+    sphere.center = glm::vec3(header().boundingSphere[0], header().boundingSphere[1], header().boundingSphere[2]);
+    sphere.radius = header().boundingSphere[3];
+    return sphere;
+}
+
+// Levels of detail stored in the header
+std::vector<MeshLevel> BinaryMesh::levels() const {
+    return std::vector<MeshLevel>(header().levels, header().levels + header().levelCount);
+}
@@ -0,0 +1,126 @@
+#ifndef BINARY_MESH_H
+#define BINARY_MESH_H
+
+#include "MeshData.h"
+#include "VertexLayout.h"
+#include "../resources/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Version of the binary mesh format. Files of any other version are treated as stale
+const uint32_t binaryMeshVersion = 2;
+
+// Maximum number of levels of detail stored in a binary mesh
+const uint32_t binaryMeshMaxLevels = 8;
+
+// Identifies the contents of the source file a binary mesh was converted from
+struct SourceFingerprint {
+
+    // Size of the source file, in bytes
+    uint64_t size;
+
+    // Last modification time of the source file, in the file system's clock units
+    int64_t modifiedTime;
+
+    // FNV-1a hash of the source file's bytes
+    uint64_t hash;
+
+};
+
+// Header at the start of a binary mesh file. The vertex and index blobs follow at 16-byte aligned offsets
+struct BinaryMeshHeader {
+
+    // "SSBM"
+    char magic[4];
+
+    // Must equal binaryMeshVersion
+    uint32_t version;
+
+    // Fingerprint of the object file, used to detect stale caches
+    SourceFingerprint source;
+
+    // Layout of the vertex blob, used as-is to set up the vertex attributes
+    VertexLayout layout;
+
+    uint32_t vertexCount;
+
+    // Number of indices of every level together
+    uint32_t indexCount;
+
+    // OpenGL type of the indices, e.g. GL_UNSIGNED_INT
+    uint32_t indexType;
+
+    // Number of used entries in 'levels'
+    uint32_t levelCount;
+
+    // Location and size of the vertex and index blobs, from the start of the file
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+
+    // Bounding sphere of the mesh: center (x, y, z) and radius
+    float boundingSphere[4];
+
+    // Levels of detail, as ranges of the index blob. Level 0 is the full mesh
+    MeshLevel levels[binaryMeshMaxLevels];
+
+};
+
+// Offset basis of the 64-bit FNV-1a hash, with which every hash starts
+const uint64_t hashOffsetBasis = 14695981039346656037ull;
+
+// 64-bit FNV-1a hash of a range of bytes. Hashing several ranges one after the other, passing the previous result as 'hash',
+// gives the hash of their concatenation
+uint64_t hashBytes(const unsigned char* bytes, size_t length, uint64_t hash = hashOffsetBasis);
+
+// Computes the fingerprint of a file. The hash requires reading the whole file, so it is only computed on request
+bool fingerprintFile(const std::string& path, SourceFingerprint& fingerprint, bool computeHash);
+
+// Whether a source file still has the fingerprint stored in a cache converted from it. A missing source leaves the cache valid.
+// 'current' receives the fingerprint to keep in the cache: the stored one, or the new one of a source whose contents are unchanged
+// but whose modification time changed, which should be written back with updateFingerprint()
+bool isSourceUnchanged(const std::string& sourcePath, const SourceFingerprint& stored, SourceFingerprint& current);
+
+// Overwrites the fingerprint stored at 'offset' in a cache file, so that later launches compare the new modification time
+// instead of hashing the source again. The file must not be mapped, since mapped files cannot be written on every platform
+bool updateFingerprint(const std::string& path, uint64_t offset, const SourceFingerprint& fingerprint);
+
+// Whether the range of 'bytes' bytes at 'offset' lies within a file of 'fileSize' bytes, without overflowing
+bool isRangeInFile(uint64_t offset, uint64_t bytes, uint64_t fileSize);
+
+// Writes a mesh, whose vertices are in the given layout, into a binary mesh file
+bool writeBinaryMesh(const std::string& path, const MeshData& mesh, const VertexLayout& layout, const SourceFingerprint& source);
+
+// A binary mesh file mapped into memory. The vertex and index blobs are read straight from the mapping
+class BinaryMesh {
+
+public:
+
+    // Maps the binary mesh and validates it against its source file. Returns false if it is missing, corrupt or stale.
+    // The sizes of the blobs must match their counts, so that the vertices and indices handed to OpenGL are all in the file
+    bool open(const std::string& path, const std::string& sourcePath);
+
+    // Header of the mapped file
+    const BinaryMeshHeader& header() const;
+
+    // Start of the vertex blob inside the mapping
+    const void* vertexData() const;
+
+    // Start of the index blob inside the mapping
+    const void* indexData() const;
+
+    // Bounding sphere stored in the header
+    BoundingSphere boundingSphere() const;
+
+    // Levels of detail stored in the header
+    std::vector<MeshLevel> levels() const;
+
+private:
+
+    MappedFile file;
+
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "LevelOfDetail.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// A level replaces a finer one only when its error is below this fraction of the limit
+const float coarsenThreshold = 0.75f;
+
+}
+
+// The sphere's silhouette seen from the camera subtends an angle of asin(radius / distance)
+float LevelOfDetailView::projectedRadius(const BoundingSphere& worldSphere) const {
+
+    glm::vec3 offset = worldSphere.center - cameraPosition;
+    float distanceSquared = glm::dot(offset, offset);
+    float radiusSquared = worldSphere.radius * worldSphere.radius;
+    if (distanceSquared <= radiusSquared) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return worldSphere.radius * pixelsPerUnit / std::sqrt(distanceSquared - radiusSquared);
+}
+
+// Refines the current level while its error is too large, then coarsens it while the next level's error is well below the limit.
+// Level errors are fractions of the bounding radius, so their size on the screen is the error times the projected radius
+unsigned int LevelOfDetailView::selectLevel(const std::vector<MeshLevel>& levels, const BoundingSphere& worldSphere, unsigned int currentLevel) const {
+
+    if (levels.size() <= 1 || maxPixelError <= 0.0f) {
+        return 0;
+    }
+
+    float radius = projectedRadius(worldSphere);
+    unsigned int level = std::min<unsigned int>(currentLevel, static_cast<unsigned int>(levels.size()) - 1);
+    while (level > 0 && levels[level].error * radius > maxPixelError) {
+        --level;
+    }
+    while (level + 1 < levels.size() && levels[level + 1].error * radius <= maxPixelError * coarsenThreshold) {
+        ++level;
+    }
+    return level;
+}
@@ -0,0 +1,28 @@
+#ifndef LEVEL_OF_DETAIL_H
+#define LEVEL_OF_DETAIL_H
+
+#include "MeshData.h"
+#include <vector>
+
+// How the camera of a frame projects objects onto the screen, for choosing the levels of detail of their meshes
+struct LevelOfDetailView {
+
+    // Position of the camera in world coordinates
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+
+    // Pixels covered by one world unit at a distance of one unit: half the framebuffer height times projection[1][1]
+    float pixelsPerUnit = 0.0f;
+
+    // Largest error of a level on the screen, in pixels. 0 draws every mesh at full detail
+    float maxPixelError = 1.0f;
+
+    // Radius of a sphere on the screen, in pixels. Spheres around the camera are infinitely large
+    float projectedRadius(const BoundingSphere& worldSphere) const;
+
+    // Chooses the coarsest level whose error stays under 'maxPixelError' for a mesh enclosed by 'worldSphere'.
+    // Coarser levels than 'currentLevel' must be well under it, so that objects near a threshold do not switch every frame
+    unsigned int selectLevel(const std::vector<MeshLevel>& levels, const BoundingSphere& worldSphere, unsigned int currentLevel) const;
+
+};
+
+#endif
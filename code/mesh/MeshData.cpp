@@ -0,0 +1,51 @@
+#include "MeshData.h"
+#include <algorithm>
+#include <cmath>
+
+// Computes a sphere enclosing every vertex of the mesh, centered on its axis-aligned bounding box
+BoundingSphere computeBoundingSphere(const MeshData& mesh) {
+
+    BoundingSphere sphere;
+    unsigned int vertexCount = mesh.vertexCount();
+    if (vertexCount == 0) {
+        return sphere;
+    }
+
+    // Find the axis-aligned bounding box of the positions
+    glm::vec3 minimum(mesh.vertices[0], mesh.vertices[1], mesh.vertices[2]);
+    glm::vec3 maximum = minimum;
+    for (unsigned int i = 1; i < vertexCount; ++i) {
+        const float* position = &mesh.vertices[static_cast<size_t>(i) * MeshData::floatsPerVertex];
+        minimum = glm::min(minimum, glm::vec3(position[0], position[1], position[2]));
+        maximum = glm::max(maximum, glm::vec3(position[0], position[1], position[2]));
+    }
+
+    // The radius is the distance from the box's center to the farthest vertex
+    sphere.center = (minimum + maximum) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* position = &mesh.vertices[static_cast<size_t>(i) * MeshData::floatsPerVertex];
+        glm::vec3 offset = glm::vec3(position[0], position[1], position[2]) - sphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    sphere.radius = std::sqrt(radiusSquared);
+
+    return sphere;
+}
+
+// Moves a sphere by a model matrix, scaling its radius by the longest of the matrix's axes
+BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const glm::mat4& model) {
+
+    BoundingSphere transformed;
+    glm::vec4 center = model * glm::vec4(sphere.center, 1.0f);
+    transformed.center = glm::vec3(center.x, center.y, center.z);
+
+    float scaleSquared = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 column(model[axis][0], model[axis][1], model[axis][2]);
+        scaleSquared = std::max(scaleSquared, glm::dot(column, column));
+    }
+    transformed.radius = sphere.radius * std::sqrt(scaleSquared);
+
+    return transformed;
+}
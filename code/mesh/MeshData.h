@@ -0,0 +1,57 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Sphere enclosing every vertex of a mesh, in model coordinates
+struct BoundingSphere {
+
+    glm::vec3 center = glm::vec3(0.0f);
+
+    float radius = 0.0f;
+
+};
+
+// A level of detail of a mesh: a range of its indices drawing a simplified version of it, with the same vertices
+struct MeshLevel {
+
+    uint32_t firstIndex;
+    uint32_t indexCount;
+
+    // Largest distance between the level and the full mesh, as a fraction of the radius of the bounding sphere
+    float error;
+
+};
+
+// CPU copy of an indexed triangle mesh, in the layout expected by the vertex shaders
+struct MeshData {
+
+    // Number of floats per vertex: 3 for the position, 2 for the texture coordinates and 3 for the normal
+    static const unsigned int floatsPerVertex = 8;
+
+    // Interleaved vertex data
+    std::vector<float> vertices;
+
+    // Three indices per triangle, pointing into 'vertices'
+    std::vector<unsigned int> indices;
+
+    // Levels of detail, from the full mesh (level 0) to the coarsest, as ranges of 'indices'. Empty until built by
+    // buildLevelsOfDetail(), which means a single level covering every index
+    std::vector<MeshLevel> levels;
+
+    // Number of vertices stored in 'vertices'
+    unsigned int vertexCount() const {
+        return static_cast<unsigned int>(vertices.size() / floatsPerVertex);
+    }
+
+};
+
+// Computes a sphere enclosing every vertex of the mesh, centered on its axis-aligned bounding box
+BoundingSphere computeBoundingSphere(const MeshData& mesh);
+
+// Moves a sphere by a model matrix. The radius is scaled by the matrix's largest axis scale, so the result still encloses the mesh
+BoundingSphere transformBoundingSphere(const BoundingSphere& sphere, const glm::mat4& model);
+
+#endif
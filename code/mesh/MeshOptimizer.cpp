@@ -0,0 +1,207 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Size of the LRU cache modelled while scoring vertices
+const int forsythCacheSize = 32;
+
+// Scores a vertex by its position in the modelled cache and the number of triangles still using it.
+// Vertices of the last triangle get a fixed score, so that strips are not favoured over fans
+float forsythVertexScore(int cachePosition, unsigned int remainingTriangles) {
+
+    // Vertices no longer used by any triangle should never attract one
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f;
+        }
+        else {
+            float scaler = 1.0f / (forsythCacheSize - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+
+    // Boost vertices with few remaining triangles, so that they are finished off and leave the cache
+    score += 2.0f * std::pow(static_cast<float>(remainingTriangles), -0.5f);
+
+    return score;
+}
+
+}
+
+// Reorders the triangles of the mesh to reuse the GPU's post-transform vertex cache
+void optimizeVertexCache(MeshData& mesh) {
+    optimizeVertexCache(mesh.indices, mesh.vertexCount());
+}
+
+// Reorders triangles indexing 'vertexCount' vertices to reuse the GPU's post-transform vertex cache
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount) {
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Count the triangles using each vertex
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (unsigned int index : indices) {
+        remainingTriangles[index]++;
+    }
+
+    // Store the triangles of each vertex contiguously. The live triangles of vertex v are
+    // adjacency[adjacencyOffsets[v] .. adjacencyOffsets[v] + remainingTriangles[v])
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    // Initial scores of vertices (none is cached) and triangles
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        vertexScores[v] = forsythVertexScore(-1, remainingTriangles[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    long bestTriangle = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+        if (triangleScores[t] > triangleScores[bestTriangle]) {
+            bestTriangle = static_cast<long>(t);
+        }
+    }
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> newCache;
+    cache.reserve(forsythCacheSize + 3);
+    newCache.reserve(forsythCacheSize + 3);
+
+    std::vector<unsigned int> optimizedIndices;
+    optimizedIndices.reserve(indices.size());
+    size_t nextUnemitted = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+
+        // No cached vertex has a live triangle left: continue from the first triangle not emitted yet
+        if (bestTriangle < 0) {
+            while (emitted[nextUnemitted]) {
+                nextUnemitted++;
+            }
+            bestTriangle = static_cast<long>(nextUnemitted);
+        }
+
+        // Emit the best triangle
+        size_t t = static_cast<size_t>(bestTriangle);
+        emitted[t] = true;
+        const unsigned int* triangle = &indices[3 * t];
+        optimizedIndices.insert(optimizedIndices.end(), triangle, triangle + 3);
+
+        // Remove the triangle from the live triangles of its vertices
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = triangle[k];
+            unsigned int* live = &adjacency[adjacencyOffsets[v]];
+            unsigned int* last = live + remainingTriangles[v] - 1;
+            *std::find(live, last + 1, static_cast<unsigned int>(t)) = *last;
+            remainingTriangles[v]--;
+        }
+
+        // Move the triangle's vertices to the front of the modelled cache
+        newCache.assign(triangle, triangle + 3);
+        for (unsigned int v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache.push_back(v);
+            }
+        }
+
+        // Update the scores of every vertex that was or is in the cache, including the evicted ones
+        for (size_t i = 0; i < newCache.size(); ++i) {
+            unsigned int v = newCache[i];
+            cachePosition[v] = i < static_cast<size_t>(forsythCacheSize) ? static_cast<int>(i) : -1;
+            vertexScores[v] = forsythVertexScore(cachePosition[v], remainingTriangles[v]);
+        }
+
+        // Rescore the live triangles of those vertices, and pick the best as the next one to emit
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : newCache) {
+            for (unsigned int a = 0; a < remainingTriangles[v]; ++a) {
+                unsigned int candidate = adjacency[adjacencyOffsets[v] + a];
+                const unsigned int* candidateTriangle = &indices[3 * candidate];
+                float score = vertexScores[candidateTriangle[0]] + vertexScores[candidateTriangle[1]] + vertexScores[candidateTriangle[2]];
+                triangleScores[candidate] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = candidate;
+                }
+            }
+        }
+
+        // Keep only the vertices that still fit in the cache
+        if (newCache.size() > static_cast<size_t>(forsythCacheSize)) {
+            newCache.resize(forsythCacheSize);
+        }
+        cache.swap(newCache);
+    }
+
+    indices.swap(optimizedIndices);
+}
+
+// Reorders the vertices of the mesh in the order the triangles first use them
+void optimizeVertexFetch(MeshData& mesh) {
+
+    const unsigned int floatsPerVertex = MeshData::floatsPerVertex;
+    const unsigned int unused = ~0u;
+
+    std::vector<unsigned int> remap(mesh.vertexCount(), unused);
+    std::vector<float> reorderedVertices;
+    reorderedVertices.reserve(mesh.vertices.size());
+
+    unsigned int nextVertex = 0;
+    for (unsigned int& index : mesh.indices) {
+
+        // Copy each vertex the first time a triangle uses it
+        if (remap[index] == unused) {
+            remap[index] = nextVertex++;
+            const float* vertex = &mesh.vertices[static_cast<size_t>(index) * floatsPerVertex];
+            reorderedVertices.insert(reorderedVertices.end(), vertex, vertex + floatsPerVertex);
+        }
+
+        index = remap[index];
+    }
+
+    mesh.vertices.swap(reorderedVertices);
+}
+
+// Simulates a FIFO post-transform cache and returns the average number of cache misses per triangle
+float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+
+    if (indices.empty()) {
+        return 0.0f;
+    }
+
+    // A vertex is cached if fewer than 'cacheSize' other vertices were loaded since it was last loaded
+    std::vector<unsigned int> loadTime(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+
+    for (unsigned int index : indices) {
+        if (time - loadTime[index] > cacheSize) {
+            loadTime[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
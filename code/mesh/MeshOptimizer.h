@@ -0,0 +1,21 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include "MeshData.h"
+#include <vector>
+
+// Reorders the triangles of the mesh to reuse the GPU's post-transform vertex cache (Forsyth's algorithm)
+void optimizeVertexCache(MeshData& mesh);
+
+// Reorders triangles indexing 'vertexCount' vertices, e.g. those of a level of detail
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+// Reorders the vertices of the mesh in the order the triangles first use them, for locality of vertex fetches.
+// Vertices not referenced by any triangle are dropped
+void optimizeVertexFetch(MeshData& mesh);
+
+// Simulates a FIFO post-transform cache and returns the average number of cache misses per triangle (ACMR).
+// An unindexed mesh scores 3.0; a well ordered sphere approaches 0.5 - 0.7
+float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+#endif
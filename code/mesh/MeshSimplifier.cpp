@@ -0,0 +1,530 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+const unsigned int noVertex = 0xffffffffu;
+const unsigned int manyVertices = 0xfffffffeu;
+
+// How a vertex may move during simplification
+enum class VertexKind : unsigned char {
+
+    // Surrounded by triangles: may collapse onto any neighbour
+    Manifold,
+
+    // On a single open edge loop: may only collapse along it, onto another border vertex
+    Border,
+
+    // One of the two copies of a vertex on a texture seam: collapses along the seam, together with its copy
+    Seam,
+
+    // Never removed
+    Locked
+
+};
+
+// Weight of the planes keeping borders and seams in place, relative to the planes of the triangles
+const double edgeWeight = 10.0;
+
+// Sum of squared distances to a set of weighted planes, as a symmetric 4x4 matrix
+struct Quadric {
+
+    double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+    double yy = 0.0, yz = 0.0, yw = 0.0;
+    double zz = 0.0, zw = 0.0;
+    double ww = 0.0;
+
+    // Total weight of the planes
+    double weight = 0.0;
+
+    // Adds the plane of unit normal n through offset d (n.p + d = 0)
+    void addPlane(const glm::dvec3& n, double d, double planeWeight) {
+        xx += planeWeight * n.x * n.x; xy += planeWeight * n.x * n.y; xz += planeWeight * n.x * n.z; xw += planeWeight * n.x * d;
+        yy += planeWeight * n.y * n.y; yz += planeWeight * n.y * n.z; yw += planeWeight * n.y * d;
+        zz += planeWeight * n.z * n.z; zw += planeWeight * n.z * d;
+        ww += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    void add(const Quadric& other) {
+        xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+        yy += other.yy; yz += other.yz; yw += other.yw;
+        zz += other.zz; zw += other.zw;
+        ww += other.ww;
+        weight += other.weight;
+    }
+
+    // Weighted mean of the squared distances from a point to the planes
+    double evaluate(const glm::dvec3& p) const {
+        double sum = xx * p.x * p.x + 2.0 * xy * p.x * p.y + 2.0 * xz * p.x * p.z + 2.0 * xw * p.x
+                   + yy * p.y * p.y + 2.0 * yz * p.y * p.z + 2.0 * yw * p.y
+                   + zz * p.z * p.z + 2.0 * zw * p.z
+                   + ww;
+        return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+    }
+
+};
+
+// A candidate collapse of vertex 'from' onto vertex 'to'
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+};
+
+uint64_t edgeKey(unsigned int a, unsigned int b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Records an open edge of a vertex: the single one, or 'manyVertices' if there are several
+void recordOpenEdge(unsigned int& slot, unsigned int vertex) {
+    slot = slot == noVertex ? vertex : manyVertices;
+}
+
+bool isSingleEdge(unsigned int slot) {
+    return slot != noVertex && slot != manyVertices;
+}
+
+// Distance from a point to a triangle (closest point by Voronoi regions, from Ericson's Real-Time Collision Detection)
+double distanceToTriangle(const glm::dvec3& p, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) {
+
+    glm::dvec3 ab = b - a, ac = c - a, ap = p - a;
+    double d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        return glm::length(ap);
+    }
+
+    glm::dvec3 bp = p - b;
+    double d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        return glm::length(bp);
+    }
+
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        return glm::length(ap - ab * (d1 / (d1 - d3)));
+    }
+
+    glm::dvec3 cp = p - c;
+    double d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        return glm::length(cp);
+    }
+
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        return glm::length(ap - ac * (d2 / (d2 - d6)));
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        return glm::length(bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+
+    double denominator = 1.0 / (va + vb + vc);
+    return glm::length(ap - ab * (vb * denominator) - ac * (vc * denominator));
+}
+
+}
+
+// Collapses edges in passes: each pass sorts the possible collapses by error and applies the cheapest ones whose
+// vertices are untouched in the pass, then drops the triangles that became degenerate
+std::vector<unsigned int> simplifyMesh(const MeshData& mesh, const std::vector<unsigned int>& indices, size_t targetIndexCount, float maxError, float& error) {
+
+    error = 0.0f;
+    unsigned int vertexCount = mesh.vertexCount();
+    std::vector<glm::dvec3> positions(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* position = &mesh.vertices[static_cast<size_t>(i) * MeshData::floatsPerVertex];
+        positions[i] = glm::dvec3(position[0], position[1], position[2]);
+    }
+
+    // Group the vertices sharing a position, e.g. on both sides of a texture seam. 'wedge' links each group into a ring,
+    // and the first vertex of a group holds its quadric
+    std::vector<unsigned int> positionRoot(vertexCount);
+    std::vector<unsigned int> wedge(vertexCount);
+    std::vector<unsigned int> wedgeSize(vertexCount, 1);
+    {
+        std::unordered_map<std::string, unsigned int> firstVertex;
+        firstVertex.reserve(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+            const float* position = &mesh.vertices[static_cast<size_t>(i) * MeshData::floatsPerVertex];
+            std::string key(reinterpret_cast<const char*>(position), 3 * sizeof(float));
+            auto inserted = firstVertex.emplace(key, i);
+            unsigned int root = inserted.first->second;
+            positionRoot[i] = root;
+            if (root == i) {
+                wedge[i] = i;
+            }
+            else {
+                wedge[i] = wedge[root];
+                wedge[root] = i;
+                wedgeSize[root]++;
+            }
+        }
+    }
+
+    // Find the open edges: directed edges whose opposite edge belongs to no triangle
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int k = 0; k < 3; ++k) {
+            edges.insert(edgeKey(indices[i + k], indices[i + (k + 1) % 3]));
+        }
+    }
+    std::vector<unsigned int> openOut(vertexCount, noVertex), openIn(vertexCount, noVertex);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = indices[i + k], b = indices[i + (k + 1) % 3];
+            if (edges.count(edgeKey(b, a)) == 0) {
+                recordOpenEdge(openOut[a], b);
+                recordOpenEdge(openIn[b], a);
+            }
+        }
+    }
+
+    // Classify the vertices
+    std::vector<VertexKind> kinds(vertexCount, VertexKind::Locked);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        unsigned int size = wedgeSize[positionRoot[i]];
+        bool isClosed = openOut[i] == noVertex && openIn[i] == noVertex;
+        bool isOnLoop = isSingleEdge(openOut[i]) && isSingleEdge(openIn[i]);
+        if (size == 1) {
+            kinds[i] = isClosed ? VertexKind::Manifold : (isOnLoop ? VertexKind::Border : VertexKind::Locked);
+        }
+        else if (size == 2 && isOnLoop) {
+            // Both copies must follow the same seam in opposite directions
+            unsigned int copy = wedge[i];
+            if (isSingleEdge(openOut[copy]) && isSingleEdge(openIn[copy])
+                && positionRoot[openOut[i]] == positionRoot[openIn[copy]] && positionRoot[openIn[i]] == positionRoot[openOut[copy]]) {
+                kinds[i] = VertexKind::Seam;
+            }
+        }
+    }
+
+    // Quadric of every position: the planes of its triangles weighted by area, and planes along its open edges
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const glm::dvec3& p0 = positions[indices[i]];
+        const glm::dvec3& p1 = positions[indices[i + 1]];
+        const glm::dvec3& p2 = positions[indices[i + 2]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double length = glm::length(normal);
+        if (length == 0.0) {
+            continue;
+        }
+        normal /= length;
+        for (int k = 0; k < 3; ++k) {
+            quadrics[positionRoot[indices[i + k]]].addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = indices[i + k], b = indices[i + (k + 1) % 3];
+            if (edges.count(edgeKey(b, a)) != 0) {
+                continue;
+            }
+            glm::dvec3 edge = positions[b] - positions[a];
+            double edgeLength = glm::length(edge);
+            if (edgeLength == 0.0) {
+                continue;
+            }
+            glm::dvec3 edgeNormal = glm::normalize(glm::cross(edge, normal));
+            double offset = -glm::dot(edgeNormal, positions[a]);
+            quadrics[positionRoot[a]].addPlane(edgeNormal, offset, edgeLength * edgeLength * edgeWeight);
+            quadrics[positionRoot[b]].addPlane(edgeNormal, offset, edgeLength * edgeLength * edgeWeight);
+        }
+    }
+
+    // Whether 'from' may collapse onto its neighbour 'to'. Borders and seams only collapse along their open edges
+    auto canCollapse = [&](unsigned int from, unsigned int to) {
+        switch (kinds[from]) {
+        case VertexKind::Manifold:
+            return true;
+        case VertexKind::Border:
+            return kinds[to] == VertexKind::Border && (openOut[from] == to || openIn[from] == to);
+        case VertexKind::Seam:
+            return kinds[to] == VertexKind::Seam && (openOut[from] == to || openIn[from] == to);
+        default:
+            return false;
+        }
+    };
+
+    std::vector<unsigned int> result = indices;
+    std::vector<unsigned int> collapseTarget(vertexCount);
+    std::vector<unsigned char> touched(vertexCount);
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<Collapse> collapses;
+    double maxCost = static_cast<double>(maxError) * maxError;
+
+    // Vertex every vertex was merged into, through all the passes
+    std::vector<unsigned int> mergedInto(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        mergedInto[v] = v;
+    }
+
+    while (result.size() > targetIndexCount) {
+
+        size_t triangleCount = result.size() / 3;
+
+        // Triangles of each vertex, stored contiguously
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (unsigned int index : result) {
+            adjacencyOffsets[index + 1]++;
+        }
+        for (unsigned int v = 0; v < vertexCount; ++v) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<unsigned int> filled(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[filled[result[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        // Every possible collapse, cheapest first
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                unsigned int a = result[i + k], b = result[i + (k + 1) % 3];
+                if (canCollapse(a, b)) {
+                    collapses.push_back({ a, b, quadrics[positionRoot[a]].evaluate(positions[b]) });
+                }
+                if (canCollapse(b, a)) {
+                    collapses.push_back({ b, a, quadrics[positionRoot[b]].evaluate(positions[a]) });
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        // A collapse removes about two triangles, so stop at about the number still in excess
+        size_t collapseGoal = std::max<size_t>(1, (triangleCount - targetIndexCount / 3) / 2);
+        size_t collapseCount = 0;
+        for (unsigned int v = 0; v < vertexCount; ++v) {
+            collapseTarget[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        // Whether moving 'from' onto 'to' keeps every triangle around 'from' facing the same way
+        auto keepsOrientation = [&](unsigned int from, unsigned int to) {
+            for (unsigned int t = adjacencyOffsets[from]; t < adjacencyOffsets[from + 1]; ++t) {
+                unsigned int triangle = adjacency[t];
+                unsigned int corners[3];
+                for (int k = 0; k < 3; ++k) {
+                    corners[k] = collapseTarget[result[triangle * 3 + k]];
+                }
+                if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2]) {
+                    continue;
+                }
+                if (corners[0] == to || corners[1] == to || corners[2] == to) {
+                    continue;
+                }
+                glm::dvec3 before = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+                for (int k = 0; k < 3; ++k) {
+                    if (corners[k] == from) {
+                        corners[k] = to;
+                    }
+                }
+                glm::dvec3 after = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+                if (glm::dot(before, after) < 1.0e-2 * glm::length(before) * glm::length(after)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Whether the positions of 'from' and 'to' have no common neighbours besides those of the triangles joining them.
+        // Collapsing an edge with other common neighbours would fold the surface into edges shared by more than two triangles
+        std::vector<unsigned int> fromNeighbours, toNeighbours;
+        auto keepsManifold = [&](unsigned int from, unsigned int to) {
+            unsigned int fromRoot = positionRoot[from], toRoot = positionRoot[to];
+            size_t joiningTriangles = 0;
+            auto gatherNeighbours = [&](unsigned int vertex, unsigned int otherRoot, std::vector<unsigned int>& neighbours, size_t* joining) {
+                neighbours.clear();
+                unsigned int copy = vertex;
+                do {
+                    for (unsigned int t = adjacencyOffsets[copy]; t < adjacencyOffsets[copy + 1]; ++t) {
+                        unsigned int triangle = adjacency[t];
+                        unsigned int roots[3];
+                        for (int k = 0; k < 3; ++k) {
+                            roots[k] = positionRoot[collapseTarget[result[triangle * 3 + k]]];
+                        }
+                        if (roots[0] == roots[1] || roots[1] == roots[2] || roots[0] == roots[2]) {
+                            continue;
+                        }
+                        bool isJoining = roots[0] == otherRoot || roots[1] == otherRoot || roots[2] == otherRoot;
+                        if (isJoining && joining) {
+                            ++*joining;
+                        }
+                        for (int k = 0; k < 3; ++k) {
+                            if (roots[k] != fromRoot && roots[k] != toRoot) {
+                                neighbours.push_back(roots[k]);
+                            }
+                        }
+                    }
+                    copy = wedge[copy];
+                } while (copy != vertex);
+                std::sort(neighbours.begin(), neighbours.end());
+                neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            };
+            gatherNeighbours(positionRoot[from], toRoot, fromNeighbours, &joiningTriangles);
+            gatherNeighbours(positionRoot[to], fromRoot, toNeighbours, nullptr);
+
+            size_t commonNeighbours = 0;
+            for (size_t i = 0, j = 0; i < fromNeighbours.size() && j < toNeighbours.size();) {
+                if (fromNeighbours[i] < toNeighbours[j]) {
+                    ++i;
+                }
+                else if (fromNeighbours[i] > toNeighbours[j]) {
+                    ++j;
+                }
+                else {
+                    ++commonNeighbours;
+                    ++i;
+                    ++j;
+                }
+            }
+            return commonNeighbours <= joiningTriangles;
+        };
+
+        for (const Collapse& collapse : collapses) {
+            if (collapseCount >= collapseGoal || collapse.cost > maxCost) {
+                break;
+            }
+            // Positions, not vertices, are touched, so that the two sides of a seam cannot change independently in one pass
+            unsigned int from = collapse.from, to = collapse.to;
+            if (touched[positionRoot[from]] || touched[positionRoot[to]]) {
+                continue;
+            }
+
+            // A seam collapses on both sides, along the matching edge of the other copy
+            unsigned int copyFrom = noVertex, copyTo = noVertex;
+            if (kinds[from] == VertexKind::Seam) {
+                copyFrom = wedge[from];
+                copyTo = wedge[to];
+                if (openOut[copyFrom] != copyTo && openIn[copyFrom] != copyTo) {
+                    continue;
+                }
+            }
+
+            if (!keepsOrientation(from, to) || (copyFrom != noVertex && !keepsOrientation(copyFrom, copyTo)) || !keepsManifold(from, to)) {
+                continue;
+            }
+
+            collapseTarget[from] = to;
+            touched[positionRoot[from]] = touched[positionRoot[to]] = 1;
+            if (copyFrom != noVertex) {
+                collapseTarget[copyFrom] = copyTo;
+            }
+            if (positionRoot[from] != positionRoot[to]) {
+                quadrics[positionRoot[to]].add(quadrics[positionRoot[from]]);
+            }
+            ++collapseCount;
+        }
+
+        if (collapseCount == 0) {
+            break;
+        }
+
+        for (unsigned int v = 0; v < vertexCount; ++v) {
+            mergedInto[v] = collapseTarget[mergedInto[v]];
+        }
+
+        // Move the collapsed vertices and drop the triangles left without area
+        size_t kept = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = collapseTarget[result[i]], b = collapseTarget[result[i + 1]], c = collapseTarget[result[i + 2]];
+            if (a != b && b != c && a != c) {
+                result[kept++] = a;
+                result[kept++] = b;
+                result[kept++] = c;
+            }
+        }
+        result.resize(kept);
+    }
+
+    // The quadrics overestimate how far the surface moved, so measure the distance from every removed vertex to the
+    // nearest remaining triangle within two rings of the position it was merged into
+    std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+    for (unsigned int index : result) {
+        adjacencyOffsets[positionRoot[index] + 1]++;
+    }
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    adjacency.resize(result.size());
+    {
+        std::vector<unsigned int> filled(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) {
+            adjacency[filled[positionRoot[result[i]]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+    double largestDistance = 0.0;
+    std::fill(touched.begin(), touched.end(), 0);
+    for (unsigned int index : indices) {
+        unsigned int root = positionRoot[mergedInto[index]];
+        if (mergedInto[index] == index || touched[index]) {
+            continue;
+        }
+        touched[index] = 1;
+        double distance = std::numeric_limits<double>::max();
+        for (unsigned int t = adjacencyOffsets[root]; t < adjacencyOffsets[root + 1]; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                unsigned int neighbour = positionRoot[result[adjacency[t] * 3 + k]];
+                for (unsigned int n = adjacencyOffsets[neighbour]; n < adjacencyOffsets[neighbour + 1]; ++n) {
+                    const unsigned int* corners = &result[adjacency[n] * 3];
+                    distance = std::min(distance, distanceToTriangle(positions[index], positions[corners[0]], positions[corners[1]], positions[corners[2]]));
+                }
+            }
+        }
+        if (distance != std::numeric_limits<double>::max()) {
+            largestDistance = std::max(largestDistance, distance);
+        }
+    }
+
+    error = static_cast<float>(largestDistance);
+    return result;
+}
+
+// Simplifies the full mesh to a quarter of the triangles of each previous level, and appends the levels to its indices
+void buildLevelsOfDetail(MeshData& mesh, unsigned int maxLevelCount, size_t minimumTriangleCount, float maxError) {
+
+    std::vector<unsigned int> fullIndices(mesh.indices);
+    float radius = computeBoundingSphere(mesh).radius;
+
+    mesh.levels.clear();
+    mesh.levels.push_back({ 0, static_cast<uint32_t>(fullIndices.size()), 0.0f });
+
+    size_t previousIndexCount = fullIndices.size();
+    while (mesh.levels.size() < maxLevelCount && previousIndexCount / 12 >= minimumTriangleCount) {
+
+        float error = 0.0f;
+        std::vector<unsigned int> levelIndices = simplifyMesh(mesh, fullIndices, previousIndexCount / 12 * 3, maxError * radius, error);
+
+        // Stop when the locked vertices keep the mesh from shrinking much further
+        if (levelIndices.empty() || levelIndices.size() * 5 > previousIndexCount * 4) {
+            break;
+        }
+
+        optimizeVertexCache(levelIndices, mesh.vertexCount());
+
+        MeshLevel level;
+        level.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+        level.indexCount = static_cast<uint32_t>(levelIndices.size());
+        level.error = radius > 0.0f ? std::max(error / radius, mesh.levels.back().error) : 0.0f;
+        mesh.levels.push_back(level);
+        mesh.indices.insert(mesh.indices.end(), levelIndices.begin(), levelIndices.end());
+
+        previousIndexCount = levelIndices.size();
+    }
+}
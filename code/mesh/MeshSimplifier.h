@@ -0,0 +1,19 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "MeshData.h"
+#include <vector>
+
+// Simplifies the triangles 'indices' of the mesh by collapsing edges with the smallest quadric error, until at most
+// 'targetIndexCount' indices remain or no edge can collapse with an error below 'maxError'. Vertices are only removed, never moved, so the result
+// indexes the mesh's own vertices. Texture seams collapse on both sides at once and stay closed, and the vertices of
+// more complex seams and borders are kept. Sets 'error' to the largest distance between a removed vertex and the
+// triangles near the vertex it was merged into, in model units
+std::vector<unsigned int> simplifyMesh(const MeshData& mesh, const std::vector<unsigned int>& indices, size_t targetIndexCount, float maxError, float& error);
+
+// Appends levels of detail to the mesh's indices, each simplified from the full mesh to about a quarter of the
+// triangles of the previous level, until 'maxLevelCount' levels, 'minimumTriangleCount' triangles or simplification
+// stalls. No collapse moves the surface by more than 'maxError' times the radius of the bounding sphere
+void buildLevelsOfDetail(MeshData& mesh, unsigned int maxLevelCount = 6, size_t minimumTriangleCount = 32, float maxError = 0.25f);
+
+#endif
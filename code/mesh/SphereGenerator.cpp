@@ -0,0 +1,212 @@
+#include "SphereGenerator.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// Fewest divisions of a level: below 4 meridians a UV sphere is flat, while a cube sphere can go down to the cube
+const unsigned int minimumUvSegments = 4;
+const unsigned int minimumCubeSegments = 1;
+
+// The cube net of the textures is 4 faces wide and 3 high, inside a margin of about 19 pixels
+const float netMarginU = 0.009051f;
+const float netMarginV = 0.011996f;
+const float netFaceWidth = (1.0f - 2.0f * netMarginU) / 4.0f;
+const float netFaceHeight = (1.0f - 2.0f * netMarginV) / 3.0f;
+
+// A face of the cube: its outward axis, the axes along which its texture coordinates grow, and its place in the net.
+// The axes are whole unit vectors, so that the vertices shared by two faces are computed from the same values
+struct CubeFace {
+    glm::vec3 normal;
+    glm::vec3 right;
+    glm::vec3 up;
+    unsigned int column;
+    unsigned int row;
+};
+
+// Around the equator eastwards from -X, with the north pole above the +Z face and the south pole below it
+const CubeFace cubeFaces[6] = {
+    { glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0, 1 },
+    { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 1, 1 },
+    { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), 2, 1 },
+    { glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 3, 1 },
+    { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 1, 2 },
+    { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), 1, 0 }
+};
+
+// Coordinate on a face of the equal-angle cube of division 'k' out of [-segments, segments]. Spacing the divisions
+// by angle rather than by length keeps the triangles near the corners from shrinking. The edges are exactly +-1
+float cubeCoordinate(int k, unsigned int segments) {
+    int edge = static_cast<int>(segments);
+    if (k == -edge || k == edge) {
+        return static_cast<float>(k / edge);
+    }
+    return static_cast<float>(std::tan(0.25 * pi * k / edge));
+}
+
+// Appends a vertex on the unit sphere, moved by the placement. Its direction is kept to measure the error of the levels
+void appendVertex(MeshData& mesh, std::vector<glm::vec3>& directions, const glm::vec3& direction, float u, float v, const glm::mat4& placement) {
+
+    directions.push_back(direction);
+
+    glm::vec3 position = glm::vec3(placement * glm::vec4(direction, 1.0f));
+    glm::vec3 normal = glm::normalize(glm::mat3(placement) * direction);
+
+    mesh.vertices.insert(mesh.vertices.end(), { position.x, position.y, position.z, u, v, normal.x, normal.y, normal.z });
+}
+
+// Meridians and rings of latitude, from the south pole up, each with a vertex on the seam at both ends. The poles
+// have a vertex per meridian, so that every triangle touching them gets its own texture coordinate
+void generateUvVertices(unsigned int segments, const glm::mat4& placement, MeshData& mesh, std::vector<glm::vec3>& directions) {
+
+    for (unsigned int ring = 0; ring <= segments; ++ring) {
+        double latitude = pi * ring / segments - 0.5 * pi;
+        for (unsigned int meridian = 0; meridian <= segments; ++meridian) {
+
+            // The seam's second column repeats the first one, and the poles are exact, so that no crack opens there
+            double longitude = 2.0 * pi * (meridian % segments) / segments;
+            glm::vec3 direction(static_cast<float>(std::sin(longitude) * std::cos(latitude)), static_cast<float>(std::sin(latitude)),
+                                static_cast<float>(std::cos(longitude) * std::cos(latitude)));
+            if (ring == 0 || ring == segments) {
+                direction = glm::vec3(0.0f, ring == 0 ? -1.0f : 1.0f, 0.0f);
+            }
+
+            // The top of the image is the north pole
+            appendVertex(mesh, directions, direction, static_cast<float>(meridian) / segments, 1.0f - static_cast<float>(ring) / segments, placement);
+        }
+    }
+}
+
+// Triangles of a UV sphere keeping every 'stride'-th meridian and ring. The quads touching a pole lose their degenerate half
+void generateUvTriangles(unsigned int segments, unsigned int stride, std::vector<unsigned int>& indices) {
+
+    unsigned int rowLength = segments + 1;
+    for (unsigned int ring = 0; ring < segments; ring += stride) {
+        for (unsigned int meridian = 0; meridian < segments; meridian += stride) {
+
+            // Counter-clockwise seen from outside: east is to the right and north is up
+            unsigned int bottomLeft = ring * rowLength + meridian;
+            unsigned int bottomRight = bottomLeft + stride;
+            unsigned int topLeft = bottomLeft + stride * rowLength;
+            unsigned int topRight = topLeft + stride;
+
+            if (ring + stride < segments) {
+                indices.insert(indices.end(), { bottomLeft, topRight, topLeft });
+            }
+            if (ring > 0) {
+                indices.insert(indices.end(), { bottomLeft, bottomRight, topRight });
+            }
+        }
+    }
+}
+
+// A grid of vertices per face of the cube, projected onto the sphere. The edges of the faces are repeated, as their
+// texture coordinates differ from one face to the next
+void generateCubeVertices(unsigned int segments, const glm::mat4& placement, MeshData& mesh, std::vector<glm::vec3>& directions) {
+
+    for (const CubeFace& face : cubeFaces) {
+        for (unsigned int row = 0; row <= segments; ++row) {
+            float up = cubeCoordinate(static_cast<int>(2 * row) - static_cast<int>(segments), segments);
+            for (unsigned int column = 0; column <= segments; ++column) {
+                float right = cubeCoordinate(static_cast<int>(2 * column) - static_cast<int>(segments), segments);
+
+                glm::vec3 direction = glm::normalize(face.normal + right * face.right + up * face.up);
+
+                // Place the face in the net. The top of the image is the north pole's row
+                float u = netMarginU + (face.column + static_cast<float>(column) / segments) * netFaceWidth;
+                float v = netMarginV + (2 - face.row + static_cast<float>(segments - row) / segments) * netFaceHeight;
+                appendVertex(mesh, directions, direction, u, v, placement);
+            }
+        }
+    }
+}
+
+// Triangles of a cube sphere keeping every 'stride'-th row and column of each face
+void generateCubeTriangles(unsigned int segments, unsigned int stride, std::vector<unsigned int>& indices) {
+
+    unsigned int rowLength = segments + 1;
+    for (unsigned int face = 0; face < 6; ++face) {
+        unsigned int firstVertex = face * rowLength * rowLength;
+        for (unsigned int row = 0; row < segments; row += stride) {
+            for (unsigned int column = 0; column < segments; column += stride) {
+
+                // Counter-clockwise seen from outside, as 'right' x 'up' is the face's normal
+                unsigned int bottomLeft = firstVertex + row * rowLength + column;
+                unsigned int bottomRight = bottomLeft + stride;
+                unsigned int topLeft = bottomLeft + stride * rowLength;
+                unsigned int topRight = topLeft + stride;
+
+                indices.insert(indices.end(), { bottomLeft, bottomRight, topRight, bottomLeft, topRight, topLeft });
+            }
+        }
+    }
+}
+
+// Largest distance between the triangles and the unit sphere through their vertices. The farthest point of a
+// triangle is the foot of the perpendicular from the center, so the distance is 1 minus that of the triangle's plane
+float sphereError(const std::vector<glm::vec3>& directions, const std::vector<unsigned int>& indices) {
+
+    float error = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& a = directions[indices[i]];
+        glm::vec3 normal = glm::cross(directions[indices[i + 1]] - a, directions[indices[i + 2]] - a);
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            error = std::max(error, 1.0f - std::fabs(glm::dot(normal, a)) / length);
+        }
+    }
+    return error;
+}
+
+}
+
+// Generates the vertices of the full mesh, then the triangles of each level by skipping divisions
+MeshData generateSphere(const SphereDescription& description) {
+
+    bool isCube = description.kind == SphereKind::Cube;
+    unsigned int minimumSegments = isCube ? minimumCubeSegments : minimumUvSegments;
+
+    // Round the divisions down to a power of two, so that halving them always keeps whole divisions
+    unsigned int segments = minimumSegments;
+    while (segments * 2 <= description.segments) {
+        segments *= 2;
+    }
+
+    // Vertices of the full mesh, with their directions on the unit sphere before the placement
+    MeshData mesh;
+    std::vector<glm::vec3> directions;
+    if (isCube) {
+        generateCubeVertices(segments, description.placement, mesh, directions);
+    }
+    else {
+        generateUvVertices(segments, description.placement, mesh, directions);
+    }
+
+    // Each level keeps every other division of the previous one, and thus a quarter of its triangles
+    unsigned int levelCount = std::max(description.levelCount, 1u);
+    for (unsigned int level = 0, stride = 1; level < levelCount && segments / stride >= minimumSegments; ++level, stride *= 2) {
+
+        std::vector<unsigned int> levelIndices;
+        if (isCube) {
+            generateCubeTriangles(segments, stride, levelIndices);
+        }
+        else {
+            generateUvTriangles(segments, stride, levelIndices);
+        }
+        optimizeVertexCache(levelIndices, mesh.vertexCount());
+
+        // The full mesh has no error by definition. A coarser level is at most as far from it as from the sphere
+        float error = level == 0 ? 0.0f : sphereError(directions, levelIndices);
+
+        mesh.levels.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(levelIndices.size()), error });
+        mesh.indices.insert(mesh.indices.end(), levelIndices.begin(), levelIndices.end());
+    }
+
+    // Store the vertices in the order the levels use them. The seam's unused pole vertex is dropped
+    optimizeVertexFetch(mesh);
+
+    return mesh;
+}
@@ -0,0 +1,40 @@
+#ifndef SPHERE_GENERATOR_H
+#define SPHERE_GENERATOR_H
+
+#include "MeshData.h"
+
+// How a procedural sphere is divided into triangles
+enum class SphereKind {
+
+    // Meridians and rings of latitude, with equirectangular texture coordinates. The poles are on the y axis
+    Uv,
+
+    // The six faces of a cube pushed out onto the sphere (equal-angle), with texture coordinates in a cross-shaped
+    // cube net: four faces around the equator in the middle row, and the poles above and below the second one
+    Cube
+
+};
+
+// Parameters of a procedural sphere mesh
+struct SphereDescription {
+
+    SphereKind kind = SphereKind::Uv;
+
+    // Divisions of the full mesh: the number of meridians and of rings of a UV sphere, or of rows and columns of each
+    // face of a cube sphere. Rounded down to a power of two, so that every coarser level keeps every other division
+    unsigned int segments = 64;
+
+    // Largest number of levels of detail, each with half the divisions of the previous one
+    unsigned int levelCount = 4;
+
+    // Placement of the unit sphere in model coordinates: a rotation, a uniform scale and a translation
+    glm::mat4 placement = glm::mat4(1.0f);
+
+};
+
+// Generates a sphere in the layout of MeshData, with its levels of detail. The coarser levels index a subset of the
+// full mesh's vertices, so all of them share one vertex buffer. The error of a level is the largest distance between
+// its triangles and the sphere, as a fraction of the radius
+MeshData generateSphere(const SphereDescription& description);
+
+#endif
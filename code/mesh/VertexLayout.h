@@ -0,0 +1,55 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+// One attribute of a vertex, as passed to glVertexAttribPointer()
+struct VertexAttribute {
+
+    // Attribute location in the vertex shader
+    uint32_t location;
+
+    // Number of components (1 - 4)
+    uint32_t components;
+
+    // OpenGL type of each component, e.g. GL_FLOAT
+    uint32_t type;
+
+    // Whether integer components are normalized to [0, 1] or [-1, 1]
+    uint32_t normalized;
+
+    // Offset of the attribute from the start of the vertex, in bytes
+    uint32_t offset;
+
+};
+
+// Describes how the vertices of a mesh are laid out in its vertex buffer.
+// Stored as-is in binary mesh files, so only fixed-width members are used
+struct VertexLayout {
+
+    // Maximum number of attributes of a vertex
+    static const uint32_t maxAttributes = 4;
+
+    // Size of a vertex, in bytes
+    uint32_t stride;
+
+    // Number of used entries in 'attributes'
+    uint32_t attributeCount;
+
+    VertexAttribute attributes[maxAttributes];
+
+    // The layout of MeshData: position (location 0), texture coordinates (location 1) and normal (location 2) as floats
+    static VertexLayout interleavedFloats() {
+        VertexLayout layout = {};
+        layout.stride = 8 * sizeof(float);
+        layout.attributeCount = 3;
+        layout.attributes[0] = { 0, 3, GL_FLOAT, GL_FALSE, 0 };
+        layout.attributes[1] = { 1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float) };
+        layout.attributes[2] = { 2, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float) };
+        return layout;
+    }
+
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "VertexPacking.h"
+#include "MeshData.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Size of a packed vertex, and offsets of its attributes
+const uint32_t packedStride = 16;
+const uint32_t texCoordOffset = 8;
+const uint32_t normalOffset = 12;
+
+// Largest value of a 16-bit normalized integer, and of a signed 10-bit normalized one
+const float unorm16Max = 65535.0f;
+const float snorm10Max = 511.0f;
+
+// Quantizes a value in [0, 1] to a 16-bit normalized integer
+uint16_t toUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * unorm16Max));
+}
+
+// Packs a normal into three signed 10-bit normalized components, x in the lowest bits, with w = 0
+uint32_t packNormal(const glm::vec3& normal) {
+    uint32_t packed = 0;
+    for (int i = 0; i < 3; ++i) {
+        int component = static_cast<int>(std::lround(std::min(std::max(normal[i], -1.0f), 1.0f) * snorm10Max));
+        packed |= (static_cast<uint32_t>(component) & 0x3ffu) << (10 * i);
+    }
+    return packed;
+}
+
+// Reads a normal back as the GPU does, each component being max(c / 511, -1)
+glm::vec3 unpackNormal(uint32_t packed) {
+    glm::vec3 normal;
+    for (int i = 0; i < 3; ++i) {
+        int component = static_cast<int>((packed >> (10 * i)) & 0x3ffu);
+        if (component >= 512) {
+            component -= 1024;
+        }
+        normal[i] = std::max(component / snorm10Max, -1.0f);
+    }
+    return normal;
+}
+
+}
+
+// Packs the vertices, choosing the formats of the positions and the texture coordinates from their values
+void packVertices(const float* vertices, unsigned int vertexCount, PackedVertices& packed) {
+
+    const unsigned int floatsPerVertex = MeshData::floatsPerVertex;
+
+    // Bounding box of the positions, which the normalized positions span
+    glm::vec3 minimum(0.0f), maximum(0.0f);
+    bool texCoordsInUnitRange = true;
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* vertex = vertices + static_cast<size_t>(i) * floatsPerVertex;
+        glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+        minimum = i == 0 ? position : glm::min(minimum, position);
+        maximum = i == 0 ? position : glm::max(maximum, position);
+        texCoordsInUnitRange = texCoordsInUnitRange && vertex[3] >= 0.0f && vertex[3] <= 1.0f && vertex[4] >= 0.0f && vertex[4] <= 1.0f;
+    }
+    glm::vec3 extent = maximum - minimum;
+
+    // Largest error of each format of the positions, decoded as the vertex shader does
+    float normalizedError = 0.0f;
+    float halfError = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* vertex = vertices + static_cast<size_t>(i) * floatsPerVertex;
+        glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+        glm::vec3 normalized, half;
+        for (int axis = 0; axis < 3; ++axis) {
+            float fraction = extent[axis] > 0.0f ? (position[axis] - minimum[axis]) / extent[axis] : 0.0f;
+            normalized[axis] = minimum[axis] + toUnorm16(fraction) / unorm16Max * extent[axis];
+            half[axis] = halfToFloat(floatToHalf(position[axis]));
+        }
+        normalizedError = std::max(normalizedError, glm::length(normalized - position));
+        halfError = std::max(halfError, glm::length(half - position));
+    }
+
+    // Half floats are more precise only for small meshes around the origin
+    bool halfPositions = halfError < normalizedError;
+    packed.positionOffset = halfPositions ? glm::vec3(0.0f) : minimum;
+    packed.positionScale = halfPositions ? glm::vec3(1.0f) : extent;
+    packed.positionError = halfPositions ? halfError : normalizedError;
+    packed.positionFormat = halfPositions ? "half float" : "16-bit normalized in the bounding box";
+
+    // Texture coordinates beyond [0, 1] repeat the texture, so they need the range of half floats
+    bool halfTexCoords = !texCoordsInUnitRange;
+    packed.texCoordFormat = halfTexCoords ? "half float" : "16-bit normalized";
+
+    uint32_t positionType = halfPositions ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT;
+    uint32_t texCoordType = halfTexCoords ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT;
+    packed.layout = {};
+    packed.layout.stride = packedStride;
+    packed.layout.attributeCount = 3;
+    packed.layout.attributes[0] = { 0, 3, positionType, positionType == GL_UNSIGNED_SHORT, 0 };
+    packed.layout.attributes[1] = { 1, 2, texCoordType, texCoordType == GL_UNSIGNED_SHORT, texCoordOffset };
+    packed.layout.attributes[2] = { 2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, normalOffset };
+
+    packed.data.assign(static_cast<size_t>(vertexCount) * packedStride, 0);
+    packed.normalError = 0.0f;
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* vertex = vertices + static_cast<size_t>(i) * floatsPerVertex;
+        uint8_t* destination = packed.data.data() + static_cast<size_t>(i) * packedStride;
+
+        // Position, padded to 8 bytes
+        uint16_t position[4] = {};
+        for (int axis = 0; axis < 3; ++axis) {
+            float fraction = extent[axis] > 0.0f ? (vertex[axis] - minimum[axis]) / extent[axis] : 0.0f;
+            position[axis] = halfPositions ? floatToHalf(vertex[axis]) : toUnorm16(fraction);
+        }
+        std::memcpy(destination, position, sizeof(position));
+
+        // Texture coordinates
+        uint16_t texCoord[2];
+        for (int component = 0; component < 2; ++component) {
+            texCoord[component] = halfTexCoords ? floatToHalf(vertex[3 + component]) : toUnorm16(vertex[3 + component]);
+        }
+        std::memcpy(destination + texCoordOffset, texCoord, sizeof(texCoord));
+
+        // Normal, measuring the angle it turns by. Missing normals stay zero
+        glm::vec3 normal(vertex[5], vertex[6], vertex[7]);
+        uint32_t packedNormal = packNormal(normal);
+        std::memcpy(destination + normalOffset, &packedNormal, sizeof(packedNormal));
+        glm::vec3 unpackedNormal = unpackNormal(packedNormal);
+        if (glm::length(normal) > 0.0f && glm::length(unpackedNormal) > 0.0f) {
+            float cosine = glm::dot(glm::normalize(normal), glm::normalize(unpackedNormal));
+            packed.normalError = std::max(packed.normalError, std::acos(std::min(cosine, 1.0f)));
+        }
+    }
+}
+
+// Rounds the float's mantissa to 10 bits, to the nearest and to even on ties. Exponents below the range of half
+// floats give subnormals or zero, and above it infinity
+uint16_t floatToHalf(float value) {
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    // Infinity and NaN, which keeps a mantissa bit
+    if (exponent == 0xffu) {
+        return static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+
+    // Subnormal half: the mantissa with its implicit bit, shifted by the missing exponent
+    if (halfExponent <= 0) {
+        if (halfExponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Rounding up may carry into the exponent, which is still the correctly rounded result
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+// Widens the exponent and the mantissa. Subnormal halves are normal floats
+float halfToFloat(uint16_t value) {
+
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+
+    if (exponent == 0) {
+        float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+
+    uint32_t bits = exponent == 0x1fu ? (sign | 0x7f800000u | (mantissa << 13)) : (sign | ((exponent + 112u) << 23) | (mantissa << 13));
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+#include "VertexLayout.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Vertices of a mesh packed into 16 bytes each, instead of the 32 bytes of MeshData's eight floats:
+// - positions as 16-bit integers normalized to the bounding box, or as half floats, whichever is more precise (8 bytes with padding)
+// - texture coordinates as 16-bit normalized integers when they are in [0, 1], otherwise as half floats (4 bytes)
+// - normals as GL_INT_2_10_10_10_REV, three signed 10-bit normalized components (4 bytes)
+struct PackedVertices {
+
+    // Packed vertex data, 'layout.stride' bytes per vertex
+    std::vector<uint8_t> data;
+
+    // Layout of 'data', passed to glVertexAttribPointer()
+    VertexLayout layout = {};
+
+    // Dequantization of the positions in the vertex shaders: position = positionOffset + packed * positionScale
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+
+    // Largest distance between a packed position and the original, in model units
+    float positionError = 0.0f;
+
+    // Largest angle between a packed normal and the original, in radians
+    float normalError = 0.0f;
+
+    // Names of the formats chosen for the positions and the texture coordinates, for the load report
+    const char* positionFormat = "";
+    const char* texCoordFormat = "";
+
+};
+
+// Packs vertices in the layout of MeshData (position, texture coordinates, normal as floats), choosing the formats
+// of the positions and the texture coordinates for this mesh
+void packVertices(const float* vertices, unsigned int vertexCount, PackedVertices& packed);
+
+// Converts a float to a half float, rounding to the nearest. Values beyond the range of half floats become infinite
+uint16_t floatToHalf(float value);
+
+// Converts a half float to a float exactly
+float halfToFloat(uint16_t value);
+
+#endif
@@ -3,83 +3,81 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <assimp/scene.h>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
+#include "../resources/ResourceCache.h"
+#include "../mesh/LevelOfDetail.h"
+#include "../render/IndirectRenderer.h"
+#include "../render/RenderQueue.h"
+#include "../scene/BatchTransform.h"
 
 class MoonModel {
 
 public:
 
-    // Constructor: Initializes a new instance of SunModel with paths for model, shaders, and texture
-    MoonModel(const std::string& modelPath, const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& texturePath);
+    // Constructor: Initializes a new instance of MoonModel with paths for model and texture, and its material, loaded through the resource cache
+    MoonModel(ResourceCache& resources, const std::string& modelPath, Material material, const std::string& texturePath);
 
-    // Renders the moon model
-    void render(const glm::vec3& earthPosition, const glm::mat4& viewMatrix);
+    // Models hold references to shared resources, so they cannot be copied
+    MoonModel(const MoonModel&) = delete;
+    MoonModel& operator=(const MoonModel&) = delete;
 
-    // Destructor: Cleans up resources
-    ~MoonModel();
+    // Places the mesh at the moon's position as body 'index' of the batch, spun to its angle at the given simulated time and
+    // scaled down, to be placed with the other bodies by computeBatchTransforms()
+    void placeMesh(TransformBatch& batch, size_t index, const glm::vec3& position, double simulatedTime) const;
 
-private:
+    // Sphere enclosing the mesh in model coordinates, for culling
+    const BoundingSphere& bounds() const;
 
-    // Stores the vertex data of the model
-    std::vector<float> vertices;
+    // Chooses the level of detail drawn by render(), from the model's bounding sphere in world coordinates
+    void selectLevel(const LevelOfDetailView& view, const BoundingSphere& worldBounds);
 
-    // OpenGL identifiers for Vertex Array Object and Vertex Buffer Object
-    unsigned int VAO, VBO;
+    // Number of triangles drawn by render()
+    unsigned int triangleCount() const;
 
-    // Number of vertices, set during processMesh() and used in render()
-    unsigned int vertexCount;
+    // Largest error of the mesh's quantized positions, as a fraction of its bounding radius. 0 for meshes of floats
+    float quantizationError() const;
 
-    // OpenGL identifier for the texture
-    unsigned int texture;
+    // Whether the mesh and the texture are uploaded. Models requested while the asset loader runs are drawn only once they are
+    bool isLoaded() const;
 
-    // Identifier for the compiled and linked shader program
-    unsigned int shaderProgram;
+    // Submits the moon model to the render queue with the transform computed from its placeMesh(). It is drawn by the queue's execute(), with
+    // the camera of the shared camera uniform buffer
+    void render(RenderQueue& queue, const BodyTransform& transform) const;
 
-    // Timestamp of the last update for animations
-    float lastUpdateTime;
+    // Queues the selected level of detail with the transform computed from its placeMesh(), to be drawn by the renderer's next submit()
+    void queueDraw(IndirectRenderer& renderer, const BodyTransform& transform) const;
 
-    // Angle of Moon's rotation
-    float rotationAngle;
+    // Destructor: Cleans up resources
+    ~MoonModel();
 
-    // Speed of Moon's self-rotation
-    float rotationSpeed;
+private:
 
-    // Radius of Moon's orbit around the Earth
-    float orbitRadius;
+    // Cache that owns the shared mesh, texture and shader program
+    ResourceCache& resources;
 
-    // Speed of Moon's orbit around the Earth
-    float orbitSpeed;
+    // Mesh of the model, shared with every model loaded from the same file
+    const MeshResource* mesh;
 
-    // Current angle of Moon's orbit
-    float orbitAngle;
+    // Texture of the model, shared with every model using the same image
+    const TextureResource* texture;
 
-    // Flag to toggle pause-state of the animation
-    bool isPaused;
+    // Material of the model, and its program, shared with every model of the same material
+    Material material;
+    const ProgramResource* program;
 
-    // Tracks if the space key was pressed in the last frame
-    bool wasSpacePressed;
+    // Level of detail of the mesh drawn by render(), kept between frames for hysteresis
+    unsigned int level = 0;
 
-   
-    // Processes an individual mesh of the model
-    void processMesh(aiMesh* mesh, const aiScene* scene);
 
-    // Sets up the vertex buffers and attributes
-    void setupBuffers();
+    // Angle of Moon's rotation at simulated time 0
+    float rotationAngle;
+
+    // Speed of Moon's self-rotation, in degrees per simulated second
+    float rotationSpeed;
 
-    // Loads the model from a given file path
-    void loadModel(const std::string& path);
 
-    // Compiles and links the vertex and fragment shaders
-    void compileShaders(const std::string& vertexPath, const std::string& fragmentPath);
-    
-    // Loads a texture from a given file path
-    void loadTexture(const std::string& texturePath);
-    
-    // Sets up the transformation matrices for the model
-    void setupMatrices();
 
 };
 
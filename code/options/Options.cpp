@@ -0,0 +1,302 @@
+#include "Options.h"
+#include "../ephemeris/Ephemeris.h"
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+// Parses a comma-separated list of counts, skipping zeros
+std::vector<size_t> parseCounts(const std::string& counts) {
+    std::vector<size_t> values;
+    size_t start = 0;
+    while (start < counts.size()) {
+        size_t end = counts.find(',', start);
+        if (end == std::string::npos) {
+            end = counts.size();
+        }
+        size_t count = static_cast<size_t>(std::strtoull(counts.substr(start, end - start).c_str(), nullptr, 10));
+        if (count > 0) {
+            values.push_back(count);
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+}
+
+// Parses the command line arguments into an Options instance
+Options parseOptions(int argc, char** argv) {
+
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+
+        std::string argument = argv[i];
+
+        // Returns the value following the current argument, or an empty string if it is missing
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "ERROR::OPTIONS::MISSING_VALUE: " << argument << std::endl;
+                return "";
+            }
+            return argv[++i];
+        };
+
+        if (argument == "--planets") {
+            options.totalPlanets = static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--planet-path") {
+            std::string path = nextValue();
+            if (path == "instanced") {
+                options.instancedPlanets = true;
+            }
+            else if (path == "per-object") {
+                options.instancedPlanets = false;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_PLANET_PATH: " << path << std::endl;
+            }
+        }
+        else if (argument == "--meshes") {
+            std::string source = nextValue();
+            if (source == "procedural") {
+                options.proceduralMeshes = true;
+            }
+            else if (source == "obj") {
+                options.proceduralMeshes = false;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_MESH_SOURCE: " << source << std::endl;
+            }
+        }
+        else if (argument == "--vertex-format") {
+            std::string format = nextValue();
+            if (format == "packed") {
+                options.packedVertices = true;
+            }
+            else if (format == "float") {
+                options.packedVertices = false;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_VERTEX_FORMAT: " << format << std::endl;
+            }
+        }
+        else if (argument == "--mesh-cache") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off" || mode == "rebuild") {
+                options.meshCache = mode;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_MESH_CACHE_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--texture-cache") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off" || mode == "rebuild") {
+                options.textureCache = mode;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_TEXTURE_CACHE_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--texture-compression") {
+            std::string compression = nextValue();
+            if (compression == "bc1") {
+                options.compressedTextures = true;
+            }
+            else if (compression == "none") {
+                options.compressedTextures = false;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_TEXTURE_COMPRESSION: " << compression << std::endl;
+            }
+        }
+        else if (argument == "--shader-cache") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off" || mode == "rebuild") {
+                options.shaderCache = mode;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_SHADER_CACHE_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--loading") {
+            std::string mode = nextValue();
+            if (mode == "async" || mode == "serial") {
+                options.loading = mode;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_LOADING_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--draw-submission") {
+            std::string mode = nextValue();
+            if (mode == "direct" || mode == "indirect") {
+                options.drawSubmission = mode;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_DRAW_SUBMISSION: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--benchmark-frames") {
+            options.benchmarkFrames = static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--seed") {
+            options.seed = static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--headless") {
+            options.headless = true;
+        }
+        else if (argument == "--resolution") {
+            // Width and height in the form WIDTHxHEIGHT
+            std::string resolution = nextValue();
+            size_t separator = resolution.find('x');
+            int width = std::atoi(resolution.substr(0, separator).c_str());
+            int height = separator == std::string::npos ? 0 : std::atoi(resolution.substr(separator + 1).c_str());
+            if (width > 0 && height > 0) {
+                options.width = width;
+                options.height = height;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_RESOLUTION: " << resolution << std::endl;
+            }
+        }
+        else if (argument == "--frames") {
+            options.frames = static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--frame-rate") {
+            double frameRate = std::atof(nextValue().c_str());
+            if (frameRate > 0.0) {
+                options.frameRate = frameRate;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_FRAME_RATE" << std::endl;
+            }
+        }
+        else if (argument == "--camera-path") {
+            options.cameraPath = nextValue();
+        }
+        else if (argument == "--dump-frames") {
+            options.dumpDirectory = nextValue();
+        }
+        else if (argument == "--dump-every") {
+            options.dumpEvery = std::max(1u, static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10)));
+        }
+        else if (argument == "--timings") {
+            options.timingsFile = nextValue();
+        }
+        else if (argument == "--benchmark-simulation") {
+            // Comma-separated list of body counts
+            std::vector<size_t> counts = parseCounts(nextValue());
+            options.simulationBenchmarkCounts.insert(options.simulationBenchmarkCounts.end(), counts.begin(), counts.end());
+        }
+        else if (argument == "--solver") {
+            std::string solver = nextValue();
+            if (solver == "direct" || solver == "barnes-hut") {
+                options.solver = solver;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_SOLVER: " << solver << std::endl;
+            }
+        }
+        else if (argument == "--theta") {
+            float openingAngle = std::strtof(nextValue().c_str(), nullptr);
+            if (openingAngle >= 0.0f && openingAngle <= 1.0f) {
+                options.openingAngle = openingAngle;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_THETA: " << openingAngle << " (expected 0 to 1)" << std::endl;
+            }
+        }
+        else if (argument == "--threads") {
+            options.threads = static_cast<unsigned int>(std::strtoul(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--culling") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off") {
+                options.culling = mode == "on";
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_CULLING_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--state-sorting") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off") {
+                options.stateSorting = mode == "on";
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_STATE_SORTING_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--lod-error") {
+            float lodError = std::strtof(nextValue().c_str(), nullptr);
+            if (lodError >= 0.0f) {
+                options.lodError = lodError;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_LOD_ERROR: " << lodError << std::endl;
+            }
+        }
+        else if (argument == "--simulation-thread") {
+            std::string mode = nextValue();
+            if (mode == "on" || mode == "off") {
+                options.simulationThread = mode == "on";
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::UNKNOWN_SIMULATION_THREAD_MODE: " << mode << std::endl;
+            }
+        }
+        else if (argument == "--time-warp") {
+            double timeWarp = std::strtod(nextValue().c_str(), nullptr);
+            if (timeWarp > 0.0) {
+                options.timeWarp = timeWarp;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_TIME_WARP: " << timeWarp << std::endl;
+            }
+        }
+        else if (argument == "--record") {
+            options.recordFile = nextValue();
+        }
+        else if (argument == "--replay") {
+            options.replayFile = nextValue();
+        }
+        else if (argument == "--date") {
+            std::string date = nextValue();
+            double julianDate;
+            if (parseJulianDate(date, julianDate)) {
+                options.date = date;
+            }
+            else {
+                std::cerr << "ERROR::OPTIONS::INVALID_DATE: " << date << " (expected YYYY-MM-DD or YYYY-MM-DDTHH:MM)" << std::endl;
+            }
+        }
+        else if (argument == "--asteroids") {
+            options.asteroids = static_cast<size_t>(std::strtoull(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--benchmark-barnes-hut") {
+            options.barnesHutAccuracyCount = static_cast<size_t>(std::strtoull(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--benchmark-scene-graph") {
+            options.sceneGraphBenchmarkCount = static_cast<size_t>(std::strtoull(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--benchmark-transforms") {
+            // Comma-separated list of body counts
+            options.transformBenchmarkCounts = parseCounts(nextValue());
+        }
+        else if (argument == "--benchmark-ephemeris") {
+            options.ephemerisBenchmarkCount = static_cast<size_t>(std::strtoull(nextValue().c_str(), nullptr, 10));
+        }
+        else if (argument == "--profile-trace") {
+            options.profileTrace = nextValue();
+        }
+        else {
+            std::cerr << "ERROR::OPTIONS::UNKNOWN_ARGUMENT: " << argument << std::endl;
+        }
+    }
+
+    return options;
+}
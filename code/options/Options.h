@@ -0,0 +1,135 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <string>
+#include <vector>
+
+// Settings of a run, parsed from the command line
+struct Options {
+
+    // Number of random planets and stars placed around the solar system
+    unsigned int totalPlanets = 5;
+
+    // Draw all planets with one instanced call (true) or one draw call per planet (false)
+    bool instancedPlanets = true;
+
+    // Generate the spheres of the Sun, Earth, Moon and planets (true) or load their object files (false). The object files stay the
+    // default until frames rendered from both sources are shown to match
+    bool proceduralMeshes = false;
+
+    // Upload the vertices packed into 16 bytes (true) or as 32 bytes of floats (false)
+    bool packedVertices = false;
+
+    // How meshes use the binary mesh files next to their object files: "on", "off" or "rebuild"
+    std::string meshCache = "on";
+
+    // How textures use the binary texture files next to their images: "on", "off" or "rebuild"
+    std::string textureCache = "on";
+
+    // How programs use the program binaries saved in ./shader-cache: "on", "off" or "rebuild"
+    std::string shaderCache = "on";
+
+    // Store the cooked textures compressed in BC1 (true) or uncompressed (false)
+    bool compressedTextures = false;
+
+    // How the meshes and images are loaded: "async" decodes them on worker threads while the first frames are drawn, "serial"
+    // loads them before the first frame. Empty loads them asynchronously, except in headless mode
+    std::string loading;
+
+    // How the scene is submitted: "indirect" draws it with a few multi-draw indirect calls, "direct" with one call per object.
+    // Empty submits it indirectly when the context supports OpenGL 4.3
+    std::string drawSubmission;
+
+    // Number of frames to time before printing a report and exiting. 0 runs until ESC is pressed
+    unsigned int benchmarkFrames = 0;
+
+    // Seed of the random placement of the planets. 0 seeds from the current time, except in headless mode
+    unsigned int seed = 0;
+
+    // Render offscreen through EGL instead of opening a window
+    bool headless = false;
+
+    // Size of the headless framebuffer
+    int width = 1920;
+    int height = 1080;
+
+    // Number of frames rendered in headless mode
+    unsigned int frames = 600;
+
+    // Frames per second of the virtual clock in headless mode
+    double frameRate = 60.0;
+
+    // Text file with the keyframes of the camera in headless mode. Empty uses the default path
+    std::string cameraPath;
+
+    // Directory receiving PNG dumps of the headless frames. Empty disables the dumps
+    std::string dumpDirectory;
+
+    // Dump one frame out of every 'dumpEvery' frames
+    unsigned int dumpEvery = 1;
+
+    // CSV file receiving the timings of every frame. Empty disables the file
+    std::string timingsFile;
+
+    // Sizes of the clusters stepped by the simulation benchmark. Not empty runs the benchmark instead of the renderer
+    std::vector<size_t> simulationBenchmarkCounts;
+
+    // Gravity solver of the scene and of the simulation benchmark: "direct" or "barnes-hut"
+    std::string solver = "direct";
+
+    // Opening angle of the Barnes-Hut solver
+    float openingAngle = 0.5f;
+
+    // Number of threads computing the forces, including the thread stepping the simulation. 0 uses every core
+    unsigned int threads = 0;
+
+    // Skip the bodies and planets outside the view frustum (true) or draw all of them (false)
+    bool culling = true;
+
+    // Sort the draws of the direct submission by state and skip the binds already in effect (true), or bind and unbind everything
+    // around every draw (false)
+    bool stateSorting = true;
+
+    // Largest error of a level of detail on the screen, in pixels. 0 draws every mesh at full detail
+    float lodError = 1.0f;
+
+    // Step the simulation on its own thread (true) or in the render loop (false). Headless runs always use the render loop
+    bool simulationThread = true;
+
+    // Initial time warp of the simulation, in simulated seconds per real second
+    double timeWarp = 1.0;
+
+    // File receiving the seed and the inputs of every frame. Empty disables the recording
+    std::string recordFile;
+
+    // File of inputs recorded with 'recordFile', replayed instead of the keyboard and the clock. Empty disables the replay
+    std::string replayFile;
+
+    // Date shown by the ephemeris mode, "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM" in TT. The Sun, Earth and Moon are then placed by the
+    // ephemeris from this date instead of by the simulation. Empty uses the simulation
+    std::string date;
+
+    // Number of massless asteroids added to the scene's simulation, to load it
+    size_t asteroids = 0;
+
+    // Size of the cluster of the Barnes-Hut accuracy benchmark. Not 0 runs the benchmark instead of the renderer
+    size_t barnesHutAccuracyCount = 0;
+
+    // Number of nodes of the hierarchies of the scene graph benchmark. Not 0 runs the benchmark instead of the renderer
+    size_t sceneGraphBenchmarkCount = 0;
+
+    // Numbers of bodies placed by the batch transform benchmark. Not empty runs the benchmark instead of the renderer
+    std::vector<size_t> transformBenchmarkCounts;
+
+    // Number of dates computed at once by the ephemeris benchmark. Not 0 runs the benchmark instead of the renderer
+    size_t ephemerisBenchmarkCount = 0;
+
+    // Chrome trace-event file receiving the profiled scopes. Requires a build with SOLAR_SYSTEM_PROFILING
+    std::string profileTrace;
+
+};
+
+// Parses the command line arguments into an Options instance. Unknown arguments are reported and ignored
+Options parseOptions(int argc, char** argv);
+
+#endif
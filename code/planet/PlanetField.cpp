@@ -0,0 +1,318 @@
+#include "PlanetField.h"
+#include "../profiler/Profiler.h"
+#include "PlanetModel.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+
+// Constructor: Obtains the shared model, the program of the material and skins from the resource cache, and places the planets
+PlanetField::PlanetField(ResourceCache& resources, const std::string& modelPath, Material material, const std::vector<std::string>& texturePaths, unsigned int planetCount)
+    : resources(resources), material(material), VAO(0), instanceVBO(0) {
+
+    mesh = resources.acquireMesh(modelPath);
+
+    program = resources.acquireMaterial(material);
+
+    // Every skin is a layer of one texture array, shared by all the planets of the field
+    skins = resources.acquireTextureArray(texturePaths);
+
+    // Place the planets now, so that they take the same random numbers whenever the mesh is uploaded
+    setupInstances(planetCount);
+
+    if (isLoaded()) {
+        setupMesh();
+    }
+}
+
+// Whether the mesh and every skin are uploaded
+bool PlanetField::isLoaded() const {
+    return !mesh->pending && !skins->pending;
+}
+
+// Sets up the buffers, the samplers and the hierarchy, which need the mesh's buffers, dequantization and bounds
+void PlanetField::setupMesh() {
+
+    setupBuffers();
+
+    setupSamplers();
+
+    setupHierarchy();
+}
+
+// Sets up a VAO combining the shared VBO of the model with the per-instance VBO
+void PlanetField::setupBuffers() {
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(VAO);
+
+    // Per-vertex attributes, read from the shared mesh
+    ResourceCache::setupVertexAttributes(*mesh);
+
+    // Per-instance attributes, advanced once per planet instead of once per vertex
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Planet position and scale
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(PlanetInstance), (void*)offsetof(PlanetInstance, positionScale));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    // Planet skin layer
+    glVertexAttribIPointer(4, 1, GL_INT, sizeof(PlanetInstance), (void*)offsetof(PlanetInstance, skinLayer));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Room for every planet, so that uploading the visible ones never reallocates the buffer
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(PlanetInstance), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Check for OpenGL errors
+    GLenum err;
+    while ((err = glGetError()) != GL_NO_ERROR) {
+        std::cerr << "OpenGL error in setupBuffers: " << err << std::endl;
+    }
+
+}
+
+// Assigns texture unit 0 to the skins and sets the dequantization of the positions. The camera comes from the shared uniform buffer and the model matrix is replaced by per-instance data
+void PlanetField::setupSamplers() {
+
+    program->shader.use();
+
+    // Every skin is a layer of the texture array bound to texture unit 0
+    glUniform1i(program->shader.location(Uniform::PlanetSkins), 0);
+
+    // Every planet shares the mesh, so the dequantization of its positions is set once too
+    glUniform3fv(program->shader.location(Uniform::PositionOffset), 1, glm::value_ptr(mesh->positionOffset));
+    glUniform3fv(program->shader.location(Uniform::PositionScale), 1, glm::value_ptr(mesh->positionScale));
+
+}
+
+// Places the planets randomly. The instance buffer is filled by render()
+void PlanetField::setupInstances(unsigned int planetCount) {
+
+    instances.clear();
+    instances.reserve(planetCount);
+
+    for (unsigned int i = 0; i < planetCount; ++i) {
+
+        PlanetInstance instance;
+
+        // Pick a random skin, the same way PlanetModel does
+        instance.skinLayer = skins->layerCount == 0 ? 0 : static_cast<int>(rand() % skins->layerCount);
+
+        // Use the same random placement as PlanetModel::setupMatrices()
+        PlanetPlacement placement = PlanetModel::randomPlacement();
+        instance.positionScale = glm::vec4(placement.position, placement.scale);
+
+        instances.push_back(instance);
+    }
+
+    instanceLevels.assign(instances.size(), 0);
+    visible.reserve(instances.size());
+    drawOrder.reserve(instances.size());
+    drawnOrder.reserve(instances.size());
+    visibleInstances.reserve(instances.size());
+
+}
+
+// Builds the hierarchy over the planets' bounding spheres
+void PlanetField::setupHierarchy() {
+
+    spheres.clear();
+    spheres.reserve(instances.size());
+
+    for (const PlanetInstance& instance : instances) {
+
+        // The mesh's sphere, scaled and moved like the instance by the vertex shader
+        float scale = instance.positionScale.w;
+        BoundingSphere sphere;
+        sphere.center = glm::vec3(instance.positionScale) + mesh->bounds.center * scale;
+        sphere.radius = mesh->bounds.radius * scale;
+        spheres.push_back(sphere);
+    }
+
+    hierarchy.build(spheres);
+
+}
+
+// Places every planet with one call of the batch transform kernel, as PlanetModel::computeTransforms() does for the per-object planets
+void PlanetField::setupTransforms() {
+
+    TransformBatch batch;
+    batch.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const glm::vec4& positionScale = instances[i].positionScale;
+        batch.set(i, glm::vec3(positionScale), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(positionScale.w));
+    }
+
+    computeBatchTransforms(batch, transforms);
+}
+
+// Finds the planets inside the frustum and chooses their levels of detail, grouping them by level in 'drawOrder'
+bool PlanetField::selectVisible(const Frustum& frustum, const LevelOfDetailView& view, CullingCounters& counters) {
+
+    if (instances.empty()) {
+        return false;
+    }
+
+    // The field appears once its mesh and every skin are uploaded
+    if (!VAO) {
+        if (!isLoaded()) {
+            return false;
+        }
+        setupMesh();
+    }
+
+    // Find the visible planets
+    {
+        PROFILE_SCOPE("PlanetField culling");
+        visible.clear();
+        hierarchy.query(frustum, visible);
+    }
+    counters.visible += static_cast<unsigned int>(visible.size());
+    counters.culled += static_cast<unsigned int>(instances.size() - visible.size());
+
+    if (visible.empty()) {
+        drawnOrder.clear();
+        drawnLevelCounts.clear();
+        return false;
+    }
+
+    // Choose the level of every visible planet, and group the planets by level
+    levelCounts.assign(mesh->levels.size(), 0);
+    for (uint32_t planet : visible) {
+        instanceLevels[planet] = view.selectLevel(mesh->levels, spheres[planet], instanceLevels[planet]);
+        levelCounts[instanceLevels[planet]]++;
+        if (mesh->quantizationError > 0.0f) {
+            counters.addVertexError(mesh->quantizationError, view.projectedRadius(spheres[planet]));
+        }
+    }
+    drawOrder.resize(visible.size());
+    {
+        std::vector<uint32_t> next(levelCounts.size(), 0);
+        for (size_t level = 1; level < levelCounts.size(); ++level) {
+            next[level] = next[level - 1] + levelCounts[level - 1];
+        }
+        for (uint32_t planet : visible) {
+            drawOrder[next[instanceLevels[planet]]++] = planet;
+        }
+    }
+
+    return true;
+}
+
+// Draws the planets inside the frustum, with one instanced draw call per level of detail
+void PlanetField::render(const Frustum& frustum, const LevelOfDetailView& view, StateTracker& state, CullingCounters& counters) {
+
+    PROFILE_SCOPE("PlanetField::render");
+
+    if (!selectVisible(frustum, view, counters)) {
+        return;
+    }
+
+    // Upload the visible planets only when they or their levels changed, which is rare while the camera orbits slowly
+    if (drawOrder != drawnOrder || levelCounts != drawnLevelCounts) {
+        visibleInstances.clear();
+        for (uint32_t planet : drawOrder) {
+            visibleInstances.push_back(instances[planet]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, visibleInstances.size() * sizeof(PlanetInstance), visibleInstances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        drawnOrder.swap(drawOrder);
+        drawnLevelCounts.swap(levelCounts);
+    }
+
+    // Use the shader program. It has no per-draw uniforms: the camera comes from the shared uniform buffer
+    state.useProgram(program->shader.id());
+
+    // Bind every skin at once
+    state.bindTexture(GL_TEXTURE_2D_ARRAY, skins->texture);
+
+    // Bind the Vertex Array Object (VAO)
+    state.bindVertexArray(VAO);
+
+    // Draw the planets of each level at once. OpenGL 3.3 has no base instance, so the per-instance attributes are
+    // pointed at the level's first planet instead
+    {
+        PROFILE_SCOPE("PlanetField draw");
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        size_t firstInstance = 0;
+        for (size_t i = 0; i < drawnLevelCounts.size(); ++i) {
+            if (drawnLevelCounts[i] == 0) {
+                continue;
+            }
+            size_t instanceOffset = firstInstance * sizeof(PlanetInstance);
+            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(PlanetInstance), (void*)(instanceOffset + offsetof(PlanetInstance, positionScale)));
+            glVertexAttribIPointer(4, 1, GL_INT, sizeof(PlanetInstance), (void*)(instanceOffset + offsetof(PlanetInstance, skinLayer)));
+
+            const MeshLevel& level = mesh->levels[i];
+            glDrawElementsInstanced(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)(level.firstIndex * sizeof(unsigned int)), static_cast<GLsizei>(drawnLevelCounts[i]));
+            counters.triangles += static_cast<unsigned long>(drawnLevelCounts[i]) * (level.indexCount / 3);
+            counters.drawCalls++;
+            firstInstance += drawnLevelCounts[i];
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // The program, the skins and the VAO stay bound in 'state', to be unbound by its owner
+}
+
+// Queues the planets inside the frustum for the indirect renderer, which draws the planets of each level with one instanced command
+void PlanetField::queueDraws(const Frustum& frustum, const LevelOfDetailView& view, CullingCounters& counters, IndirectRenderer& renderer) {
+
+    PROFILE_SCOPE("PlanetField::queueDraws");
+
+    if (!selectVisible(frustum, view, counters)) {
+        return;
+    }
+
+    // The planets never move, so their matrices are computed on the first frame and reused
+    if (transforms.size() != instances.size()) {
+        setupTransforms();
+    }
+    if (!hasInstanceGroup) {
+        instanceGroup = renderer.createInstanceGroup();
+        hasInstanceGroup = true;
+    }
+
+    // Rewrite the group's instances only when the visible planets or their levels changed, as render() does with the instance buffer
+    if (drawOrder != queuedOrder || levelCounts != queuedLevelCounts) {
+        queuedInstances.clear();
+        for (uint32_t planet : drawOrder) {
+            queuedInstances.push_back({ transforms[planet], instances[planet].skinLayer });
+        }
+        renderer.setInstances(instanceGroup, *mesh, queuedInstances);
+        queuedOrder.swap(drawOrder);
+        queuedLevelCounts.swap(levelCounts);
+    }
+
+    renderer.drawInstances(instanceGroup, *mesh, material, *skins, queuedLevelCounts);
+    for (size_t i = 0; i < queuedLevelCounts.size(); ++i) {
+        counters.triangles += static_cast<unsigned long>(queuedLevelCounts[i]) * (mesh->levels[i].indexCount / 3);
+    }
+}
+
+// Destructor: Clean up resources
+PlanetField::~PlanetField() {
+
+    // Delete the VAO and the instance VBO, which belong to the field
+    if (VAO)
+        glDeleteVertexArrays(1, &VAO);
+
+    if (instanceVBO)
+        glDeleteBuffers(1, &instanceVBO);
+
+    // Release the shared mesh, skins and shader program
+    resources.release(program);
+    resources.release(skins);
+    resources.release(mesh);
+
+}
@@ -0,0 +1,130 @@
+#ifndef PLANET_FIELD_H
+#define PLANET_FIELD_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include "../resources/ResourceCache.h"
+#include "../culling/BoundingVolumeHierarchy.h"
+#include "../mesh/LevelOfDetail.h"
+#include "../render/IndirectRenderer.h"
+#include "../scene/BatchTransform.h"
+#include "../render/StateTracker.h"
+
+// Draws every random planet and star with a single instanced draw call, sharing one mesh and one texture array holding every skin.
+// The planets never move, so they are culled through a bounding volume hierarchy built once, and only the visible ones are drawn,
+// with one draw call per level of detail
+class PlanetField {
+
+public:
+
+    // Constructor: Obtains the shared model, the program of the material and the texture array of the skins from the resource cache, and places 'planetCount'
+    // planets randomly. Nothing is drawn until the mesh and the skins are uploaded
+    PlanetField(ResourceCache& resources, const std::string& modelPath, Material material, const std::vector<std::string>& texturePaths, unsigned int planetCount);
+
+    // The field owns its VAO and instance buffer, so it cannot be copied
+    PlanetField(const PlanetField&) = delete;
+    PlanetField& operator=(const PlanetField&) = delete;
+
+    // Renders the planets of the field inside the frustum at the level of detail their size on the screen needs, with the camera
+    // of the shared camera uniform buffer, and counts the visible and culled planets and the triangles drawn. Binds through 'state',
+    // so that nothing is bound twice after the render queue, and leaves its bindings in effect
+    void render(const Frustum& frustum, const LevelOfDetailView& view, StateTracker& state, CullingCounters& counters);
+
+    // Queues the same planets as render() would draw, to be drawn by the renderer's next submit() with one instanced command per level
+    // of detail, and counts them alike. Their draw data stays in an instance group of the renderer, rewritten only when they change
+    void queueDraws(const Frustum& frustum, const LevelOfDetailView& view, CullingCounters& counters, IndirectRenderer& renderer);
+
+    // Destructor: Cleans up resources
+    ~PlanetField();
+
+private:
+
+    // Per-instance data uploaded to the GPU, one entry per planet
+    struct PlanetInstance {
+
+        // Position of the planet (x, y, z) and its uniform scale (w)
+        glm::vec4 positionScale;
+
+        // Layer of the planet's skin in 'skins'
+        int skinLayer;
+
+    };
+
+    // Stores the per-instance data of every planet
+    std::vector<PlanetInstance> instances;
+
+    // Model and normal matrices of every planet, for the indirect renderer. The planets never move, so they are computed once by
+    // setupTransforms(), the first time the field is queued, and stay empty on the instanced path, which reads 'instances' instead
+    std::vector<BodyTransform> transforms;
+
+    // World-space bounding spheres of the planets, and the hierarchy over them
+    std::vector<BoundingSphere> spheres;
+    BoundingVolumeHierarchy hierarchy;
+
+    // Level of detail of every planet, kept between frames for hysteresis
+    std::vector<unsigned int> instanceLevels;
+
+    // Planets found visible by the current frame
+    std::vector<uint32_t> visible;
+
+    // Visible planets ordered by level of detail, with the number of planets of each level, for the current frame and
+    // for the planets whose data is in the instance buffer
+    std::vector<uint32_t> drawOrder, drawnOrder;
+    std::vector<uint32_t> levelCounts, drawnLevelCounts;
+
+    // Per-instance data of the visible planets, in the order of 'drawOrder'
+    std::vector<PlanetInstance> visibleInstances;
+
+    // Instance group of the indirect renderer holding the visible planets, created on the first queueDraws(), with the planets in it
+    // ordered by level of detail and the number of planets of each level, and their instances in that order
+    uint32_t instanceGroup = 0;
+    bool hasInstanceGroup = false;
+    std::vector<uint32_t> queuedOrder, queuedLevelCounts;
+    std::vector<IndirectRenderer::Instance> queuedInstances;
+
+    // Cache that owns the shared mesh, skins and shader program
+    ResourceCache& resources;
+
+    // Mesh shared by all the planets
+    const MeshResource* mesh;
+
+    // Texture array of the planet skins, indexed by PlanetInstance::skinLayer
+    const TextureResource* skins;
+
+    // Material of the planets, and its program, shared by all the planets
+    Material material;
+    const ProgramResource* program;
+
+    // OpenGL identifiers for the field's own Vertex Array Object and the instance buffer
+    unsigned int VAO, instanceVBO;
+
+    // Whether the mesh and every skin are uploaded, as the asset loader may still be decoding them
+    bool isLoaded() const;
+
+    // Finds the visible planets, chooses their levels and fills 'drawOrder' and 'levelCounts'. Returns false if there is nothing to draw
+    bool selectVisible(const Frustum& frustum, const LevelOfDetailView& view, CullingCounters& counters);
+
+    // Sets up what needs the uploaded mesh: the buffers, the samplers and the hierarchy. Called once the field is loaded
+    void setupMesh();
+
+    // Binds the texture array to its texture unit
+    void setupSamplers();
+
+    // Places the planets randomly
+    void setupInstances(unsigned int planetCount);
+
+    // Builds the hierarchy over the planets' bounding spheres, which are the mesh's sphere moved like each planet
+    void setupHierarchy();
+
+    // Computes the model and normal matrices of every planet with one call of the batch transform kernel
+    void setupTransforms();
+
+    // Sets up the VAO with the shared vertex attributes and the per-instance attributes, and the room of the instance buffer
+    void setupBuffers();
+
+};
+
+#endif
@@ -3,60 +3,96 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <assimp/scene.h>
 #include <glm/glm.hpp>
+#include <memory>
 #include <string>
 #include <vector>
+#include "../resources/ResourceCache.h"
+#include "../scene/BatchTransform.h"
+#include "../mesh/LevelOfDetail.h"
+#include "../render/IndirectRenderer.h"
+#include "../render/RenderQueue.h"
 
+// Random position and size of a planet or star around the solar system
+struct PlanetPlacement {
+
+    // Position of the planet's center in world coordinates
+    glm::vec3 position;
+
+    // Uniform scale factor applied to the planet's model
+    float scale;
+
+};
 
 class PlanetModel {
 
 public:
 
-    // Constructor: Initializes a new instance of SunModel with paths for model, shaders, and texture
-    PlanetModel(const std::string& modelPath, const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::vector<std::string>& texturePaths);
+    // Constructor: Initializes a new instance of PlanetModel with paths for model and skins, and its material, loaded through the resource cache.
+    // The skins are the layers of one texture array, shared with every planet using the same skins, of which the planet picks one.
+    // The planet picks a random placement, and is placed by computeTransforms() before it is drawn
+    PlanetModel(ResourceCache& resources, const std::string& modelPath, Material material, const std::vector<std::string>& texturePaths);
 
-    
+    // Models hold references to shared resources, so they cannot be copied
+    PlanetModel(const PlanetModel&) = delete;
+    PlanetModel& operator=(const PlanetModel&) = delete;
 
-    // Renders the planet model
-    void render(const glm::mat4& viewMatrix);
+    // Sphere enclosing the planet in world coordinates, for culling
+    BoundingSphere worldBounds() const;
 
-    ~PlanetModel();
+    // Chooses the level of detail drawn by render(), from the model's bounding sphere in world coordinates
+    void selectLevel(const LevelOfDetailView& view, const BoundingSphere& worldBounds);
 
-private:
+    // Number of triangles drawn by render()
+    unsigned int triangleCount() const;
+
+    // Largest error of the mesh's quantized positions, as a fraction of its bounding radius. 0 for meshes of floats
+    float quantizationError() const;
 
-    // Stores the vertex data of the model
-    std::vector<float> vertices;
+    // Whether the mesh and the texture are uploaded. Models requested while the asset loader runs are drawn only once they are
+    bool isLoaded() const;
 
-    // OpenGL identifiers for Vertex Array Object and Vertex Buffer Object
-    unsigned int VAO, VBO;
+    // Submits the planet model with its skin to the render queue. Planets sharing the program, the skins and the mesh are drawn one after
+    // the other by the queue's execute(), with the camera of the shared camera uniform buffer, binding them once
+    void render(RenderQueue& queue) const;
 
-    // Number of vertices, set during processMesh() and used in render()
-    unsigned int vertexCount;
+    // Queues the selected level of detail with this planet's skin, to be drawn by the renderer's next submit()
+    void queueDraw(IndirectRenderer& renderer) const;
+
+    // Computes the model and normal matrices of the planets from their placements, all at once with computeBatchTransforms()
+    static void computeTransforms(const std::vector<std::unique_ptr<PlanetModel>>& planets);
+
+    // Generates a random placement for a planet. Shared by PlanetModel and PlanetField
+    static PlanetPlacement randomPlacement();
+
+    ~PlanetModel();
+
+private:
 
-    // OpenGL identifier for the texture
-    unsigned int texture;
+    // Cache that owns the shared mesh, texture and shader program
+    ResourceCache& resources;
 
-    // Identifier for the compiled and linked shader program
-    unsigned int shaderProgram;
+    // Mesh of the model, shared with every model loaded from the same file
+    const MeshResource* mesh;
 
-    // Loads the model from a given file path
-    void loadModel(const std::string& path);
+    // Texture array of the skins, shared with every model using the same images
+    const TextureResource* skins;
 
-    // Compiles and links the vertex and fragment shaders
-    void compileShaders(const std::string& vertexPath, const std::string& fragmentPath);
+    // Layer of the planet's skin in 'skins'
+    int skinLayer = 0;
 
-    // Loads a texture from a given file path
-    void loadTexture(const std::string& texturePath);
+    // Material of the model, and its program, shared with every model of the same material
+    Material material;
+    const ProgramResource* program;
 
-    // Sets up the transformation matrices for the model
-    void setupMatrices();
+    // Level of detail of the mesh drawn by render(), kept between frames for hysteresis
+    unsigned int level = 0;
 
-    // Processes an individual mesh of the model
-    void processMesh(aiMesh* mesh, const aiScene* scene);
+    // Random position and size of the planet
+    PlanetPlacement placement;
 
-    // Sets up the vertex buffers and attributes
-    void setupBuffers();
+    // Model and normal matrices, set once by computeTransforms() and uploaded by the render queue or the indirect renderer
+    BodyTransform transform;
 
 };
 
@@ -0,0 +1,260 @@
+#include "Profiler.h"
+
+#ifdef SOLAR_SYSTEM_PROFILING
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Number of frames whose GPU times can be in flight at once
+const unsigned int frameRingSize = 4;
+
+// Number of measurements kept per scope for the rolling percentiles
+const unsigned int windowSize = 256;
+
+// Upper bound of the events kept for the trace file, about 40 MB
+const size_t maxTraceEvents = 1 << 20;
+
+// The last 'windowSize' measurements of a value, in milliseconds
+struct RollingWindow {
+
+    std::vector<double> samples;
+    size_t next = 0;
+
+    void add(double value) {
+        if (samples.size() < windowSize) {
+            samples.push_back(value);
+        }
+        else {
+            samples[next] = value;
+        }
+        next = (next + 1) % windowSize;
+    }
+
+    // Returns the given percentile of the samples, or -1 if there are none
+    double percentile(unsigned int percent) const {
+        if (samples.empty()) {
+            return -1.0;
+        }
+        std::vector<double> sorted = samples;
+        size_t index = std::min(sorted.size() - 1, sorted.size() * percent / 100);
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+};
+
+// Rolling measurements of a named scope
+struct Stage {
+    const char* name;
+    RollingWindow cpu;
+    RollingWindow gpu;
+};
+
+// A scope whose GPU timestamps have not been read yet
+struct PendingScope {
+    Stage* stage;
+    double cpuStart;
+    double cpuEnd;
+};
+
+// The scopes of one frame, with a pair of timestamp queries per scope
+struct QueryPool {
+    std::vector<GLuint> queries;
+    std::vector<PendingScope> scopes;
+};
+
+// A measured interval on the CPU or GPU timeline, in microseconds since the profiler started
+struct TraceEvent {
+    const char* name;
+    bool gpu;
+    double start;
+    double duration;
+};
+
+struct ProfilerState {
+
+    bool initialized = false;
+
+    // Origins of the CPU and GPU clocks, taken at the same moment so that both timelines line up in the trace
+    std::chrono::steady_clock::time_point cpuOrigin;
+    GLint64 gpuOrigin = 0;
+
+    unsigned long frame = 0;
+    QueryPool pools[frameRingSize];
+
+    // Stages in the order in which they were first measured, looked up by the address of their name literal
+    std::deque<Stage> stages;
+    std::unordered_map<const char*, Stage*> stagesByName;
+
+    std::vector<TraceEvent> events;
+};
+
+ProfilerState state;
+
+// Microseconds since the profiler started
+double cpuNow() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - state.cpuOrigin).count();
+}
+
+void initialize() {
+    if (state.initialized) {
+        return;
+    }
+    state.initialized = true;
+    state.cpuOrigin = std::chrono::steady_clock::now();
+    glGetInteger64v(GL_TIMESTAMP, &state.gpuOrigin);
+}
+
+void addEvent(const char* name, bool gpu, double start, double end) {
+    if (state.events.size() < maxTraceEvents) {
+        state.events.push_back({ name, gpu, start, end - start });
+    }
+}
+
+Stage* findStage(const char* name) {
+    std::unordered_map<const char*, Stage*>::iterator found = state.stagesByName.find(name);
+    if (found != state.stagesByName.end()) {
+        return found->second;
+    }
+    state.stages.push_back(Stage());
+    Stage* stage = &state.stages.back();
+    stage->name = name;
+    state.stagesByName[name] = stage;
+    return stage;
+}
+
+// Reads the GPU timestamps of every scope of a pool, then empties it
+void collect(QueryPool& pool) {
+    for (size_t i = 0; i < pool.scopes.size(); ++i) {
+        GLuint64 gpuStart = 0, gpuEnd = 0;
+        glGetQueryObjectui64v(pool.queries[2 * i], GL_QUERY_RESULT, &gpuStart);
+        glGetQueryObjectui64v(pool.queries[2 * i + 1], GL_QUERY_RESULT, &gpuEnd);
+
+        double start = (static_cast<double>(gpuStart) - static_cast<double>(state.gpuOrigin)) / 1000.0;
+        double end = (static_cast<double>(gpuEnd) - static_cast<double>(state.gpuOrigin)) / 1000.0;
+        pool.scopes[i].stage->gpu.add((end - start) / 1000.0);
+        addEvent(pool.scopes[i].stage->name, true, start, end);
+    }
+    pool.scopes.clear();
+}
+
+// Writes a string as a JSON string literal
+void writeJsonString(std::ostream& stream, const char* text) {
+    stream << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            stream << '\\';
+        }
+        stream << *c;
+    }
+    stream << '"';
+}
+
+}
+
+// Starts a frame
+void Profiler::beginFrame() {
+
+    initialize();
+
+    // The pool of this frame was last used 'frameRingSize' frames ago, so its results are normally ready
+    ++state.frame;
+    collect(state.pools[state.frame % frameRingSize]);
+
+    beginScope("Frame");
+}
+
+// Ends the current frame
+void Profiler::endFrame() {
+    endScope(0);
+}
+
+// Opens a scope and writes its starting GPU timestamp
+unsigned int Profiler::beginScope(const char* name) {
+
+    initialize();
+
+    QueryPool& pool = state.pools[state.frame % frameRingSize];
+    unsigned int scope = static_cast<unsigned int>(pool.scopes.size());
+
+    // Grow the pool by a few pairs of queries when a frame has more scopes than before
+    if (pool.queries.size() < 2 * (scope + 1)) {
+        size_t oldSize = pool.queries.size();
+        pool.queries.resize(oldSize + 16);
+        glGenQueries(16, &pool.queries[oldSize]);
+    }
+
+    pool.scopes.push_back({ findStage(name), cpuNow(), 0.0 });
+    glQueryCounter(pool.queries[2 * scope], GL_TIMESTAMP);
+    return scope;
+}
+
+// Closes a scope and writes its ending GPU timestamp
+void Profiler::endScope(unsigned int scope) {
+
+    QueryPool& pool = state.pools[state.frame % frameRingSize];
+    glQueryCounter(pool.queries[2 * scope + 1], GL_TIMESTAMP);
+
+    PendingScope& pending = pool.scopes[scope];
+    pending.cpuEnd = cpuNow();
+    pending.stage->cpu.add((pending.cpuEnd - pending.cpuStart) / 1000.0);
+    addEvent(pending.stage->name, false, pending.cpuStart, pending.cpuEnd);
+}
+
+// Waits for the GPU times of the frames still in flight
+void Profiler::finish() {
+    for (unsigned int i = 1; i <= frameRingSize; ++i) {
+        collect(state.pools[(state.frame + i) % frameRingSize]);
+    }
+}
+
+// Prints the rolling percentiles of every scope
+void Profiler::printReport(std::ostream& stream) {
+
+    stream << "Profile of the last " << std::min<unsigned long>(state.frame, windowSize) << " frames (ms, p50 / p95 / p99):" << std::endl;
+    stream << std::fixed << std::setprecision(3);
+    for (const Stage& stage : state.stages) {
+        stream << "  " << std::left << std::setw(28) << stage.name << std::right
+               << " CPU " << stage.cpu.percentile(50) << " / " << stage.cpu.percentile(95) << " / " << stage.cpu.percentile(99)
+               << "   GPU " << stage.gpu.percentile(50) << " / " << stage.gpu.percentile(95) << " / " << stage.gpu.percentile(99) << std::endl;
+    }
+    stream << std::defaultfloat;
+}
+
+// Writes every measurement as a Chrome trace-event JSON file
+bool Profiler::writeTrace(const std::string& path) {
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::PROFILER::TRACE_NOT_WRITABLE: " << path << std::endl;
+        return false;
+    }
+
+    // Complete ("X") events on two threads of one process, one for the CPU and one for the GPU timeline
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}}," << std::endl;
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    for (const TraceEvent& event : state.events) {
+        file << "," << std::endl << "{\"name\":";
+        writeJsonString(file, event.name);
+        file << ",\"cat\":\"" << (event.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+             << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+    }
+    file << std::endl << "]}" << std::endl;
+
+    if (state.events.size() == maxTraceEvents) {
+        std::cerr << "ERROR::PROFILER::TRACE_TRUNCATED: only the first " << maxTraceEvents << " events were kept" << std::endl;
+    }
+    return static_cast<bool>(file);
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// The profiler is compiled in only when SOLAR_SYSTEM_PROFILING is defined (e.g. with -DSOLAR_SYSTEM_PROFILING).
+// Otherwise the PROFILE_* macros expand to nothing, so the profiled code pays no cost at all
+#ifdef SOLAR_SYSTEM_PROFILING
+
+#include <ostream>
+#include <string>
+
+// Measures the CPU and GPU time of named scopes of every frame. GPU times are measured by pairs of timestamp queries,
+// read a few frames later through a ring of query pools so that the pipeline never stalls. Keeps the last
+// measurements of every scope for rolling percentiles, and every measurement for a Chrome trace-event file
+class Profiler {
+
+public:
+
+    // Starts a frame, and reads the GPU times of the frame issued 'frameRingSize' frames ago
+    static void beginFrame();
+
+    // Ends the current frame
+    static void endFrame();
+
+    // Opens a scope named by a string literal. Returns the handle passed to endScope()
+    static unsigned int beginScope(const char* name);
+
+    // Closes the scope opened by beginScope()
+    static void endScope(unsigned int scope);
+
+    // Waits for the GPU times of the frames still in flight
+    static void finish();
+
+    // Prints the median, 95th and 99th percentile of the CPU and GPU time of every scope over the last frames
+    static void printReport(std::ostream& stream);
+
+    // Writes every measurement as a Chrome trace-event JSON file, viewable in chrome://tracing or Perfetto
+    static bool writeTrace(const std::string& path);
+
+};
+
+// Measures the scope in which it is declared
+class ProfileScope {
+
+public:
+
+    explicit ProfileScope(const char* name) : scope(Profiler::beginScope(name)) {}
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    ~ProfileScope() { Profiler::endScope(scope); }
+
+private:
+
+    unsigned int scope;
+
+};
+
+#define PROFILE_CONCATENATE_LINE(prefix, line) prefix##line
+#define PROFILE_SCOPE_VARIABLE(prefix, line) PROFILE_CONCATENATE_LINE(prefix, line)
+
+// Measures the rest of the enclosing block under the given name, which must be a string literal
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_VARIABLE(profileScope, __LINE__)(name)
+#define PROFILE_BEGIN_FRAME() Profiler::beginFrame()
+#define PROFILE_END_FRAME() Profiler::endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+
+#endif
+
+#endif
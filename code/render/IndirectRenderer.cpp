@@ -0,0 +1,474 @@
+#include "IndirectRenderer.h"
+#include "../profiler/Profiler.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// Location of the per-instance draw index in the vertex shader
+const GLuint drawIndexLocation = 5;
+
+// Binding point of the draw data in the vertex shader
+const GLuint drawDataBinding = 0;
+
+// Whether two vertex layouts describe the same vertices
+bool isSameLayout(const VertexLayout& a, const VertexLayout& b) {
+
+    if (a.stride != b.stride || a.attributeCount != b.attributeCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a.attributeCount; ++i) {
+        const VertexAttribute& x = a.attributes[i];
+        const VertexAttribute& y = b.attributes[i];
+        if (x.location != y.location || x.components != y.components || x.type != y.type || x.normalized != y.normalized || x.offset != y.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+// Multi-draw indirect and shader storage buffers are core in OpenGL 4.3
+bool IndirectRenderer::isSupported() {
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
+// Constructor: Obtains the programs of the indirect materials and assigns the texture units of their samplers
+IndirectRenderer::IndirectRenderer(ResourceCache& resources)
+    : resources(resources) {
+
+    // 2D texture i is bound to texture unit i, and the texture array to the unit after them
+    int textureUnits[maxTextures];
+    std::iota(textureUnits, textureUnits + maxTextures, 0);
+    for (int i = 0; i < static_cast<int>(Material::Count); ++i) {
+        if (!(materialPermutations[i].features & materialIndirect)) {
+            continue;
+        }
+        const ProgramResource* program = resources.acquireMaterial(static_cast<Material>(i));
+        programs[i] = program;
+        program->shader.use();
+        glUniform1iv(program->shader.location(Uniform::BodyTextures), maxTextures, textureUnits);
+        glUniform1i(program->shader.location(Uniform::PlanetSkins), static_cast<int>(maxTextures));
+    }
+    glUseProgram(0);
+
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &drawDataBuffer);
+    glGenBuffers(1, &drawIndexBuffer);
+}
+
+// Queues a draw, copying its mesh into the shared buffers if it is drawn for the first time
+void IndirectRenderer::draw(const MeshResource& mesh, unsigned int level, Material material, const TextureResource& texture, int layer, const BodyTransform& transform) {
+
+    static_assert(sizeof(BodyTransform) == 112 && sizeof(DrawData) == 160, "DrawData must match the std430 layout of the draw data block");
+
+    const MeshSlot& slot = meshSlot(mesh);
+    const MeshLevel& drawnLevel = mesh.levels[level];
+
+    QueuedDraw draw;
+    draw.command.count = drawnLevel.indexCount;
+    draw.command.instanceCount = 1;
+    draw.command.firstIndex = slot.firstIndex + drawnLevel.firstIndex;
+    draw.command.baseVertex = slot.baseVertex;
+    draw.command.baseInstance = 0;
+
+    // The first index identifies the level within its buffer, so draws of equal keys can share a command
+    draw.key = (static_cast<uint64_t>(materialPermutation(material).indirect) << 48) | (static_cast<uint64_t>(slot.buffer) << 32) | draw.command.firstIndex;
+
+    draw.data.transform = transform;
+    draw.data.positionOffset = glm::vec4(mesh.positionOffset, 0.0f);
+    draw.data.positionScale = glm::vec4(mesh.positionScale, 0.0f);
+    draw.data.layer = layer;
+    draw.data.padding[0] = draw.data.padding[1] = 0;
+
+    draw.data.textureSlot = acquireTextureSlot(texture);
+
+    queued.push_back(draw);
+}
+
+// Creates an instance group with an empty storage buffer
+uint32_t IndirectRenderer::createInstanceGroup() {
+
+    groups.emplace_back();
+    glGenBuffers(1, &groups.back().buffer);
+    return static_cast<uint32_t>(groups.size() - 1);
+}
+
+// Fills the draw data of a group's instances, with the texture slot of their last draw
+void IndirectRenderer::setInstances(uint32_t group, const MeshResource& mesh, const std::vector<Instance>& instances) {
+
+    InstanceGroup& instanceGroup = groups[group];
+    instanceGroup.data.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        DrawData& data = instanceGroup.data[i];
+        data.transform = instances[i].transform;
+        data.positionOffset = glm::vec4(mesh.positionOffset, 0.0f);
+        data.positionScale = glm::vec4(mesh.positionScale, 0.0f);
+        data.textureSlot = instanceGroup.textureSlot;
+        data.layer = instances[i].layer;
+        data.padding[0] = data.padding[1] = 0;
+    }
+    instanceGroup.isDirty = true;
+}
+
+// Queues one command per level of a group's instances, uploading their draw data first if it changed
+void IndirectRenderer::drawInstances(uint32_t group, const MeshResource& mesh, Material material, const TextureResource& texture, const std::vector<uint32_t>& levelCounts) {
+
+    InstanceGroup& instanceGroup = groups[group];
+    if (instanceGroup.data.empty()) {
+        return;
+    }
+
+    const MeshSlot& slot = meshSlot(mesh);
+
+    // The slot is stored in the draw data, so the data is only rewritten in the rare frames where the texture got another unit
+    int32_t unit = acquireTextureSlot(texture);
+    if (unit != instanceGroup.textureSlot) {
+        for (DrawData& data : instanceGroup.data) {
+            data.textureSlot = unit;
+        }
+        instanceGroup.textureSlot = unit;
+        instanceGroup.isDirty = true;
+    }
+    if (instanceGroup.isDirty) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceGroup.buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, instanceGroup.data.size() * sizeof(DrawData), instanceGroup.data.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        instanceGroup.isDirty = false;
+    }
+
+    // Instance i of a level's command reads the draw data at the level's first instance plus i
+    Batch batch = { materialPermutation(material).indirect, slot.buffer, instanceGroup.buffer, groupCommands.size(), 0 };
+    uint32_t firstInstance = 0;
+    for (size_t level = 0; level < levelCounts.size(); ++level) {
+        if (levelCounts[level] == 0) {
+            continue;
+        }
+        const MeshLevel& drawnLevel = mesh.levels[level];
+        DrawCommand command;
+        command.count = drawnLevel.indexCount;
+        command.instanceCount = levelCounts[level];
+        command.firstIndex = slot.firstIndex + drawnLevel.firstIndex;
+        command.baseVertex = slot.baseVertex;
+        command.baseInstance = firstInstance;
+        groupCommands.push_back(command);
+        batch.commandCount++;
+        firstInstance += levelCounts[level];
+    }
+    if (batch.commandCount > 0) {
+        groupBatches.push_back(batch);
+    }
+    groupInstanceCount = std::max<size_t>(groupInstanceCount, firstInstance);
+}
+
+// Draws what is still queued, and counts the calls and binds of the submissions made early by draw() as well
+void IndirectRenderer::submit(CullingCounters& counters) {
+
+    PROFILE_SCOPE("IndirectRenderer::submit");
+
+    flush(counters);
+    counters.drawCalls += flushedCounters.drawCalls;
+    counters.stateChanges += flushedCounters.stateChanges;
+    flushedCounters = CullingCounters();
+}
+
+// Sorts the queued draws by material, buffer and mesh level, merges the draws of the same level into one instanced command, and draws
+// each run of commands of the same material and buffer with one call, followed by the commands of the queued instance groups
+void IndirectRenderer::flush(CullingCounters& counters) {
+
+    if (queued.empty() && groupCommands.empty()) {
+        frameTextures.clear();
+        frameTextureArray = nullptr;
+        return;
+    }
+
+    order.clear();
+    for (size_t i = 0; i < queued.size(); ++i) {
+        order.emplace_back(queued[i].key, static_cast<uint32_t>(i));
+    }
+    std::sort(order.begin(), order.end());
+
+    // The draw data is stored in the order of the commands, so that instance i of a command reads the data at its base instance plus i
+    sortedData.clear();
+    commands.clear();
+    batches.clear();
+    for (size_t i = 0; i < order.size(); ++i) {
+        const QueuedDraw& draw = queued[order[i].second];
+        sortedData.push_back(draw.data);
+
+        if (i > 0 && order[i].first == order[i - 1].first) {
+            commands.back().instanceCount++;
+            continue;
+        }
+
+        DrawCommand command = draw.command;
+        command.baseInstance = static_cast<uint32_t>(sortedData.size() - 1);
+        commands.push_back(command);
+
+        Material material = static_cast<Material>(draw.key >> 48);
+        uint32_t buffer = static_cast<uint32_t>((draw.key >> 32) & 0xFFFF);
+        if (batches.empty() || batches.back().material != material || batches.back().buffer != buffer) {
+            batches.push_back({ material, buffer, drawDataBuffer, commands.size() - 1, 0 });
+        }
+        batches.back().commandCount++;
+    }
+
+    // The instance groups' commands follow, each call reading the draw data of its group's buffer
+    size_t groupCommandStart = commands.size();
+    commands.insert(commands.end(), groupCommands.begin(), groupCommands.end());
+    for (Batch batch : groupBatches) {
+        batch.firstCommand += groupCommandStart;
+        batches.push_back(batch);
+    }
+
+    reserveDrawIndices(std::max(sortedData.size(), groupInstanceCount));
+
+    // Refill the buffers, letting the driver give them new storage if the previous frame still reads them
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawDataBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sortedData.size() * sizeof(DrawData), sortedData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, drawDataBuffer);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STREAM_DRAW);
+
+    // Bind the textures of the frame once for every call
+    for (size_t i = 0; i < frameTextures.size(); ++i) {
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        glBindTexture(GL_TEXTURE_2D, frameTextures[i]->texture);
+    }
+    glActiveTexture(GL_TEXTURE0 + maxTextures);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, frameTextureArray ? frameTextureArray->texture : 0);
+    counters.stateChanges += static_cast<unsigned int>(frameTextures.size()) + 1;
+
+    // The batches are sorted by material, so each program is made current once. The draw data of the frame is bound above, and an
+    // instance group's is bound before its call
+    const ProgramResource* currentProgram = nullptr;
+    unsigned int currentDataBuffer = drawDataBuffer;
+    for (const Batch& batch : batches) {
+        const ProgramResource* program = programs[static_cast<int>(batch.material)];
+        if (program != currentProgram) {
+            program->shader.use();
+            currentProgram = program;
+            counters.stateChanges++;
+        }
+        if (batch.dataBuffer != currentDataBuffer) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, batch.dataBuffer);
+            currentDataBuffer = batch.dataBuffer;
+            counters.stateChanges++;
+        }
+        glBindVertexArray(geometry[batch.buffer].VAO);
+        counters.stateChanges++;
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(uintptr_t)(batch.firstCommand * sizeof(DrawCommand)), static_cast<GLsizei>(batch.commandCount), 0);
+        counters.drawCalls++;
+    }
+
+    // Unbind everything, leaving texture unit 0 active for the other models
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    for (size_t i = 0; i < frameTextures.size(); ++i) {
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    counters.stateChanges += static_cast<unsigned int>(frameTextures.size()) + 3;
+
+    queued.clear();
+    groupCommands.clear();
+    groupBatches.clear();
+    groupInstanceCount = 0;
+    frameTextures.clear();
+    frameTextureArray = nullptr;
+}
+
+// Returns where the mesh was copied, copying it on its first draw. The meshes of a path never change once uploaded, so the copy stays valid
+// even if the mesh is released and acquired again, at the same address or another
+const IndirectRenderer::MeshSlot& IndirectRenderer::meshSlot(const MeshResource& mesh) {
+
+    auto it = meshSlots.find(mesh.path);
+    if (it != meshSlots.end()) {
+        return it->second;
+    }
+
+    // Sizes of the mesh's buffers
+    GLint vertexBytes = 0, indexBytes = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, mesh.VBO);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &vertexBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, mesh.EBO);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &indexBytes);
+
+    // Meshes of the same layout share a buffer
+    size_t bufferIndex = 0;
+    while (bufferIndex < geometry.size() && !isSameLayout(geometry[bufferIndex].layout, mesh.layout)) {
+        ++bufferIndex;
+    }
+    if (bufferIndex == geometry.size()) {
+        geometry.emplace_back();
+        geometry.back().layout = mesh.layout;
+    }
+    GeometryBuffer& buffer = geometry[bufferIndex];
+
+    // Grow the buffers if needed, then append the mesh's vertices and indices
+    bool isReallocated = reserve(buffer.VBO, buffer.vertexBytes, buffer.vertexCapacity, buffer.vertexBytes + vertexBytes);
+    isReallocated = reserve(buffer.EBO, buffer.indexBytes, buffer.indexCapacity, buffer.indexBytes + indexBytes) || isReallocated;
+    if (isReallocated || !buffer.VAO) {
+        setupVertexArray(buffer);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, mesh.VBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.VBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, static_cast<GLintptr>(buffer.vertexBytes), vertexBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, mesh.EBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.EBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, static_cast<GLintptr>(buffer.indexBytes), indexBytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    MeshSlot slot;
+    slot.buffer = static_cast<uint32_t>(bufferIndex);
+    slot.baseVertex = static_cast<int32_t>(buffer.vertexBytes / buffer.layout.stride);
+    slot.firstIndex = static_cast<uint32_t>(buffer.indexBytes / sizeof(unsigned int));
+    buffer.vertexBytes += static_cast<size_t>(vertexBytes);
+    buffer.indexBytes += static_cast<size_t>(indexBytes);
+
+    std::cout << "IndirectRenderer: copied mesh " << mesh.path << " into buffer " << bufferIndex << " (" << buffer.vertexBytes << " bytes of vertices, "
+              << buffer.indexBytes << " bytes of indices)" << std::endl;
+
+    return meshSlots.emplace(mesh.path, slot).first->second;
+}
+
+// Texture slot of a texture for the current frame
+int32_t IndirectRenderer::textureSlot(const TextureResource& texture) {
+
+    // A single texture array is bound after the 2D textures
+    if (texture.target == GL_TEXTURE_2D_ARRAY) {
+        if (frameTextureArray && frameTextureArray != &texture) {
+            return -1;
+        }
+        frameTextureArray = &texture;
+        return static_cast<int32_t>(maxTextures);
+    }
+
+    auto it = std::find(frameTextures.begin(), frameTextures.end(), &texture);
+    if (it != frameTextures.end()) {
+        return static_cast<int32_t>(it - frameTextures.begin());
+    }
+    if (frameTextures.size() == maxTextures) {
+        return -1;
+    }
+    frameTextures.push_back(&texture);
+    return static_cast<int32_t>(frameTextures.size() - 1);
+}
+
+// Texture slot of a texture for the current frame. Without a unit left for the texture, draws what was queued so far, which frees every unit
+int32_t IndirectRenderer::acquireTextureSlot(const TextureResource& texture) {
+
+    int32_t slot = textureSlot(texture);
+    if (slot >= 0) {
+        return slot;
+    }
+    if (!isTextureOverflowReported) {
+        std::cerr << "ERROR::INDIRECT_RENDERER::TOO_MANY_TEXTURES: " << texture.path << " (more than " << maxTextures
+                  << " 2D textures or one texture array in a frame, drawn in several submissions)" << std::endl;
+        isTextureOverflowReported = true;
+    }
+    flush(flushedCounters);
+    return textureSlot(texture);
+}
+
+// Grows a buffer by copying it into a larger one, at least twice as large so that appending stays cheap
+bool IndirectRenderer::reserve(unsigned int& buffer, size_t used, size_t& capacity, size_t required) {
+
+    if (buffer && required <= capacity) {
+        return false;
+    }
+
+    size_t newCapacity = std::max(required, capacity * 2);
+    unsigned int newBuffer = 0;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, nullptr, GL_STATIC_DRAW);
+
+    if (buffer) {
+        if (used > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(used));
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+    return true;
+}
+
+// Points the VAO at the geometry buffer's vertices and indices, and at the draw indices
+void IndirectRenderer::setupVertexArray(GeometryBuffer& buffer) {
+
+    if (!buffer.VAO) {
+        glGenVertexArrays(1, &buffer.VAO);
+    }
+    glBindVertexArray(buffer.VAO);
+
+    ResourceCache::setupVertexAttributes(buffer.layout, buffer.VBO, buffer.EBO);
+
+    // Advanced once per instance, starting from the command's base instance
+    glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer);
+    glVertexAttribIPointer(drawIndexLocation, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+    glEnableVertexAttribArray(drawIndexLocation);
+    glVertexAttribDivisor(drawIndexLocation, 1);
+
+    // Unbind the VAO first, so that it keeps its element buffer
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// Grows the draw index buffer, and points every VAO at the new one
+void IndirectRenderer::reserveDrawIndices(size_t drawCount) {
+
+    if (drawCount <= drawIndexCapacity) {
+        return;
+    }
+
+    drawIndexCapacity = std::max<size_t>(std::max(drawCount, drawIndexCapacity * 2), 256);
+    std::vector<uint32_t> indices(drawIndexCapacity);
+    std::iota(indices.begin(), indices.end(), 0u);
+
+    glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (GeometryBuffer& buffer : geometry) {
+        setupVertexArray(buffer);
+    }
+}
+
+// Destructor: Deletes the buffers and the VAOs, and releases the programs
+IndirectRenderer::~IndirectRenderer() {
+
+    for (GeometryBuffer& buffer : geometry) {
+        glDeleteVertexArrays(1, &buffer.VAO);
+        glDeleteBuffers(1, &buffer.VBO);
+        glDeleteBuffers(1, &buffer.EBO);
+    }
+
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &drawDataBuffer);
+    glDeleteBuffers(1, &drawIndexBuffer);
+    for (InstanceGroup& group : groups) {
+        glDeleteBuffers(1, &group.buffer);
+    }
+
+    // Null programs are ignored
+    for (const ProgramResource* program : programs) {
+        resources.release(program);
+    }
+}
@@ -0,0 +1,208 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../resources/ResourceCache.h"
+#include "../culling/Frustum.h"
+#include "../scene/BatchTransform.h"
+
+// Submits the draws of a frame with one glMultiDrawElementsIndirect() call per material and vertex layout instead of one call per object.
+// The meshes are copied into one vertex and one element buffer per layout the first time they are drawn. Each frame, the queued draws
+// are sorted, their commands written into an indirect buffer, and their model matrices, dequantization and textures into a shader storage
+// buffer that the vertex shader reads through the draw's base instance. Objects that never move, such as the planets of a field, are kept
+// in instance groups instead, whose draw data stays in a storage buffer of their own between frames. Requires OpenGL 4.3
+class IndirectRenderer {
+
+public:
+
+    // Number of 2D textures the draws of a frame can use, besides one texture array. Must match the size of the sampler array in the fragment shaders
+    static const unsigned int maxTextures = 4;
+
+    // Whether the context supports multi-draw indirect and shader storage buffers, which are core in OpenGL 4.3
+    static bool isSupported();
+
+    // Constructor: Obtains the program of every indirect material from the resource cache. Requires a current OpenGL 4.3 context
+    explicit IndirectRenderer(ResourceCache& resources);
+
+    // The renderer owns its buffers, so it cannot be copied
+    IndirectRenderer(const IndirectRenderer&) = delete;
+    IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+    // Queues a level of detail of an uploaded mesh, textured with 'texture' (with the layer 'layer' of a texture array) and placed by the
+    // model and normal matrices of 'transform', which are stored as they are in the draw data. It is drawn with the indirect counterpart of
+    // the model's material. If every texture unit is taken, the draws queued so far are drawn first
+    void draw(const MeshResource& mesh, unsigned int level, Material material, const TextureResource& texture, int layer, const BodyTransform& transform);
+
+    // One instance of an instance group: its model and normal matrices, and its layer in the group's texture array
+    struct Instance {
+        BodyTransform transform;
+        int32_t layer;
+    };
+
+    // Creates an empty instance group, whose draw data is kept in a storage buffer of its own between frames. Returns its identifier
+    uint32_t createInstanceGroup();
+
+    // Replaces the instances of a group, of the mesh 'mesh' and ordered by level of detail. Their draw data is uploaded by the next
+    // drawInstances(), so this is only called when the instances change
+    void setInstances(uint32_t group, const MeshResource& mesh, const std::vector<Instance>& instances);
+
+    // Queues the instances of a group with one instanced command per level of detail, the first 'levelCounts[0]' instances at level 0,
+    // the next 'levelCounts[1]' at level 1 and so on, textured with 'texture'. Their draw data is only uploaded if it changed
+    void drawInstances(uint32_t group, const MeshResource& mesh, Material material, const TextureResource& texture, const std::vector<uint32_t>& levelCounts);
+
+    // Draws everything queued since the last call, and counts the draw calls and the binds of programs, VAOs and textures
+    void submit(CullingCounters& counters);
+
+    // Destructor: Deletes the buffers and releases the programs
+    ~IndirectRenderer();
+
+private:
+
+    // Data of one draw, read by the vertex shader from the shader storage buffer. Laid out as the std430 struct of the shader
+    struct DrawData {
+
+        // Model matrix and normal matrix, as the std430 mat4 and mat3 of the shader, which BodyTransform is laid out as
+        BodyTransform transform;
+
+        // Dequantization of the mesh's positions, in xyz
+        glm::vec4 positionOffset;
+        glm::vec4 positionScale;
+
+        // Texture unit of the draw's 2D texture, or maxTextures for the texture array, and the layer in the texture array
+        int32_t textureSlot;
+        int32_t layer;
+        int32_t padding[2];
+
+    };
+
+    // Command read by glMultiDrawElementsIndirect(), as defined by OpenGL
+    struct DrawCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    // Vertex and element buffers holding every mesh of one vertex layout, with the VAO reading them
+    struct GeometryBuffer {
+
+        VertexLayout layout;
+
+        unsigned int VAO = 0, VBO = 0, EBO = 0;
+
+        // Used and allocated bytes of the buffers
+        size_t vertexBytes = 0, vertexCapacity = 0;
+        size_t indexBytes = 0, indexCapacity = 0;
+
+    };
+
+    // Where a mesh was copied: its geometry buffer, and the position of its first vertex and first index there
+    struct MeshSlot {
+        uint32_t buffer;
+        int32_t baseVertex;
+        uint32_t firstIndex;
+    };
+
+    // A draw queued for the current frame. Draws of equal keys draw the same range of the same buffer with the same material
+    struct QueuedDraw {
+        uint64_t key;
+        DrawCommand command;
+        DrawData data;
+    };
+
+    // Consecutive commands drawn by one glMultiDrawElementsIndirect() call, reading their draw data from 'dataBuffer'
+    struct Batch {
+        Material material;
+        uint32_t buffer;
+        unsigned int dataBuffer;
+        size_t firstCommand;
+        size_t commandCount;
+    };
+
+    // Draw data of an instance group, its storage buffer, the texture slot written in the data, and whether the buffer is out of date
+    struct InstanceGroup {
+        std::vector<DrawData> data;
+        unsigned int buffer = 0;
+        int32_t textureSlot = -1;
+        bool isDirty = false;
+    };
+
+    // Cache that owns the programs
+    ResourceCache& resources;
+
+    // Program of every indirect material, indexed by Material, and null for the others
+    const ProgramResource* programs[static_cast<int>(Material::Count)] = {};
+
+    // One geometry buffer per vertex layout, and where each mesh was copied, keyed by the mesh's path
+    std::vector<GeometryBuffer> geometry;
+    std::unordered_map<std::string, MeshSlot> meshSlots;
+
+    // Textures of the current frame: the 2D textures, bound to units 0 to maxTextures - 1, and the texture array, bound to unit maxTextures
+    std::vector<const TextureResource*> frameTextures;
+    const TextureResource* frameTextureArray = nullptr;
+
+    // Draws of the current frame, in the order they were queued
+    std::vector<QueuedDraw> queued;
+
+    // Instance groups, indexed by their identifier
+    std::vector<InstanceGroup> groups;
+
+    // Commands and calls of the instance groups queued for the current frame, drawn after the sorted draws, and the largest number of
+    // instances of a queued group
+    std::vector<DrawCommand> groupCommands;
+    std::vector<Batch> groupBatches;
+    size_t groupInstanceCount = 0;
+
+    // Draw calls and binds of the submissions draw() made early this frame, for lack of texture units, added to those of submit()
+    CullingCounters flushedCounters;
+
+    // Whether running out of texture units was reported, which is done once
+    bool isTextureOverflowReported = false;
+
+    // Keys of the queued draws with their index, the sorted draw data and commands, and the calls drawing them, reused between frames
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+    std::vector<DrawData> sortedData;
+    std::vector<DrawCommand> commands;
+    std::vector<Batch> batches;
+
+    // Indirect command buffer and shader storage buffer of the draw data, refilled every frame
+    unsigned int commandBuffer = 0, drawDataBuffer = 0;
+
+    // Buffer of the indices 0, 1, 2..., read by every VAO as a per-instance attribute, so that each instance finds its draw data at
+    // the command's base instance plus its instance index
+    unsigned int drawIndexBuffer = 0;
+    size_t drawIndexCapacity = 0;
+
+    // Returns where the mesh was copied, copying it at the end of the buffer of its layout on its first draw
+    const MeshSlot& meshSlot(const MeshResource& mesh);
+
+    // Texture slot of a texture for the current frame, assigning it the next unit on its first use. Returns -1 when every unit of its
+    // target is taken by other textures
+    int32_t textureSlot(const TextureResource& texture);
+
+    // Texture slot of a texture for the current frame. When every unit of its target is taken, draws the draws queued so far, which
+    // frees the units, and reports it the first time
+    int32_t acquireTextureSlot(const TextureResource& texture);
+
+    // Draws the queued draws and frees the textures of the frame
+    void flush(CullingCounters& counters);
+
+    // Grows a buffer to at least 'required' bytes, keeping its 'used' first bytes. Returns whether it was reallocated
+    static bool reserve(unsigned int& buffer, size_t used, size_t& capacity, size_t required);
+
+    // Points the VAO of a geometry buffer at its buffers and at the draw index buffer
+    void setupVertexArray(GeometryBuffer& buffer);
+
+    // Grows the draw index buffer to at least 'drawCount' indices
+    void reserveDrawIndices(size_t drawCount);
+
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "RenderQueue.h"
+#include "../profiler/Profiler.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+
+// Sorts the draws by state, or draws them in submission order
+void RenderQueue::setStateSorting(bool enabled) {
+    isStateSorted = enabled;
+}
+
+// Adds a draw to the current frame
+void RenderQueue::submit(const DrawItem& item) {
+    items.push_back(item);
+}
+
+// Packs the program, the texture, the VAO and the level into a 64-bit key
+uint64_t RenderQueue::sortKey(const DrawItem& item) {
+    return (static_cast<uint64_t>(item.program->shader.id() & 0xFFFF) << 48)
+        | (static_cast<uint64_t>(item.texture->texture & 0xFFFF) << 32)
+        | (static_cast<uint64_t>(item.mesh->VAO & 0xFFFF) << 16)
+        | static_cast<uint64_t>(item.level & 0xFFFF);
+}
+
+// Draws the submitted draws in order of their keys. Equal keys keep their submission order
+void RenderQueue::execute(StateTracker& state, CullingCounters& counters) {
+
+    PROFILE_SCOPE("RenderQueue::execute");
+
+    order.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        order.emplace_back(isStateSorted ? sortKey(items[i]) : 0, static_cast<uint32_t>(i));
+    }
+    if (isStateSorted) {
+        std::sort(order.begin(), order.end());
+    }
+
+    // The dequantization is uploaded again only when the program or the mesh changes
+    const ProgramResource* dequantizedProgram = nullptr;
+    const MeshResource* dequantizedMesh = nullptr;
+
+    for (const std::pair<uint64_t, uint32_t>& entry : order) {
+        const DrawItem& item = items[entry.second];
+        const ShaderProgram& shader = item.program->shader;
+
+        state.useProgram(shader.id());
+        state.bindTexture(item.texture->target, item.texture->texture);
+        state.bindVertexArray(item.mesh->VAO);
+
+        // Upload the uniforms
+        glUniformMatrix4fv(shader.location(Uniform::Model), 1, GL_FALSE, glm::value_ptr(item.transform.model));
+        glUniformMatrix3fv(shader.location(Uniform::NormalMatrix), 1, GL_FALSE, glm::value_ptr(item.transform.normalMatrix()));
+        if (item.layer >= 0) {
+            glUniform1i(shader.location(Uniform::SkinLayer), item.layer);
+        }
+        if (item.program != dequantizedProgram || item.mesh != dequantizedMesh) {
+            glUniform3fv(shader.location(Uniform::PositionOffset), 1, glm::value_ptr(item.mesh->positionOffset));
+            glUniform3fv(shader.location(Uniform::PositionScale), 1, glm::value_ptr(item.mesh->positionScale));
+            dequantizedProgram = item.program;
+            dequantizedMesh = item.mesh;
+        }
+
+        // Draw the level of detail
+        const MeshLevel& drawnLevel = item.mesh->levels[item.level];
+        glDrawElements(GL_TRIANGLES, drawnLevel.indexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)(drawnLevel.firstIndex * sizeof(unsigned int)));
+        counters.drawCalls++;
+
+        // Unsorted draws restore the state after themselves, as each model's render() did
+        if (!isStateSorted) {
+            state.reset();
+            dequantizedProgram = nullptr;
+        }
+    }
+
+    items.clear();
+}
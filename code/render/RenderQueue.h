@@ -0,0 +1,66 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "StateTracker.h"
+#include "../resources/ResourceCache.h"
+#include "../culling/Frustum.h"
+#include "../scene/BatchTransform.h"
+
+// One draw submitted to the RenderQueue: what to bind, the level of detail to draw and the uniforms of the draw
+struct DrawItem {
+
+    // Program, mesh and texture to bind. The mesh also gives the dequantization of its positions
+    const ProgramResource* program;
+    const MeshResource* mesh;
+    const TextureResource* texture;
+
+    // Level of detail of the mesh to draw
+    unsigned int level;
+
+    // Layer of the texture array set as the 'skinLayer' uniform, or -1 for 2D textures
+    int layer;
+
+    // Model matrix of the draw, and its normal matrix, computed on the CPU once per draw rather than by the vertex shader for every vertex
+    BodyTransform transform;
+
+};
+
+// Collects the draws of a frame and executes them ordered by their bindings, so that the draws sharing a program, a texture or a mesh
+// follow each other and the StateTracker skips the binds already in effect
+class RenderQueue {
+
+public:
+
+    // Sorts the draws by state (true), or draws them in submission order, unbinding everything after each draw as the models used
+    // to (false), to measure the state changes saved
+    void setStateSorting(bool enabled);
+
+    // Adds a draw to the current frame
+    void submit(const DrawItem& item);
+
+    // Draws everything submitted since the last call, counting the draw calls, and leaves the last bindings in effect in 'state'
+    void execute(StateTracker& state, CullingCounters& counters);
+
+private:
+
+    // Whether the draws are sorted by state
+    bool isStateSorted = true;
+
+    // Draws of the current frame, in submission order
+    std::vector<DrawItem> items;
+
+    // Sort keys of the draws with their index, reused between frames
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+
+    // Packs the bindings of a draw into a key ordering the draws by program, then texture, then mesh and level. The binds are ordered
+    // from the most expensive to change. Each field holds the low 16 bits of an OpenGL name, which is enough to group equal bindings
+    static uint64_t sortKey(const DrawItem& item);
+
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "StateTracker.h"
+
+// Makes the program current, unless it already is
+void StateTracker::useProgram(unsigned int newProgram) {
+    if (newProgram != program) {
+        glUseProgram(newProgram);
+        program = newProgram;
+        ++changeCount;
+    }
+}
+
+// Binds the VAO, unless it already is
+void StateTracker::bindVertexArray(unsigned int newVertexArray) {
+    if (newVertexArray != vertexArray) {
+        glBindVertexArray(newVertexArray);
+        vertexArray = newVertexArray;
+        ++changeCount;
+    }
+}
+
+// Binds the texture to its target of texture unit 0, unless it already is
+void StateTracker::bindTexture(unsigned int target, unsigned int texture) {
+    unsigned int& bound = target == GL_TEXTURE_2D_ARRAY ? textureArray : texture2D;
+    if (texture != bound) {
+        glBindTexture(target, texture);
+        bound = texture;
+        ++changeCount;
+    }
+}
+
+// Unbinds the VAO, the textures and the program
+void StateTracker::reset() {
+    bindVertexArray(0);
+    bindTexture(GL_TEXTURE_2D, 0);
+    bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    useProgram(0);
+}
+
+// Number of binds issued since the last call
+unsigned int StateTracker::takeChangeCount() {
+    unsigned int count = changeCount;
+    changeCount = 0;
+    return count;
+}
@@ -0,0 +1,40 @@
+#ifndef STATE_TRACKER_H
+#define STATE_TRACKER_H
+
+#include <glad/glad.h>
+
+// Shadows the program, the VAO and the textures bound to texture unit 0, so that binding what is already bound issues no OpenGL call.
+// Counts the binds it issues. It assumes that nothing else changes these bindings between reset() calls
+class StateTracker {
+
+public:
+
+    // Makes the program current, unless it already is
+    void useProgram(unsigned int program);
+
+    // Binds the VAO, unless it already is
+    void bindVertexArray(unsigned int vertexArray);
+
+    // Binds the texture to GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY of texture unit 0, unless it already is
+    void bindTexture(unsigned int target, unsigned int texture);
+
+    // Unbinds everything still bound, leaving the state as the code outside the tracker expects it
+    void reset();
+
+    // Number of binds issued since the last call, which resets it
+    unsigned int takeChangeCount();
+
+private:
+
+    // Bindings in effect, 0 when nothing is bound
+    unsigned int program = 0;
+    unsigned int vertexArray = 0;
+    unsigned int texture2D = 0;
+    unsigned int textureArray = 0;
+
+    // Binds issued since the last takeChangeCount()
+    unsigned int changeCount = 0;
+
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "AssetLoader.h"
+#include <algorithm>
+
+// One less than the number of cores, leaving one to the OpenGL thread
+unsigned int AssetLoader::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+// Constructor: Starts the worker threads
+AssetLoader::AssetLoader(unsigned int workerCount) {
+    workerCount = std::max(workerCount, 1u);
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+// Number of worker threads
+unsigned int AssetLoader::workerCount() const {
+    return static_cast<unsigned int>(workers.size());
+}
+
+// Queues a job and wakes a worker for it
+void AssetLoader::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        ++pendingJobs;
+    }
+    jobQueued.notify_one();
+}
+
+// Takes the completions out of the queue first, so that the workers can queue more while they run
+size_t AssetLoader::runCompletions() {
+
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.swap(completions);
+    }
+
+    for (Completion& completion : done) {
+        if (completion) {
+            completion();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingJobs -= done.size();
+    return done.size();
+}
+
+// Number of submitted jobs whose completion has not run yet
+size_t AssetLoader::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingJobs;
+}
+
+// Runs jobs and queues their completions, until the loader is destroyed
+void AssetLoader::workerLoop() {
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobQueued.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        Completion completion = job();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completions.push_back(std::move(completion));
+    }
+}
+
+// Destructor: Stops and joins the worker threads, after the jobs they are running
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobQueued.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
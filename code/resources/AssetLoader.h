@@ -0,0 +1,72 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads decoding assets in the background. A job runs on a worker and returns its completion, the part
+// that needs the OpenGL context (such as the upload), which the OpenGL thread runs later through runCompletions().
+// Jobs start in the order they are submitted, and their completions run in the order the jobs finish
+class AssetLoader {
+
+public:
+
+    // Work left for the OpenGL thread once a job is done
+    using Completion = std::function<void()>;
+
+    // Work done on a worker, returning its completion
+    using Job = std::function<Completion()>;
+
+    // Constructor: Starts 'workerCount' worker threads, at least one. By default, one less than the number of cores
+    explicit AssetLoader(unsigned int workerCount = defaultWorkerCount());
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Queues a job for the workers
+    void submit(Job job);
+
+    // Runs the completions of the jobs done so far on the calling thread, and returns their number. Never waits for a job
+    size_t runCompletions();
+
+    // Number of submitted jobs whose completion has not run yet
+    size_t pendingCount() const;
+
+    // Number of worker threads
+    unsigned int workerCount() const;
+
+    // One less than the number of cores, or 1 when the number of cores is unknown
+    static unsigned int defaultWorkerCount();
+
+    // Destructor: Stops and joins the worker threads. Queued jobs and completions that have not run are dropped
+    ~AssetLoader();
+
+private:
+
+    std::vector<std::thread> workers;
+
+    // Protects the queues and wakes the workers
+    mutable std::mutex mutex;
+    std::condition_variable jobQueued;
+
+    // Jobs waiting for a worker, and completions waiting for the OpenGL thread
+    std::deque<Job> jobs;
+    std::vector<Completion> completions;
+
+    // Number of jobs submitted and not completed yet, queued, running or waiting for their completion
+    size_t pendingJobs = 0;
+
+    // Set by the destructor to stop the workers
+    bool stopping = false;
+
+    // Main function of the worker threads
+    void workerLoop();
+
+};
+
+#endif
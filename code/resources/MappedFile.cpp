@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// Maps the file at the given path with CreateFileMapping()
+bool MappedFile::open(const std::string& path) {
+
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+// Unmaps the view and closes the handles
+void MappedFile::close() {
+
+    if (bytes)
+        UnmapViewOfFile(bytes);
+
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+
+    if (fileHandle)
+        CloseHandle(fileHandle);
+
+    bytes = nullptr;
+    length = 0;
+    fileHandle = mappingHandle = nullptr;
+}
+
+#else
+
+// Maps the file at the given path with mmap()
+bool MappedFile::open(const std::string& path) {
+
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(file);
+
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    bytes = static_cast<const unsigned char*>(view);
+    length = static_cast<size_t>(status.st_size);
+    return true;
+}
+
+// Unmaps the file
+void MappedFile::close() {
+
+    if (bytes)
+        munmap(const_cast<unsigned char*>(bytes), length);
+
+    bytes = nullptr;
+    length = 0;
+}
+
+#endif
+
+// Destructor: Releases the mapping
+MappedFile::~MappedFile() {
+    close();
+}
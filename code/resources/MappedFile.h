@@ -0,0 +1,46 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// A read-only memory mapping of a whole file. The mapping is released when the instance is destroyed
+class MappedFile {
+
+public:
+
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file at the given path, replacing any previous mapping. Returns false if the file cannot be mapped
+    bool open(const std::string& path);
+
+    // Releases the mapping
+    void close();
+
+    // Start of the mapped bytes, or nullptr if nothing is mapped
+    const unsigned char* data() const { return bytes; }
+
+    // Number of mapped bytes
+    size_t size() const { return length; }
+
+    // Destructor: Releases the mapping
+    ~MappedFile();
+
+private:
+
+    const unsigned char* bytes = nullptr;
+
+    size_t length = 0;
+
+#ifdef _WIN32
+    // Handles of the file and of its mapping object
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+};
+
+#endif
@@ -0,0 +1,1134 @@
+#include "ResourceCache.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <iostream>
+#include <iomanip>
+#include "../mesh/MeshOptimizer.h"
+#include "../mesh/MeshSimplifier.h"
+#include "../mesh/BinaryMesh.h"
+#include "../mesh/VertexPacking.h"
+#include "../texture/BinaryTexture.h"
+#include "../texture/TextureCooker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#define STBI_MALLOC(sz)           malloc(sz)
+#define STBI_FREE(ptr)            free(ptr)
+#define STBI_REALLOC(ptr, newsz)  realloc(ptr, newsz)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace {
+
+// The binary texture is stored next to the image, one per compression, e.g. Earth.png -> Earth.tex or Earth.bc1.tex
+std::string binaryTexturePath(const std::string& texturePath, TextureCompression compression) {
+    return std::filesystem::path(texturePath).replace_extension(compression == TextureCompression::Bc1 ? ".bc1.tex" : ".tex").string();
+}
+
+// A layer resampled for a texture array is stored next to its image too, with the size it was resampled to, e.g.
+// Planet_1.png -> Planet_1.2098x1574.tex or Planet_1.2098x1574.bc1.tex
+std::string resampledTexturePath(const std::string& texturePath, uint32_t width, uint32_t height, TextureCompression compression) {
+    std::string extension = "." + std::to_string(width) + "x" + std::to_string(height) + (compression == TextureCompression::Bc1 ? ".bc1.tex" : ".tex");
+    return std::filesystem::path(texturePath).replace_extension(extension).string();
+}
+
+// Whether a texture of the internal format was cooked with the compression
+bool isCookedAs(uint32_t internalFormat, TextureCompression compression) {
+    if (compression == TextureCompression::Bc1) {
+        return internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+    return internalFormat == GL_RGB8 || internalFormat == GL_RGBA8;
+}
+
+// Short name of an internal format, for the load log
+const char* textureFormatName(uint32_t internalFormat) {
+    switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+        case GL_RGB8: case GL_RGB: return "RGB8";
+        case GL_RGBA8: case GL_RGBA: return "RGBA8";
+        default: return "unknown format";
+    }
+}
+
+// Whether the driver exposes the extension
+bool hasExtension(const char* name) {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+// Returns the mesh of the object file, loading it on the first request
+const MeshResource* ResourceCache::acquireMesh(const std::string& path) {
+
+    Entry<MeshResource>& entry = meshes[path];
+
+    // Load the mesh only if no model is using it yet
+    if (entry.referenceCount == 0) {
+        entry.resource.path = path;
+        if (assetLoader) {
+            loadModelAsync(path, entry.resource);
+        }
+        else if (!loadModel(path, entry.resource, entry.residentBytes)) {
+            // A single empty level, so that models using the mesh draw nothing
+            entry.resource.levels.assign(1, MeshLevel{ 0, 0, 0.0f });
+        }
+        entry.misses++;
+    }
+    else {
+        entry.hits++;
+    }
+
+    entry.referenceCount++;
+    return &entry.resource;
+}
+
+// Returns the texture of the image, loading it on the first request
+const TextureResource* ResourceCache::acquireTexture(const std::string& path) {
+
+    Entry<TextureResource>& entry = textures[path];
+
+    // Decode and upload the image only if no model is using it yet
+    if (entry.referenceCount == 0) {
+        entry.resource.path = path;
+        if (assetLoader) {
+            loadTextureAsync({ path }, entry.resource);
+        }
+        else {
+            loadTexture(path, entry.resource, entry.residentBytes);
+        }
+        entry.misses++;
+    }
+    else {
+        entry.hits++;
+    }
+
+    entry.referenceCount++;
+    return &entry.resource;
+}
+
+// Returns the texture array of the images, loading it on the first request
+const TextureResource* ResourceCache::acquireTextureArray(const std::vector<std::string>& paths) {
+
+    std::string key;
+    for (const std::string& path : paths) {
+        key += (key.empty() ? "" : "|") + path;
+    }
+    Entry<TextureResource>& entry = textures[key];
+
+    // Decode, resample and upload the images only if no model is using the array yet
+    if (entry.referenceCount == 0) {
+        entry.resource.path = key;
+        entry.resource.target = GL_TEXTURE_2D_ARRAY;
+        entry.resource.layerCount = static_cast<unsigned int>(paths.size());
+        if (assetLoader) {
+            loadTextureAsync(paths, entry.resource);
+        }
+        else {
+            loadTextureArray(paths, entry.resource, entry.residentBytes);
+        }
+        entry.misses++;
+    }
+    else {
+        entry.hits++;
+    }
+
+    entry.referenceCount++;
+    return &entry.resource;
+}
+
+// Returns the program linked from the two shaders, compiling it on the first request
+const ProgramResource* ResourceCache::acquireProgram(const std::string& vertexPath, const std::string& fragmentPath) {
+
+    std::string key = vertexPath + "|" + fragmentPath;
+    Entry<ProgramResource>& entry = programs[key];
+
+    // Compile and link the shaders only if no model is using them yet
+    if (entry.referenceCount == 0) {
+        entry.resource.path = key;
+        buildProgram(entry.resource, vertexPath, fragmentPath, "");
+        entry.misses++;
+    }
+    else {
+        entry.hits++;
+    }
+
+    entry.referenceCount++;
+    return &entry.resource;
+}
+
+// Compiles the material's permutation on the first request, keyed by the material's name so that it is shared by every model of the material
+const ProgramResource* ResourceCache::acquireMaterial(Material material) {
+
+    std::string key = std::string("material:") + materialPermutation(material).name;
+    Entry<ProgramResource>& entry = programs[key];
+
+    if (entry.referenceCount == 0) {
+        entry.resource.path = key;
+        buildProgram(entry.resource, bodyVertexShaderPath, bodyFragmentShaderPath, materialPreamble(material));
+        entry.misses++;
+    }
+    else {
+        entry.hits++;
+    }
+
+    entry.referenceCount++;
+    return &entry.resource;
+}
+
+// Builds the program through the program binary cache, and prints and adds up the time taken, as the programs are built while loading
+void ResourceCache::buildProgram(ProgramResource& program, const std::string& vertexPath, const std::string& fragmentPath, const std::string& preamble) {
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    program.shader.build(vertexPath, fragmentPath, preamble, &programBinaries);
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    bool isFromBinary = program.shader.isFromBinary();
+    std::cout << "Program " << program.path << ": " << (isFromBinary ? "loaded from its binary" : "compiled") << " in " << milliseconds << " ms" << std::endl;
+    programMilliseconds += milliseconds;
+    (isFromBinary ? programBinaryLoads : programCompiles)++;
+}
+
+// Drops a reference to an entry, destroying its GPU objects with the last reference.
+// The entry itself is kept, so that the hit and miss counts survive until the report
+template <typename Resource>
+void ResourceCache::releaseEntry(std::unordered_map<std::string, Entry<Resource>>& entries, const Resource* resource) {
+
+    if (!resource) {
+        return;
+    }
+
+    auto it = entries.find(resource->path);
+    if (it == entries.end() || it->second.referenceCount == 0) {
+        std::cerr << "ERROR::RESOURCE_CACHE::RELEASE_WITHOUT_ACQUIRE: " << resource->path << std::endl;
+        return;
+    }
+
+    Entry<Resource>& entry = it->second;
+    if (--entry.referenceCount == 0) {
+        destroy(entry.resource);
+        entry.residentBytes = 0;
+    }
+}
+
+void ResourceCache::release(const MeshResource* mesh) {
+    releaseEntry(meshes, mesh);
+}
+
+void ResourceCache::release(const TextureResource* texture) {
+    releaseEntry(textures, texture);
+}
+
+void ResourceCache::release(const ProgramResource* program) {
+    releaseEntry(programs, program);
+}
+
+// Selects how meshes use binary mesh files
+void ResourceCache::setMeshCacheMode(MeshCacheMode mode) {
+    meshCacheMode = mode;
+}
+
+// Selects how the vertices of meshes are stored
+void ResourceCache::setVertexFormat(VertexFormat format) {
+    vertexFormat = format;
+}
+
+// Selects how textures use binary texture files
+void ResourceCache::setTextureCacheMode(TextureCacheMode mode) {
+    textureCacheMode = mode;
+}
+
+// Selects how cooked textures are stored on the GPU, if the driver can sample them
+bool ResourceCache::setTextureCompression(TextureCompression compression) {
+
+    if (compression == TextureCompression::Bc1 && !hasExtension("GL_EXT_texture_compression_s3tc")) {
+        std::cerr << "ERROR::RESOURCE_CACHE::BC1_UNSUPPORTED: GL_EXT_texture_compression_s3tc is missing, textures are not compressed" << std::endl;
+        textureCompression = TextureCompression::None;
+        return false;
+    }
+
+    textureCompression = compression;
+    return true;
+}
+
+// Selects how programs use the binaries saved in the directory
+void ResourceCache::setShaderCacheMode(ShaderCacheMode mode, const std::string& directory) {
+    programBinaries.setMode(mode, directory);
+}
+
+// Generates the mesh of the object file procedurally instead of loading it
+void ResourceCache::defineSphere(const std::string& path, const SphereDescription& description) {
+    spheres[path] = description;
+}
+
+// Decodes the assets requested afterwards on the loader's workers
+void ResourceCache::setAssetLoader(AssetLoader* loader) {
+    assetLoader = loader;
+}
+
+// Generates the mesh if it is a procedural sphere. Otherwise loads it from its binary mesh file if it is up to date,
+// or imports the object file and writes the binary mesh
+bool ResourceCache::loadModel(const std::string& path, MeshResource& mesh, size_t& residentBytes) {
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // The binary mesh is stored next to the object file, e.g. Earth.obj -> Earth.mesh, and is uploaded straight from its mapping
+    std::string binaryPath = std::filesystem::path(path).replace_extension(".mesh").string();
+    auto sphere = spheres.find(path);
+    bool isSphere = sphere != spheres.end();
+
+    bool loaded = false;
+    const char* source = "binary mesh";
+    if (!isSphere && meshCacheMode == MeshCacheMode::Enabled) {
+        loaded = loadBinaryMesh(binaryPath, path, mesh, residentBytes);
+    }
+
+    // Otherwise generate or import the mesh. A binary mesh that could not be loaded is not read again, but rewritten
+    if (!loaded) {
+        MeshData meshData;
+        MeshCacheMode mode = meshCacheMode == MeshCacheMode::Enabled ? MeshCacheMode::Rebuild : meshCacheMode;
+        if (!decodeModel(path, isSphere ? &sphere->second : nullptr, mode, meshData, source, std::cout)) {
+            return false;
+        }
+        uploadMeshData(meshData, mesh, residentBytes);
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    std::cout << "Mesh " << path << ": loaded from " << source << " in "
+              << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms" << std::endl;
+
+    return true;
+}
+
+// Decodes the mesh on a worker. The worker only reads the values captured here, and the completion, which runs on the
+// OpenGL thread, finds the entry again by path, as every model may have released it in the meantime
+void ResourceCache::loadModelAsync(const std::string& path, MeshResource& mesh) {
+
+    // Requested again before the previous request was uploaded, which then serves this one too
+    if (mesh.pending) {
+        return;
+    }
+    mesh.pending = true;
+
+    // A single empty level until the upload, so that models can choose levels and count triangles
+    mesh.levels.assign(1, MeshLevel{ 0, 0, 0.0f });
+
+    auto sphere = spheres.find(path);
+    bool isSphere = sphere != spheres.end();
+    SphereDescription description = isSphere ? sphere->second : SphereDescription();
+    MeshCacheMode mode = meshCacheMode;
+    auto requestTime = std::chrono::steady_clock::now();
+
+    assetLoader->submit([this, path, isSphere, description, mode, requestTime]() -> AssetLoader::Completion {
+
+        // Lines printed by the worker are kept for the completion, so that they are not interleaved with those of other workers
+        auto meshData = std::make_shared<MeshData>();
+        std::ostringstream log;
+        const char* source = "";
+        bool loaded = decodeModel(path, isSphere ? &description : nullptr, mode, *meshData, source, log);
+
+        std::string text = log.str();
+        return [this, path, meshData, loaded, source, text, requestTime]() {
+            std::cout << text;
+            finishModel(path, loaded ? meshData.get() : nullptr, source, requestTime);
+        };
+    });
+}
+
+// Uploads a decoded mesh into its entry, and reports the time since the request and the time of the upload itself
+void ResourceCache::finishModel(const std::string& path, const MeshData* meshData, const char* source, std::chrono::steady_clock::time_point requestTime) {
+
+    auto it = meshes.find(path);
+    if (it == meshes.end()) {
+        return;
+    }
+
+    Entry<MeshResource>& entry = it->second;
+    entry.resource.pending = false;
+
+    // Every model released the mesh while it was decoded
+    if (entry.referenceCount == 0 || !meshData) {
+        return;
+    }
+
+    auto uploadStartTime = std::chrono::steady_clock::now();
+    uploadMeshData(*meshData, entry.resource, entry.residentBytes);
+    auto endTime = std::chrono::steady_clock::now();
+
+    std::cout << "Mesh " << path << ": loaded from " << source << " in "
+              << std::chrono::duration<double, std::milli>(endTime - requestTime).count() << " ms in the background (upload "
+              << std::chrono::duration<double, std::milli>(endTime - uploadStartTime).count() << " ms)" << std::endl;
+}
+
+// Produces the data of a mesh without touching OpenGL or the cache
+bool ResourceCache::decodeModel(const std::string& path, const SphereDescription* sphere, MeshCacheMode mode, MeshData& meshData, const char*& source, std::ostream& log) {
+
+    if (sphere) {
+        source = "sphere generator";
+        meshData = generateSphere(*sphere);
+        printLevels(log, path, meshData);
+        return true;
+    }
+
+    // The binary mesh is stored next to the object file, e.g. Earth.obj -> Earth.mesh
+    std::string binaryPath = std::filesystem::path(path).replace_extension(".mesh").string();
+    source = "binary mesh";
+    if (mode == MeshCacheMode::Enabled && readBinaryMesh(binaryPath, path, meshData)) {
+        return true;
+    }
+
+    source = "Assimp";
+    if (!importModel(path, meshData, log)) {
+        return false;
+    }
+
+    // Convert the mesh, so that the next launch can skip the import
+    SourceFingerprint fingerprint;
+    if (mode != MeshCacheMode::Disabled && fingerprintFile(path, fingerprint, true)) {
+        writeBinaryMesh(binaryPath, meshData, VertexLayout::interleavedFloats(), fingerprint);
+    }
+    return true;
+}
+
+// Copies the blobs of a binary mesh out of its mapping, which also reads the file on the calling thread rather than during the upload
+bool ResourceCache::readBinaryMesh(const std::string& binaryPath, const std::string& sourcePath, MeshData& meshData) {
+
+    BinaryMesh binaryMesh;
+    if (!binaryMesh.open(binaryPath, sourcePath)) {
+        return false;
+    }
+
+    // Files of other layouts are imported again, and rewritten in MeshData's layout
+    const BinaryMeshHeader& header = binaryMesh.header();
+    if (header.indexType != GL_UNSIGNED_INT || header.layout.stride != VertexLayout::interleavedFloats().stride
+        || header.vertexBytes != static_cast<uint64_t>(header.vertexCount) * header.layout.stride) {
+        return false;
+    }
+
+    const float* vertices = static_cast<const float*>(binaryMesh.vertexData());
+    const unsigned int* indices = static_cast<const unsigned int*>(binaryMesh.indexData());
+    meshData.vertices.assign(vertices, vertices + static_cast<size_t>(header.vertexCount) * MeshData::floatsPerVertex);
+    meshData.indices.assign(indices, indices + static_cast<size_t>(header.indexBytes / sizeof(unsigned int)));
+    meshData.levels = binaryMesh.levels();
+    return true;
+}
+
+// Uploads a mesh held in memory, with its bounding sphere and levels of detail
+void ResourceCache::uploadMeshData(const MeshData& meshData, MeshResource& mesh, size_t& residentBytes) {
+
+    mesh.bounds = computeBoundingSphere(meshData);
+    mesh.levels = meshData.levels;
+    uploadVertices(meshData.vertices.data(), meshData.vertexCount(), meshData.indices.data(), meshData.indices.size() * sizeof(unsigned int), mesh, residentBytes);
+}
+
+// Uploads the vertices as they are, or packs them into formats chosen for this mesh and reports what packing saved and cost
+void ResourceCache::uploadVertices(const float* vertices, unsigned int vertexCount, const void* indices, size_t indexBytes, MeshResource& mesh, size_t& residentBytes) {
+
+    size_t vertexBytes = static_cast<size_t>(vertexCount) * MeshData::floatsPerVertex * sizeof(float);
+
+    if (vertexFormat == VertexFormat::Packed) {
+
+        PackedVertices packed;
+        packVertices(vertices, vertexCount, packed);
+        mesh.layout = packed.layout;
+        mesh.positionOffset = packed.positionOffset;
+        mesh.positionScale = packed.positionScale;
+        mesh.quantizationError = mesh.bounds.radius > 0.0f ? packed.positionError / mesh.bounds.radius : 0.0f;
+
+        std::cout << "Mesh " << mesh.path << ": vertices packed from " << VertexLayout::interleavedFloats().stride << " to " << packed.layout.stride << " bytes ("
+                  << vertexBytes << " -> " << packed.data.size() << " bytes), positions " << packed.positionFormat << " (error "
+                  << mesh.quantizationError * 100.0f << " % of the radius), texture coordinates " << packed.texCoordFormat
+                  << ", normals 10-bit (error " << packed.normalError * 180.0f / 3.14159265f << " degrees)" << std::endl;
+
+        setupBuffers(packed.data.data(), packed.data.size(), indices, indexBytes, mesh);
+        residentBytes = packed.data.size() + indexBytes;
+        return;
+    }
+
+    mesh.layout = VertexLayout::interleavedFloats();
+    mesh.positionOffset = glm::vec3(0.0f);
+    mesh.positionScale = glm::vec3(1.0f);
+    mesh.quantizationError = 0.0f;
+    setupBuffers(vertices, vertexBytes, indices, indexBytes, mesh);
+    residentBytes = vertexBytes + indexBytes;
+}
+
+// Maps an up-to-date binary mesh file and uploads it straight from the mapping, without an intermediate copy
+bool ResourceCache::loadBinaryMesh(const std::string& binaryPath, const std::string& sourcePath, MeshResource& mesh, size_t& residentBytes) {
+
+    BinaryMesh binaryMesh;
+    if (!binaryMesh.open(binaryPath, sourcePath)) {
+        return false;
+    }
+
+    const BinaryMeshHeader& header = binaryMesh.header();
+    if (header.indexType != GL_UNSIGNED_INT) {
+        return false;
+    }
+
+    mesh.bounds = binaryMesh.boundingSphere();
+    mesh.levels = binaryMesh.levels();
+
+    // Vertices of MeshData's layout can be packed, others are uploaded in their own layout
+    if (header.layout.stride == VertexLayout::interleavedFloats().stride && header.vertexBytes == static_cast<uint64_t>(header.vertexCount) * header.layout.stride) {
+        uploadVertices(static_cast<const float*>(binaryMesh.vertexData()), header.vertexCount, binaryMesh.indexData(), static_cast<size_t>(header.indexBytes), mesh, residentBytes);
+        return true;
+    }
+
+    mesh.layout = header.layout;
+    setupBuffers(binaryMesh.vertexData(), static_cast<size_t>(header.vertexBytes), binaryMesh.indexData(), static_cast<size_t>(header.indexBytes), mesh);
+    residentBytes = static_cast<size_t>(header.vertexBytes + header.indexBytes);
+
+    return true;
+}
+
+// Imports the object file using Assimp, optimizes its first mesh for the vertex cache and builds its levels of detail
+bool ResourceCache::importModel(const std::string& path, MeshData& meshData, std::ostream& log) {
+
+    // Merge the duplicated vertices of the object file, so that triangles share them through the index buffer
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    // Process the first mesh into a temporary copy, only needed until it is uploaded
+    processMesh(scene->mMeshes[0], meshData);
+
+    // Without an index buffer every triangle has its own three vertices, and each one is a cache miss
+    size_t unindexedVertexCount = meshData.indices.size();
+    float joinedACMR = computeACMR(meshData.indices, meshData.vertexCount());
+
+    // Reorder the triangles for the post-transform cache, then the vertices for fetch locality
+    optimizeVertexCache(meshData);
+    optimizeVertexFetch(meshData);
+    float optimizedACMR = computeACMR(meshData.indices, meshData.vertexCount());
+
+    log << "Mesh " << path << ": vertices " << unindexedVertexCount << " -> " << meshData.vertexCount()
+              << ", ACMR 3.000 (unindexed) -> " << std::fixed << std::setprecision(3) << joinedACMR
+              << " (indexed) -> " << optimizedACMR << " (optimized)" << std::defaultfloat << std::endl;
+
+    // Simplify the mesh into levels of detail, drawn instead of the full mesh when it covers few pixels
+    buildLevelsOfDetail(meshData);
+    printLevels(log, path, meshData);
+
+    return true;
+}
+
+// Prints the triangles and the error of each level of detail of a mesh
+void ResourceCache::printLevels(std::ostream& stream, const std::string& path, const MeshData& meshData) {
+
+    stream << "Mesh " << path << ": levels of detail";
+    for (const MeshLevel& level : meshData.levels) {
+        stream << " " << level.indexCount / 3 << " (" << std::fixed << std::setprecision(1) << level.error * 100.0f << " %)" << std::defaultfloat;
+    }
+    stream << " triangles (error)" << std::endl;
+}
+
+// Processes the mesh and stores vertices, texture coordinates, normals and the triangles' indices
+void ResourceCache::processMesh(aiMesh* mesh, MeshData& meshData) {
+
+    std::vector<float>& vertices = meshData.vertices;
+    vertices.clear();
+    vertices.reserve(static_cast<size_t>(mesh->mNumVertices) * MeshData::floatsPerVertex);
+
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+
+        // Vertices
+        vertices.push_back(mesh->mVertices[i].x);
+        vertices.push_back(mesh->mVertices[i].y);
+        vertices.push_back(mesh->mVertices[i].z);
+
+        // Texture Coordinates (zero if not available, to keep the layout of the vertex)
+        vertices.push_back(mesh->mTextureCoords[0] ? mesh->mTextureCoords[0][i].x : 0.0f);
+        vertices.push_back(mesh->mTextureCoords[0] ? mesh->mTextureCoords[0][i].y : 0.0f);
+
+        // Normals (zero if not available, to keep the layout of the vertex)
+        vertices.push_back(mesh->HasNormals() ? mesh->mNormals[i].x : 0.0f);
+        vertices.push_back(mesh->HasNormals() ? mesh->mNormals[i].y : 0.0f);
+        vertices.push_back(mesh->HasNormals() ? mesh->mNormals[i].z : 0.0f);
+
+    }
+
+    // Triangles. Faces of other sizes (points and lines) are skipped
+    meshData.indices.clear();
+    meshData.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace& face = mesh->mFaces[i];
+        if (face.mNumIndices == 3) {
+            meshData.indices.insert(meshData.indices.end(), face.mIndices, face.mIndices + 3);
+        }
+    }
+
+}
+
+// Sets up the VAO, VBO and EBO for the mesh, from vertices in the mesh's layout and 32-bit indices
+void ResourceCache::setupBuffers(const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes, MeshResource& mesh) {
+
+    // A mesh without levels of detail is its own single level
+    if (mesh.levels.empty()) {
+        mesh.levels.push_back({ 0, static_cast<uint32_t>(indexBytes / sizeof(unsigned int)), 0.0f });
+    }
+
+    glGenVertexArrays(1, &mesh.VAO);
+    glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
+
+    glBindVertexArray(mesh.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indices, GL_STATIC_DRAW);
+
+    setupVertexAttributes(mesh);
+
+    // Unbind the VAO first, so that it keeps its element buffer
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Check for OpenGL errors
+    GLenum err;
+    while ((err = glGetError()) != GL_NO_ERROR) {
+        std::cerr << "OpenGL error in setupBuffers: " << err << std::endl;
+    }
+
+}
+
+// Configures the vertex attributes and the element buffer of the mesh on the currently bound VAO
+void ResourceCache::setupVertexAttributes(const MeshResource& mesh) {
+    setupVertexAttributes(mesh.layout, mesh.VBO, mesh.EBO);
+}
+
+// Configures the vertex attributes of the layout and the element buffer on the currently bound VAO
+void ResourceCache::setupVertexAttributes(const VertexLayout& layout, unsigned int VBO, unsigned int EBO) {
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // The element buffer binding is part of the VAO's state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    // Configure for the shader, as described by the layout :
+    // vertex positions (location 0), texture coordinates (location 1) and vertex normals (location 2)
+    for (uint32_t i = 0; i < layout.attributeCount; ++i) {
+        const VertexAttribute& attribute = layout.attributes[i];
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE, layout.stride, (void*)(uintptr_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+
+}
+
+// Loads the texture from its binary texture file if it is up to date, uploading the levels straight from the mapping.
+// Otherwise decodes the image, and cooks it unless the cache is disabled
+bool ResourceCache::loadTexture(const std::string& texturePath, TextureResource& texture, size_t& residentBytes) {
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    const char* source = "binary texture";
+    TextureData textureData;
+    bool loaded = false;
+    if (textureCacheMode == TextureCacheMode::Enabled) {
+        BinaryTexture binaryTexture;
+        if (binaryTexture.open(binaryTexturePath(texturePath, textureCompression), texturePath)
+            && isCookedAs(binaryTexture.header().internalFormat, textureCompression)) {
+            textureData.internalFormat = binaryTexture.header().internalFormat;
+            textureData.format = binaryTexture.header().format;
+            textureData.levels = binaryTexture.levels();
+            uploadTexture(textureData, binaryTexture.levelData(), texture, residentBytes);
+            loaded = true;
+        }
+    }
+
+    // A binary texture that could not be loaded is not read again, but rewritten
+    if (!loaded) {
+        TextureCacheMode mode = textureCacheMode == TextureCacheMode::Enabled ? TextureCacheMode::Rebuild : textureCacheMode;
+        if (!decodeTexture(texturePath, mode, textureCompression, textureData, source, std::cout)) {
+            return false;
+        }
+        uploadTexture(textureData, textureData.bytes.data(), texture, residentBytes);
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    std::cout << "Texture " << texturePath << ": loaded from " << source << " (" << textureFormatName(textureData.internalFormat) << ", "
+              << textureData.levels.size() << " levels, " << residentBytes << " bytes resident) in "
+              << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms" << std::endl;
+
+    return true;
+}
+
+// Loads every layer from its binary texture or its image, then uploads the array from the layers copied together
+bool ResourceCache::loadTextureArray(const std::vector<std::string>& paths, TextureResource& texture, size_t& residentBytes) {
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    TextureData textureData;
+    if (!decodeTextureArray(paths, textureCacheMode, textureCompression, textureData, std::cout)) {
+        return false;
+    }
+    uploadTexture(textureData, textureData.bytes.data(), texture, residentBytes);
+
+    auto endTime = std::chrono::steady_clock::now();
+    std::cout << "Texture array " << texture.path << ": loaded " << textureData.layerCount << " layers of " << textureData.levels[0].width << " x "
+              << textureData.levels[0].height << " (" << textureFormatName(textureData.internalFormat) << ", " << textureData.levels.size() << " levels, "
+              << residentBytes << " bytes resident) in " << std::chrono::duration<double, std::milli>(endTime - startTime).count() << " ms" << std::endl;
+
+    return true;
+}
+
+// Decodes the texture, or every layer of the texture array, on a worker, whose levels the completion uploads on the OpenGL thread
+void ResourceCache::loadTextureAsync(const std::vector<std::string>& paths, TextureResource& texture) {
+
+    // Requested again before the previous request was uploaded, which then serves this one too
+    if (texture.pending) {
+        return;
+    }
+    texture.pending = true;
+
+    std::string texturePath = texture.path;
+    bool isArray = texture.target == GL_TEXTURE_2D_ARRAY;
+    TextureCacheMode mode = textureCacheMode;
+    TextureCompression compression = textureCompression;
+    auto requestTime = std::chrono::steady_clock::now();
+
+    assetLoader->submit([this, texturePath, paths, isArray, mode, compression, requestTime]() -> AssetLoader::Completion {
+
+        // Lines printed by the worker are kept for the completion, so that they are not interleaved with those of other workers
+        auto textureData = std::make_shared<TextureData>();
+        std::ostringstream log;
+        const char* source = "the images of its layers";
+        bool loaded = isArray ? decodeTextureArray(paths, mode, compression, *textureData, log)
+                              : decodeTexture(paths[0], mode, compression, *textureData, source, log);
+
+        std::string text = log.str();
+        return [this, texturePath, textureData, loaded, source, text, requestTime]() {
+            std::cout << text;
+            mapTexture(texturePath, loaded ? textureData : nullptr, source, requestTime);
+        };
+    });
+}
+
+// Maps a pixel buffer object of the size of the levels and has a worker copy them into it, so that the OpenGL thread neither copies
+// them nor waits for glTexImage2D() to read them from client memory
+void ResourceCache::mapTexture(const std::string& texturePath, std::shared_ptr<TextureData> textureData, const char* source, std::chrono::steady_clock::time_point requestTime) {
+
+    auto it = textures.find(texturePath);
+    if (it == textures.end()) {
+        return;
+    }
+
+    // Every model released the texture while it was decoded, or it could not be decoded
+    Entry<TextureResource>& entry = it->second;
+    if (entry.referenceCount == 0 || !textureData) {
+        entry.resource.pending = false;
+        return;
+    }
+
+    auto mapStartTime = std::chrono::steady_clock::now();
+
+    size_t dataBytes = textureData->bytes.size();
+    GLuint pixelBuffer = 0;
+    glGenBuffers(1, &pixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, dataBytes, nullptr, GL_STREAM_DRAW);
+    void* mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, dataBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    double mapMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mapStartTime).count();
+
+    // Without a mapping, upload the levels from client memory
+    if (!mapping) {
+        glDeleteBuffers(1, &pixelBuffer);
+        finishTexture(texturePath, *textureData, 0, source, requestTime, mapMilliseconds);
+        return;
+    }
+
+    // The mapping stays valid until it is unmapped, so the worker writes into it without touching OpenGL
+    assetLoader->submit([this, texturePath, textureData, mapping, pixelBuffer, source, requestTime, mapMilliseconds]() -> AssetLoader::Completion {
+        std::memcpy(mapping, textureData->bytes.data(), textureData->bytes.size());
+        return [this, texturePath, textureData, pixelBuffer, source, requestTime, mapMilliseconds]() {
+            finishTexture(texturePath, *textureData, pixelBuffer, source, requestTime, mapMilliseconds);
+        };
+    });
+}
+
+// Unmaps the pixel buffer, if any, and creates the texture from it, or from the levels themselves if it could not be filled
+void ResourceCache::finishTexture(const std::string& texturePath, const TextureData& textureData, unsigned int pixelBuffer, const char* source,
+                                  std::chrono::steady_clock::time_point requestTime, double mapMilliseconds) {
+
+    auto uploadStartTime = std::chrono::steady_clock::now();
+
+    bool isFilled = false;
+    if (pixelBuffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        isFilled = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    }
+
+    auto it = textures.find(texturePath);
+    Entry<TextureResource>* entry = it != textures.end() ? &it->second : nullptr;
+    if (entry) {
+        entry->resource.pending = false;
+    }
+
+    // Each level reads the pixel buffer at its offset, unless every model released the texture while it was copied
+    bool isWanted = entry && entry->referenceCount > 0;
+    if (isWanted && isFilled) {
+        uploadTexture(textureData, nullptr, entry->resource, entry->residentBytes);
+    }
+    if (pixelBuffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // Deleting the buffer is deferred by the driver until the texture no longer needs it
+        glDeleteBuffers(1, &pixelBuffer);
+    }
+    if (isWanted && !isFilled) {
+        uploadTexture(textureData, textureData.bytes.data(), entry->resource, entry->residentBytes);
+    }
+    if (!isWanted) {
+        return;
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    std::cout << "Texture " << texturePath << ": loaded from " << source << " (" << textureFormatName(textureData.internalFormat) << ", "
+              << textureData.levels.size() << " levels, " << entry->residentBytes << " bytes resident) in "
+              << std::chrono::duration<double, std::milli>(endTime - requestTime).count() << " ms in the background (upload "
+              << mapMilliseconds + std::chrono::duration<double, std::milli>(endTime - uploadStartTime).count() << " ms)" << std::endl;
+}
+
+// Produces the levels of a texture without touching OpenGL or the cache
+bool ResourceCache::decodeTexture(const std::string& texturePath, TextureCacheMode mode, TextureCompression compression, TextureData& textureData, const char*& source, std::ostream& log) {
+
+    std::string binaryPath = binaryTexturePath(texturePath, compression);
+    source = "binary texture";
+    if (mode == TextureCacheMode::Enabled && readBinaryTexture(binaryPath, texturePath, compression, textureData)) {
+        return true;
+    }
+
+    // Freed with stb_image's allocator on every path
+    source = "stb_image";
+    int width = 0, height = 0, nrChannels = 0;
+    std::unique_ptr<unsigned char, void (*)(void*)> pixels(stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0), stbi_image_free);
+    if (!pixels) {
+        std::cerr << "Failed to load texture at " << texturePath << std::endl;
+        return false;
+    }
+    if (nrChannels != 3 && nrChannels != 4) {
+        std::cerr << "ERROR::RESOURCE_CACHE::UNSUPPORTED_CHANNELS: " << nrChannels << " in " << texturePath << std::endl;
+        return false;
+    }
+
+    // Without the cache, the image is uploaded as it is and the driver generates the mipmaps
+    if (mode == TextureCacheMode::Disabled) {
+        size_t imageBytes = static_cast<size_t>(width) * height * nrChannels;
+        textureData.internalFormat = textureData.format = nrChannels == 3 ? GL_RGB : GL_RGBA;
+        textureData.levels.assign(1, TextureLevel{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0, imageBytes });
+        textureData.bytes.assign(pixels.get(), pixels.get() + imageBytes);
+        return true;
+    }
+
+    // Build the mip chain, and compress it if asked to
+    auto cookStartTime = std::chrono::steady_clock::now();
+    cookTexture(pixels.get(), width, height, nrChannels, compression, textureData);
+    auto cookEndTime = std::chrono::steady_clock::now();
+
+    log << "Texture " << texturePath << ": cooked " << textureData.levels.size() << " levels of " << textureFormatName(textureData.internalFormat)
+        << " (" << textureData.bytes.size() << " bytes) in " << std::chrono::duration<double, std::milli>(cookEndTime - cookStartTime).count() << " ms";
+
+    // The error of the compression, measured on the full image
+    if (textureData.isCompressed()) {
+        std::vector<unsigned char> decoded(static_cast<size_t>(width) * height * 3);
+        decompressBc1(textureData.bytes.data(), width, height, decoded.data());
+        log << ", PSNR " << std::fixed << std::setprecision(1) << colorPsnr(pixels.get(), nrChannels, decoded.data(), 3, width, height) << " dB" << std::defaultfloat;
+    }
+    log << std::endl;
+
+    // Store the cooked levels, so that the next launch can skip the decoding and the cooking
+    SourceFingerprint fingerprint;
+    if (fingerprintFile(texturePath, fingerprint, true)) {
+        writeBinaryTexture(binaryPath, textureData, fingerprint);
+    }
+    return true;
+}
+
+// Produces the levels of a layer resampled to the size and channels of its texture array, from its full image
+bool ResourceCache::decodeResampledTexture(const std::string& texturePath, uint32_t width, uint32_t height, int channels, TextureCacheMode mode,
+                                           TextureCompression compression, TextureData& textureData, std::ostream& log) {
+
+    // The cached layer must have been resampled to this size, in this format
+    std::string binaryPath = resampledTexturePath(texturePath, width, height, compression);
+    if (mode == TextureCacheMode::Enabled && readBinaryTexture(binaryPath, texturePath, compression, textureData)
+        && textureData.levels[0].width == width && textureData.levels[0].height == height
+        && (textureData.isCompressed() || textureData.format == static_cast<uint32_t>(channels == 4 ? GL_RGBA : GL_RGB))) {
+        return true;
+    }
+
+    // Freed with stb_image's allocator on every path
+    int imageWidth = 0, imageHeight = 0, nrChannels = 0;
+    std::unique_ptr<unsigned char, void (*)(void*)> pixels(stbi_load(texturePath.c_str(), &imageWidth, &imageHeight, &nrChannels, 0), stbi_image_free);
+    if (!pixels) {
+        std::cerr << "Failed to load texture at " << texturePath << std::endl;
+        return false;
+    }
+    if (nrChannels != 3 && nrChannels != 4) {
+        std::cerr << "ERROR::RESOURCE_CACHE::UNSUPPORTED_CHANNELS: " << nrChannels << " in " << texturePath << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> resized;
+    resizeImage(pixels.get(), imageWidth, imageHeight, nrChannels, static_cast<int>(width), static_cast<int>(height), channels, resized);
+    log << "Texture " << texturePath << ": resampled from " << imageWidth << " x " << imageHeight << " to " << width << " x " << height
+        << " for its texture array" << std::endl;
+
+    // Without the cache, the driver generates the mipmaps of the array
+    if (mode == TextureCacheMode::Disabled) {
+        textureData.internalFormat = textureData.format = channels == 4 ? GL_RGBA : GL_RGB;
+        textureData.levels.assign(1, TextureLevel{ width, height, 0, resized.size() });
+        textureData.bytes.swap(resized);
+        return true;
+    }
+
+    // Build the mip chain of the resampled image, compress it if asked to, and store it for the next launch
+    cookTexture(resized.data(), static_cast<int>(width), static_cast<int>(height), channels, compression, textureData);
+    SourceFingerprint fingerprint;
+    if (fingerprintFile(texturePath, fingerprint, true)) {
+        writeBinaryTexture(binaryPath, textureData, fingerprint);
+    }
+    return true;
+}
+
+// Produces the levels of a texture array from the levels of its layers
+bool ResourceCache::decodeTextureArray(const std::vector<std::string>& paths, TextureCacheMode mode, TextureCompression compression, TextureData& textureData, std::ostream& log) {
+
+    if (paths.empty()) {
+        return false;
+    }
+
+    // The layers of an array share one size and format: those of the largest image, with alpha if any image has it. Only the
+    // headers of the images are read to find them
+    std::vector<int> imageWidths(paths.size()), imageHeights(paths.size()), imageChannels(paths.size());
+    uint32_t width = 0, height = 0;
+    int channels = 3;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!stbi_info(paths[i].c_str(), &imageWidths[i], &imageHeights[i], &imageChannels[i])) {
+            std::cerr << "Failed to load texture at " << paths[i] << std::endl;
+            return false;
+        }
+        width = std::max(width, static_cast<uint32_t>(imageWidths[i]));
+        height = std::max(height, static_cast<uint32_t>(imageHeights[i]));
+        channels = std::max(channels, imageChannels[i]);
+    }
+
+    // The layers of the array's size and format are cooked and cached like textures of their own. The others are resampled from
+    // their image, never from a cooked or compressed level, and cached at the array's size. BC1 drops alpha, so it ignores the channels
+    bool isCompressedArray = mode != TextureCacheMode::Disabled && compression == TextureCompression::Bc1;
+    std::vector<TextureData> layers(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        bool isArraySize = static_cast<uint32_t>(imageWidths[i]) == width && static_cast<uint32_t>(imageHeights[i]) == height;
+        bool isArrayFormat = isCompressedArray || imageChannels[i] == channels;
+        const char* source = "";
+        bool decoded = isArraySize && isArrayFormat ? decodeTexture(paths[i], mode, compression, layers[i], source, log)
+                                                    : decodeResampledTexture(paths[i], width, height, channels, mode, compression, layers[i], log);
+        if (!decoded) {
+            return false;
+        }
+    }
+    const TextureData* reference = &layers[0];
+
+    // Store the levels of every layer one after the other, as glTexImage3D() reads them
+    textureData.internalFormat = reference->internalFormat;
+    textureData.format = reference->format;
+    textureData.layerCount = static_cast<uint32_t>(layers.size());
+    textureData.levels.clear();
+    textureData.bytes.clear();
+
+    size_t totalBytes = 0;
+    for (const TextureData& layer : layers) {
+        if (layer.levels.size() != reference->levels.size() || layer.internalFormat != reference->internalFormat) {
+            std::cerr << "ERROR::RESOURCE_CACHE::MISMATCHED_LAYERS: " << paths[0] << std::endl;
+            return false;
+        }
+        totalBytes += layer.bytes.size();
+    }
+    textureData.bytes.reserve(totalBytes);
+
+    for (size_t level = 0; level < reference->levels.size(); ++level) {
+        TextureLevel arrayLevel = { reference->levels[level].width, reference->levels[level].height, textureData.bytes.size(), 0 };
+        for (const TextureData& layer : layers) {
+            const TextureLevel& layerLevel = layer.levels[level];
+            auto first = layer.bytes.begin() + layerLevel.offset;
+            textureData.bytes.insert(textureData.bytes.end(), first, first + layerLevel.bytes);
+            arrayLevel.bytes += layerLevel.bytes;
+        }
+        textureData.levels.push_back(arrayLevel);
+    }
+
+    return true;
+}
+
+// Copies the levels of a binary texture out of its mapping, which also reads the file on the calling thread rather than during the upload
+bool ResourceCache::readBinaryTexture(const std::string& binaryPath, const std::string& sourcePath, TextureCompression compression, TextureData& textureData) {
+
+    BinaryTexture binaryTexture;
+    if (!binaryTexture.open(binaryPath, sourcePath) || !isCookedAs(binaryTexture.header().internalFormat, compression)) {
+        return false;
+    }
+
+    const BinaryTextureHeader& header = binaryTexture.header();
+    textureData.internalFormat = header.internalFormat;
+    textureData.format = header.format;
+    textureData.levels = binaryTexture.levels();
+    textureData.bytes.assign(binaryTexture.levelData(), binaryTexture.levelData() + header.dataBytes);
+    return true;
+}
+
+// Creates the texture, with its parameters and every level
+void ResourceCache::uploadTexture(const TextureData& textureData, const unsigned char* bytes, TextureResource& texture, size_t& residentBytes) {
+
+    // Generate and bind texture
+    GLenum target = texture.target;
+    glGenTextures(1, &texture.texture);
+    glBindTexture(target, texture.texture);
+
+    // A cooked chain holds every level down to 1 x 1, so the texture is complete without generating any
+    const TextureLevel& baseLevel = textureData.levels[0];
+    bool generatesMipmaps = textureData.levels.size() == 1 && (baseLevel.width > 1 || baseLevel.height > 1);
+    bool hasMipmaps = generatesMipmaps || textureData.levels.size() > 1;
+
+    // Set texture parameters. Minified textures blend the two nearest levels of the chain, so that every level is actually sampled
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, hasMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (!generatesMipmaps) {
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(textureData.levels.size()) - 1);
+    }
+
+    // The rows of the levels are tightly packed, while OpenGL expects them aligned to 4 bytes by default
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Assign each level to the texture, from its offset in the bytes or in the pixel buffer
+    residentBytes = 0;
+    for (size_t i = 0; i < textureData.levels.size(); ++i) {
+        const TextureLevel& level = textureData.levels[i];
+        const void* levelBytes = reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(bytes) + static_cast<uintptr_t>(level.offset));
+        GLint levelIndex = static_cast<GLint>(i);
+        GLsizei width = static_cast<GLsizei>(level.width), height = static_cast<GLsizei>(level.height);
+        GLsizei layerCount = static_cast<GLsizei>(textureData.layerCount);
+
+        if (textureData.isCompressed()) {
+            if (target == GL_TEXTURE_2D_ARRAY) {
+                glCompressedTexImage3D(target, levelIndex, textureData.internalFormat, width, height, layerCount, 0, static_cast<GLsizei>(level.bytes), levelBytes);
+            }
+            else {
+                glCompressedTexImage2D(target, levelIndex, textureData.internalFormat, width, height, 0, static_cast<GLsizei>(level.bytes), levelBytes);
+            }
+            residentBytes += static_cast<size_t>(level.bytes);
+        }
+        else {
+            if (target == GL_TEXTURE_2D_ARRAY) {
+                glTexImage3D(target, levelIndex, static_cast<GLint>(textureData.internalFormat), width, height, layerCount, 0, textureData.format, GL_UNSIGNED_BYTE, levelBytes);
+            }
+            else {
+                glTexImage2D(target, levelIndex, static_cast<GLint>(textureData.internalFormat), width, height, 0, textureData.format, GL_UNSIGNED_BYTE, levelBytes);
+            }
+
+            // Drivers commonly store RGB images with 4 bytes per texel
+            residentBytes += static_cast<size_t>(level.width) * level.height * 4 * textureData.layerCount;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // The generated mip chain adds a third of the base level
+    if (generatesMipmaps) {
+        glGenerateMipmap(target);
+        residentBytes += residentBytes / 3;
+    }
+
+    glBindTexture(target, 0);
+}
+
+// Deletes the VAO and VBO of a mesh
+void ResourceCache::destroy(MeshResource& mesh) {
+
+    if (mesh.VAO)
+        glDeleteVertexArrays(1, &mesh.VAO);
+
+    if (mesh.VBO)
+        glDeleteBuffers(1, &mesh.VBO);
+
+    if (mesh.EBO)
+        glDeleteBuffers(1, &mesh.EBO);
+
+    mesh.VAO = mesh.VBO = mesh.EBO = 0;
+    mesh.levels.assign(1, MeshLevel{ 0, 0, 0.0f });
+    mesh.layout = VertexLayout();
+    mesh.positionOffset = glm::vec3(0.0f);
+    mesh.positionScale = glm::vec3(1.0f);
+    mesh.quantizationError = 0.0f;
+    mesh.bounds = BoundingSphere();
+}
+
+// Deletes a texture
+void ResourceCache::destroy(TextureResource& texture) {
+
+    if (texture.texture)
+        glDeleteTextures(1, &texture.texture);
+
+    texture.texture = 0;
+}
+
+// Deletes a shader program
+void ResourceCache::destroy(ProgramResource& program) {
+
+    program.shader.destroy();
+}
+
+// Prints the bookkeeping of every entry of one of the maps
+template <typename Resource>
+void ResourceCache::printEntries(std::ostream& stream, const char* kind, const std::unordered_map<std::string, Entry<Resource>>& entries) {
+
+    for (const auto& pair : entries) {
+        const Entry<Resource>& entry = pair.second;
+        stream << std::left << std::setw(9) << kind << std::setw(72) << pair.first
+               << " hits " << std::setw(8) << entry.hits
+               << " misses " << std::setw(4) << entry.misses
+               << " references " << std::setw(8) << entry.referenceCount
+               << " resident " << entry.residentBytes << " bytes" << std::endl;
+    }
+}
+
+// Prints the hit and miss counts and the resident bytes of every asset
+void ResourceCache::printReport(std::ostream& stream) const {
+
+    stream << "Resource cache:" << std::endl;
+    printEntries(stream, "mesh", meshes);
+    printEntries(stream, "texture", textures);
+    printEntries(stream, "program", programs);
+    stream << "Programs: " << programCompiles << " compiled, " << programBinaryLoads << " loaded from binaries, in " << programMilliseconds << " ms" << std::endl;
+}
+
+// Destructor: Deletes every resource that is still resident
+ResourceCache::~ResourceCache() {
+
+    for (auto& pair : meshes)
+        destroy(pair.second.resource);
+
+    for (auto& pair : textures)
+        destroy(pair.second.resource);
+
+    for (auto& pair : programs)
+        destroy(pair.second.resource);
+}
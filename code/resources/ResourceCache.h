@@ -0,0 +1,331 @@
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <glad/glad.h>
+#include <assimp/scene.h>
+#include "../mesh/MeshData.h"
+#include "../mesh/SphereGenerator.h"
+#include "../mesh/VertexLayout.h"
+#include "../shader/Material.h"
+#include "../shader/ShaderProgram.h"
+#include "../texture/TextureData.h"
+#include "AssetLoader.h"
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A mesh uploaded to the GPU, shared by every model loaded from the same file
+struct MeshResource {
+
+    // Path of the object file, used as the key of the cache
+    std::string path;
+
+    // OpenGL identifiers for Vertex Array Object, Vertex Buffer Object and Element Buffer Object
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+
+    // Levels of detail, as ranges of the element buffer drawn with glDrawElements(). Level 0 is the full mesh, and every mesh has at least one
+    std::vector<MeshLevel> levels;
+
+    // Layout of the vertices in the VBO
+    VertexLayout layout = {};
+
+    // Dequantization of packed positions, applied by the vertex shaders: position = positionOffset + stored * positionScale
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+
+    // Largest distance between the stored and the original positions, as a fraction of the radius of the bounding sphere
+    float quantizationError = 0.0f;
+
+    // Sphere enclosing the mesh, in model coordinates
+    BoundingSphere bounds;
+
+    // Set while the mesh is decoded by the asset loader. It has no GPU objects and draws nothing until it is uploaded
+    bool pending = false;
+
+};
+
+// A texture uploaded to the GPU, shared by every model using the same image, or a texture array shared by every model using the same images
+struct TextureResource {
+
+    // Path of the image, or paths of the layers' images joined by '|', used as the key of the cache
+    std::string path;
+
+    // OpenGL identifier for the texture
+    unsigned int texture = 0;
+
+    // GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY for a texture array
+    unsigned int target = GL_TEXTURE_2D;
+
+    // Number of layers of a texture array, one per image in the order of the paths. 1 for a 2D texture
+    unsigned int layerCount = 1;
+
+    // Set while the image is decoded by the asset loader. The texture is 0 until it is uploaded
+    bool pending = false;
+
+};
+
+// A linked shader program, shared by every model using the same pair of shaders
+struct ProgramResource {
+
+    // Paths of the vertex and fragment shaders, joined to form the key of the cache
+    std::string path;
+
+    // The compiled and linked shader program, with its uniform locations
+    ShaderProgram shader;
+
+};
+
+// How meshes use the binary mesh files stored next to their object files
+enum class MeshCacheMode {
+
+    // Load the binary mesh if it is up to date, otherwise import the object file and write the binary mesh
+    Enabled,
+
+    // Always import the object file and never write binary meshes
+    Disabled,
+
+    // Always import the object file and overwrite the binary mesh
+    Rebuild
+
+};
+
+// How textures use the binary texture files, holding their cooked mip chains, stored next to their images
+enum class TextureCacheMode {
+
+    // Load the binary texture if it is up to date and of the selected compression, otherwise cook the image and write the binary texture
+    Enabled,
+
+    // Always decode the image, upload it as it is and let the driver generate the mipmaps, as before the binary textures
+    Disabled,
+
+    // Always decode and cook the image, and overwrite the binary texture
+    Rebuild
+
+};
+
+// How the vertices of meshes are stored in their vertex buffers
+enum class VertexFormat {
+
+    // Eight floats per vertex: position, texture coordinates and normal (32 bytes)
+    Float,
+
+    // Quantized positions, texture coordinates and normals, in formats chosen per mesh (16 bytes)
+    Packed
+
+};
+
+// Reference-counted cache of meshes, textures and shader programs, keyed by path.
+// Each asset is imported, decoded, compiled and uploaded once, no matter how many models use it
+class ResourceCache {
+
+public:
+
+    ResourceCache() = default;
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    // Returns the mesh of the object file, loading it on the first request
+    const MeshResource* acquireMesh(const std::string& path);
+
+    // Returns the texture of the image, loading it on the first request
+    const TextureResource* acquireTexture(const std::string& path);
+
+    // Returns the texture array whose layer i is the image of paths[i], loading it on the first request. The layers take the size
+    // of the largest image, the others being resampled, so that models drawing different images bind a single texture
+    const TextureResource* acquireTextureArray(const std::vector<std::string>& paths);
+
+    // Returns the program linked from the two shaders, compiling it on the first request
+    const ProgramResource* acquireProgram(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // Returns the program of the material, compiling its permutation of the body shaders on the first request
+    const ProgramResource* acquireMaterial(Material material);
+
+    // Selects how meshes use binary mesh files. Applies to meshes loaded afterwards
+    void setMeshCacheMode(MeshCacheMode mode);
+
+    // Selects how the vertices of meshes are stored. Applies to meshes loaded afterwards
+    void setVertexFormat(VertexFormat format);
+
+    // Selects how textures use binary texture files. Applies to textures loaded afterwards
+    void setTextureCacheMode(TextureCacheMode mode);
+
+    // Selects how cooked textures are stored on the GPU. Applies to textures loaded afterwards. Requires a current OpenGL
+    // context, in which BC1 falls back to no compression when the driver lacks S3TC. Returns whether the compression is used
+    bool setTextureCompression(TextureCompression compression);
+
+    // Selects how programs use the program binaries saved in 'directory'. Applies to programs built afterwards
+    void setShaderCacheMode(ShaderCacheMode mode, const std::string& directory);
+
+    // Generates the mesh of the object file procedurally instead of loading it, without touching the file. Applies to meshes loaded afterwards
+    void defineSphere(const std::string& path, const SphereDescription& description);
+
+    // Decodes the meshes and images requested afterwards on the loader's workers instead of the calling thread. Their resources
+    // are returned pending, and are uploaded when the OpenGL thread runs the loader's completions. Null loads them at once again
+    void setAssetLoader(AssetLoader* loader);
+
+    // Drops a reference to a resource. The GPU objects are deleted when the last reference is dropped
+    void release(const MeshResource* mesh);
+    void release(const TextureResource* texture);
+    void release(const ProgramResource* program);
+
+    // Configures the vertex attributes and the element buffer of a mesh on the currently bound VAO. Used by models that need their own VAO
+    static void setupVertexAttributes(const MeshResource& mesh);
+
+    // Configures the vertex attributes of the layout, read from the vertex buffer, and the element buffer on the currently bound VAO
+    static void setupVertexAttributes(const VertexLayout& layout, unsigned int VBO, unsigned int EBO);
+
+    // Prints the hit and miss counts and the resident bytes of every asset
+    void printReport(std::ostream& stream) const;
+
+    // Destructor: Deletes every resource that is still resident
+    ~ResourceCache();
+
+private:
+
+    // A cached resource along with its bookkeeping
+    template <typename Resource>
+    struct Entry {
+
+        Resource resource;
+
+        // Number of models currently using the resource
+        unsigned int referenceCount = 0;
+
+        // Number of requests served from the cache
+        unsigned int hits = 0;
+
+        // Number of requests that had to load the resource
+        unsigned int misses = 0;
+
+        // Size of the resource in GPU memory
+        size_t residentBytes = 0;
+
+    };
+
+    // How meshes use binary mesh files
+    MeshCacheMode meshCacheMode = MeshCacheMode::Enabled;
+
+    // How the vertices of meshes are stored
+    VertexFormat vertexFormat = VertexFormat::Float;
+
+    // How textures use binary texture files
+    TextureCacheMode textureCacheMode = TextureCacheMode::Enabled;
+
+    // How cooked textures are stored on the GPU
+    TextureCompression textureCompression = TextureCompression::None;
+
+    // Binaries of the linked programs, and the number of programs compiled and loaded from binaries with the time spent building them
+    ProgramBinaryCache programBinaries;
+    unsigned int programCompiles = 0;
+    unsigned int programBinaryLoads = 0;
+    double programMilliseconds = 0.0;
+
+    // Procedural spheres standing in for object files, keyed by the path of the object file
+    std::unordered_map<std::string, SphereDescription> spheres;
+
+    // Loader decoding the assets in the background, if any
+    AssetLoader* assetLoader = nullptr;
+
+    std::unordered_map<std::string, Entry<MeshResource>> meshes;
+    std::unordered_map<std::string, Entry<TextureResource>> textures;
+    std::unordered_map<std::string, Entry<ProgramResource>> programs;
+
+    // Builds a program from its shaders, or from its binary if the program binary cache has it
+    void buildProgram(ProgramResource& program, const std::string& vertexPath, const std::string& fragmentPath, const std::string& preamble);
+
+    // Generates the mesh if it is a procedural sphere, otherwise loads it from its binary mesh file if possible, or from the object file
+    bool loadModel(const std::string& path, MeshResource& mesh, size_t& residentBytes);
+
+    // Decodes the mesh on a worker of the asset loader, then uploads it on the OpenGL thread
+    void loadModelAsync(const std::string& path, MeshResource& mesh);
+
+    // Uploads a mesh decoded by the asset loader, unless every model released it in the meantime
+    void finishModel(const std::string& path, const MeshData* meshData, const char* source, std::chrono::steady_clock::time_point requestTime);
+
+    // Produces the data of a mesh without OpenGL, so on any thread: generates the sphere if there is one, otherwise reads the binary
+    // mesh file if the mode allows it and it is up to date, or imports the object file and writes the binary mesh
+    static bool decodeModel(const std::string& path, const SphereDescription* sphere, MeshCacheMode mode, MeshData& meshData, const char*& source, std::ostream& log);
+
+    // Copies an up-to-date binary mesh file of MeshData's layout into memory
+    static bool readBinaryMesh(const std::string& binaryPath, const std::string& sourcePath, MeshData& meshData);
+
+    // Uploads a mesh held in memory, in the layout of MeshData
+    void uploadMeshData(const MeshData& meshData, MeshResource& mesh, size_t& residentBytes);
+
+    // Uploads vertices in the layout of MeshData, packed first if packed vertices are selected, and 32-bit indices. The mesh's bounds must be set
+    void uploadVertices(const float* vertices, unsigned int vertexCount, const void* indices, size_t indexBytes, MeshResource& mesh, size_t& residentBytes);
+
+    // Prints the triangles and the error of each level of detail of a mesh
+    static void printLevels(std::ostream& stream, const std::string& path, const MeshData& meshData);
+
+    // Maps an up-to-date binary mesh file and uploads it straight from the mapping
+    bool loadBinaryMesh(const std::string& binaryPath, const std::string& sourcePath, MeshResource& mesh, size_t& residentBytes);
+
+    // Imports the object file using Assimp, optimizes its first mesh and builds its levels of detail, printing the statistics to 'log'
+    static bool importModel(const std::string& path, MeshData& meshData, std::ostream& log);
+
+    // Processes the mesh and stores vertices, texture coordinates, normals and the triangles' indices
+    static void processMesh(aiMesh* mesh, MeshData& meshData);
+
+    // Sets up the VAO, VBO and EBO for the mesh, from vertices in the mesh's layout and 32-bit indices
+    void setupBuffers(const void* vertices, size_t vertexBytes, const void* indices, size_t indexBytes, MeshResource& mesh);
+
+    // Loads a texture from its binary texture file if possible, or from the image
+    bool loadTexture(const std::string& texturePath, TextureResource& texture, size_t& residentBytes);
+
+    // Loads every layer of a texture array like a texture, then uploads them together
+    bool loadTextureArray(const std::vector<std::string>& paths, TextureResource& texture, size_t& residentBytes);
+
+    // Decodes the texture, or the layers of the texture array, on a worker of the asset loader, then uploads it on the OpenGL thread
+    void loadTextureAsync(const std::vector<std::string>& paths, TextureResource& texture);
+
+    // Maps a pixel buffer object for a texture decoded by the asset loader, and has a worker copy its levels into the mapping,
+    // unless every model released it in the meantime
+    void mapTexture(const std::string& texturePath, std::shared_ptr<TextureData> textureData, const char* source, std::chrono::steady_clock::time_point requestTime);
+
+    // Unmaps the filled pixel buffer and creates the texture from it, or from the levels in memory when 'pixelBuffer' is 0 or could
+    // not be filled, then deletes the buffer. 'mapMilliseconds' is the time mapTexture() spent on the OpenGL thread, for the log
+    void finishTexture(const std::string& texturePath, const TextureData& textureData, unsigned int pixelBuffer, const char* source,
+                       std::chrono::steady_clock::time_point requestTime, double mapMilliseconds);
+
+    // Produces the levels of a texture without OpenGL, so on any thread: reads the binary texture if the mode allows it and it is
+    // up to date, otherwise decodes the image and, unless the cache is disabled, cooks it and writes the binary texture
+    static bool decodeTexture(const std::string& texturePath, TextureCacheMode mode, TextureCompression compression, TextureData& textureData, const char*& source, std::ostream& log);
+
+    // Produces the levels of a layer of a texture array resampled to 'width' x 'height' and 'channels': reads its binary texture,
+    // cached under that size, if the mode allows it and it is up to date, otherwise resamples the decoded image and, unless the cache
+    // is disabled, cooks it and writes the binary texture
+    static bool decodeResampledTexture(const std::string& texturePath, uint32_t width, uint32_t height, int channels, TextureCacheMode mode,
+                                       TextureCompression compression, TextureData& textureData, std::ostream& log);
+
+    // Produces the levels of a texture array: decodes every layer like a texture, except the layers that differ from the largest
+    // one in size or format, which are resampled, and stores the levels of every layer one after the other
+    static bool decodeTextureArray(const std::vector<std::string>& paths, TextureCacheMode mode, TextureCompression compression, TextureData& textureData, std::ostream& log);
+
+    // Copies an up-to-date binary texture file of the given compression into memory
+    static bool readBinaryTexture(const std::string& binaryPath, const std::string& sourcePath, TextureCompression compression, TextureData& textureData);
+
+    // Creates the texture, of the resource's target, from the levels of 'textureData' stored at 'bytes', or in the bound pixel unpack
+    // buffer when 'bytes' is null. A single level larger than 1 x 1 gets its mipmaps from glGenerateMipmap()
+    static void uploadTexture(const TextureData& textureData, const unsigned char* bytes, TextureResource& texture, size_t& residentBytes);
+
+    // Deletes the GPU objects of a resource
+    static void destroy(MeshResource& mesh);
+    static void destroy(TextureResource& texture);
+    static void destroy(ProgramResource& program);
+
+    // Prints the bookkeeping of every entry of one of the maps
+    template <typename Resource>
+    static void printEntries(std::ostream& stream, const char* kind, const std::unordered_map<std::string, Entry<Resource>>& entries);
+
+    // Drops a reference to an entry of one of the maps, destroying it with the last reference
+    template <typename Resource>
+    static void releaseEntry(std::unordered_map<std::string, Entry<Resource>>& entries, const Resource* resource);
+
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "BatchTransform.h"
+#include "../math/SimdTrigonometry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#ifdef SIMD_TRIGONOMETRY_SSE
+#define BATCH_TRANSFORM_SSE
+#endif
+
+// The AVX2 kernel is compiled for AVX2 and FMA whatever the target, and only called when the processor supports them
+#if defined(BATCH_TRANSFORM_SSE) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_TRANSFORM_AVX2
+#define BATCH_TRANSFORM_AVX2_TARGET __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Number of floats from one body's transform to the next
+const size_t transformStride = sizeof(BodyTransform) / sizeof(float);
+
+// Places one body with std::sin() and std::cos(), as every kernel does for the bodies left over by its vectors
+void transformScalar(const TransformBatch& batch, size_t i, BodyTransform& transform) {
+
+    float x = batch.axisX[i], y = batch.axisY[i], z = batch.axisZ[i];
+    float sine = std::sin(batch.angle[i]);
+    float cosine = std::cos(batch.angle[i]);
+    float t = 1.0f - cosine;
+
+    // Columns of the rotation, as built by glm::rotate()
+    glm::vec3 rotation[3] = {
+        glm::vec3(t * x * x + cosine, t * x * y + sine * z, t * x * z - sine * y),
+        glm::vec3(t * x * y - sine * z, t * y * y + cosine, t * y * z + sine * x),
+        glm::vec3(t * x * z + sine * y, t * y * z - sine * x, t * z * z + cosine)
+    };
+    float scale[3] = { batch.scaleX[i], batch.scaleY[i], batch.scaleZ[i] };
+
+    // The model matrix scales the columns of the rotation, and its inverse transpose divides them by the same scales
+    for (int column = 0; column < 3; ++column) {
+        transform.model[column] = glm::vec4(rotation[column] * scale[column], 0.0f);
+        transform.normal[column] = glm::vec4(rotation[column] / scale[column], 0.0f);
+    }
+    transform.model[3] = glm::vec4(batch.positionX[i], batch.positionY[i], batch.positionZ[i], 1.0f);
+}
+
+#ifdef BATCH_TRANSFORM_SSE
+
+// Transposes the x, y, z and w of 4 bodies into one vec4 per body, stored at 'first' in the first body's transform and at the same
+// place in the next 3
+inline void storeTransposed(float* first, __m128 x, __m128 y, __m128 z, __m128 w) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(first, x);
+    _mm_storeu_ps(first + transformStride, y);
+    _mm_storeu_ps(first + 2 * transformStride, z);
+    _mm_storeu_ps(first + 3 * transformStride, w);
+}
+
+// Places the 4 bodies from 'i'
+void transformBlockSse(const TransformBatch& batch, size_t i, BodyTransform* transforms) {
+
+    __m128 x = _mm_loadu_ps(batch.axisX.data() + i);
+    __m128 y = _mm_loadu_ps(batch.axisY.data() + i);
+    __m128 z = _mm_loadu_ps(batch.axisZ.data() + i);
+    __m128 sine, cosine;
+    sinCosSse(_mm_loadu_ps(batch.angle.data() + i), sine, cosine);
+
+    __m128 t = _mm_sub_ps(_mm_set1_ps(1.0f), cosine);
+    __m128 tx = _mm_mul_ps(t, x), ty = _mm_mul_ps(t, y), tz = _mm_mul_ps(t, z);
+    __m128 sx = _mm_mul_ps(sine, x), sy = _mm_mul_ps(sine, y), sz = _mm_mul_ps(sine, z);
+
+    // Columns of the rotation, as built by glm::rotate()
+    __m128 r00 = _mm_add_ps(_mm_mul_ps(tx, x), cosine), r10 = _mm_add_ps(_mm_mul_ps(tx, y), sz), r20 = _mm_sub_ps(_mm_mul_ps(tx, z), sy);
+    __m128 r01 = _mm_sub_ps(_mm_mul_ps(tx, y), sz), r11 = _mm_add_ps(_mm_mul_ps(ty, y), cosine), r21 = _mm_add_ps(_mm_mul_ps(ty, z), sx);
+    __m128 r02 = _mm_add_ps(_mm_mul_ps(tx, z), sy), r12 = _mm_sub_ps(_mm_mul_ps(ty, z), sx), r22 = _mm_add_ps(_mm_mul_ps(tz, z), cosine);
+
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 zero = _mm_setzero_ps();
+    __m128 scale0 = _mm_loadu_ps(batch.scaleX.data() + i);
+    __m128 scale1 = _mm_loadu_ps(batch.scaleY.data() + i);
+    __m128 scale2 = _mm_loadu_ps(batch.scaleZ.data() + i);
+    __m128 inverse0 = _mm_div_ps(one, scale0), inverse1 = _mm_div_ps(one, scale1), inverse2 = _mm_div_ps(one, scale2);
+
+    // The model matrix scales the columns of the rotation, and its inverse transpose divides them by the same scales
+    float* first = &transforms[i].model[0][0];
+    storeTransposed(first, _mm_mul_ps(r00, scale0), _mm_mul_ps(r10, scale0), _mm_mul_ps(r20, scale0), zero);
+    storeTransposed(first + 4, _mm_mul_ps(r01, scale1), _mm_mul_ps(r11, scale1), _mm_mul_ps(r21, scale1), zero);
+    storeTransposed(first + 8, _mm_mul_ps(r02, scale2), _mm_mul_ps(r12, scale2), _mm_mul_ps(r22, scale2), zero);
+    storeTransposed(first + 12, _mm_loadu_ps(batch.positionX.data() + i), _mm_loadu_ps(batch.positionY.data() + i), _mm_loadu_ps(batch.positionZ.data() + i), one);
+    storeTransposed(first + 16, _mm_mul_ps(r00, inverse0), _mm_mul_ps(r10, inverse0), _mm_mul_ps(r20, inverse0), zero);
+    storeTransposed(first + 20, _mm_mul_ps(r01, inverse1), _mm_mul_ps(r11, inverse1), _mm_mul_ps(r21, inverse1), zero);
+    storeTransposed(first + 24, _mm_mul_ps(r02, inverse2), _mm_mul_ps(r12, inverse2), _mm_mul_ps(r22, inverse2), zero);
+}
+
+#endif
+
+#ifdef BATCH_TRANSFORM_AVX2
+
+// Stores the x, y, z and w of 8 bodies as one vec4 per body, 4 bodies per half of the vectors
+BATCH_TRANSFORM_AVX2_TARGET inline void storeTransposedAvx2(float* first, __m256 x, __m256 y, __m256 z, __m256 w) {
+    storeTransposed(first, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(w));
+    storeTransposed(first + 4 * transformStride, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1));
+}
+
+// Sine and cosine of 8 angles, as sinCosSse() of SimdTrigonometry.h
+BATCH_TRANSFORM_AVX2_TARGET void sinCosAvx2(__m256 angle, __m256& sine, __m256& cosine) {
+
+    __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(angle, _mm256_set1_ps(sinCosTwoOverPi)));
+    __m256 j = _mm256_cvtepi32_ps(quadrant);
+    __m256 y = _mm256_fnmadd_ps(j, _mm256_set1_ps(sinCosHalfPi1), angle);
+    y = _mm256_fnmadd_ps(j, _mm256_set1_ps(sinCosHalfPi2), y);
+    y = _mm256_fnmadd_ps(j, _mm256_set1_ps(sinCosHalfPi3), y);
+    __m256 y2 = _mm256_mul_ps(y, y);
+
+    __m256 sineY = _mm256_fmadd_ps(_mm256_set1_ps(sinCosSine3), y2, _mm256_set1_ps(sinCosSine2));
+    sineY = _mm256_fmadd_ps(sineY, y2, _mm256_set1_ps(sinCosSine1));
+    sineY = _mm256_fmadd_ps(_mm256_mul_ps(sineY, y2), y, y);
+
+    __m256 cosineY = _mm256_fmadd_ps(_mm256_set1_ps(sinCosCosine3), y2, _mm256_set1_ps(sinCosCosine2));
+    cosineY = _mm256_fmadd_ps(cosineY, y2, _mm256_set1_ps(sinCosCosine1));
+    cosineY = _mm256_mul_ps(_mm256_mul_ps(cosineY, y2), y2);
+    cosineY = _mm256_add_ps(_mm256_fnmadd_ps(y2, _mm256_set1_ps(0.5f), cosineY), _mm256_set1_ps(1.0f));
+
+    // Odd quadrants swap the sine and the cosine. Quadrants 2 and 3 negate the sine, 1 and 2 the cosine
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    __m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+    __m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+    sine = _mm256_xor_ps(_mm256_blendv_ps(sineY, cosineY, swap), sineSign);
+    cosine = _mm256_xor_ps(_mm256_blendv_ps(cosineY, sineY, swap), cosineSign);
+}
+
+// Places the 8 bodies from 'i', as transformBlockSse()
+BATCH_TRANSFORM_AVX2_TARGET void transformBlockAvx2(const TransformBatch& batch, size_t i, BodyTransform* transforms) {
+
+    __m256 x = _mm256_loadu_ps(batch.axisX.data() + i);
+    __m256 y = _mm256_loadu_ps(batch.axisY.data() + i);
+    __m256 z = _mm256_loadu_ps(batch.axisZ.data() + i);
+    __m256 sine, cosine;
+    sinCosAvx2(_mm256_loadu_ps(batch.angle.data() + i), sine, cosine);
+
+    __m256 t = _mm256_sub_ps(_mm256_set1_ps(1.0f), cosine);
+    __m256 tx = _mm256_mul_ps(t, x), ty = _mm256_mul_ps(t, y), tz = _mm256_mul_ps(t, z);
+    __m256 sx = _mm256_mul_ps(sine, x), sy = _mm256_mul_ps(sine, y), sz = _mm256_mul_ps(sine, z);
+
+    // Columns of the rotation, as built by glm::rotate()
+    __m256 r00 = _mm256_fmadd_ps(tx, x, cosine), r10 = _mm256_fmadd_ps(tx, y, sz), r20 = _mm256_fmsub_ps(tx, z, sy);
+    __m256 r01 = _mm256_fmsub_ps(tx, y, sz), r11 = _mm256_fmadd_ps(ty, y, cosine), r21 = _mm256_fmadd_ps(ty, z, sx);
+    __m256 r02 = _mm256_fmadd_ps(tx, z, sy), r12 = _mm256_fmsub_ps(ty, z, sx), r22 = _mm256_fmadd_ps(tz, z, cosine);
+
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 scale0 = _mm256_loadu_ps(batch.scaleX.data() + i);
+    __m256 scale1 = _mm256_loadu_ps(batch.scaleY.data() + i);
+    __m256 scale2 = _mm256_loadu_ps(batch.scaleZ.data() + i);
+    __m256 inverse0 = _mm256_div_ps(one, scale0), inverse1 = _mm256_div_ps(one, scale1), inverse2 = _mm256_div_ps(one, scale2);
+
+    float* first = &transforms[i].model[0][0];
+    storeTransposedAvx2(first, _mm256_mul_ps(r00, scale0), _mm256_mul_ps(r10, scale0), _mm256_mul_ps(r20, scale0), zero);
+    storeTransposedAvx2(first + 4, _mm256_mul_ps(r01, scale1), _mm256_mul_ps(r11, scale1), _mm256_mul_ps(r21, scale1), zero);
+    storeTransposedAvx2(first + 8, _mm256_mul_ps(r02, scale2), _mm256_mul_ps(r12, scale2), _mm256_mul_ps(r22, scale2), zero);
+    storeTransposedAvx2(first + 12, _mm256_loadu_ps(batch.positionX.data() + i), _mm256_loadu_ps(batch.positionY.data() + i), _mm256_loadu_ps(batch.positionZ.data() + i), one);
+    storeTransposedAvx2(first + 16, _mm256_mul_ps(r00, inverse0), _mm256_mul_ps(r10, inverse0), _mm256_mul_ps(r20, inverse0), zero);
+    storeTransposedAvx2(first + 20, _mm256_mul_ps(r01, inverse1), _mm256_mul_ps(r11, inverse1), _mm256_mul_ps(r21, inverse1), zero);
+    storeTransposedAvx2(first + 24, _mm256_mul_ps(r02, inverse2), _mm256_mul_ps(r12, inverse2), _mm256_mul_ps(r22, inverse2), zero);
+}
+
+#endif
+
+}
+
+// Number of bodies
+size_t TransformBatch::size() const {
+    return angle.size();
+}
+
+// Resizes every array, adding identity placements
+void TransformBatch::resize(size_t count) {
+    positionX.resize(count, 0.0f);
+    positionY.resize(count, 0.0f);
+    positionZ.resize(count, 0.0f);
+    axisX.resize(count, 0.0f);
+    axisY.resize(count, 1.0f);
+    axisZ.resize(count, 0.0f);
+    angle.resize(count, 0.0f);
+    scaleX.resize(count, 1.0f);
+    scaleY.resize(count, 1.0f);
+    scaleZ.resize(count, 1.0f);
+}
+
+// Sets the placement of a body, with a normalized axis
+void TransformBatch::set(size_t body, const glm::vec3& position, const glm::vec3& axis, float bodyAngle, const glm::vec3& scale) {
+    glm::vec3 unitAxis = glm::normalize(axis);
+    positionX[body] = position.x;
+    positionY[body] = position.y;
+    positionZ[body] = position.z;
+    axisX[body] = unitAxis.x;
+    axisY[body] = unitAxis.y;
+    axisZ[body] = unitAxis.z;
+    angle[body] = bodyAngle;
+    scaleX[body] = scale.x;
+    scaleY[body] = scale.y;
+    scaleZ[body] = scale.z;
+}
+
+// Normal matrix without its padding
+glm::mat3 BodyTransform::normalMatrix() const {
+    return glm::mat3(glm::vec3(normal[0]), glm::vec3(normal[1]), glm::vec3(normal[2]));
+}
+
+// Whether the kernel was compiled, and for AVX2 whether the processor and the operating system support AVX2 and FMA
+bool isTransformKernelSupported(TransformKernel kernel) {
+    switch (kernel) {
+        case TransformKernel::Scalar:
+            return true;
+        case TransformKernel::Sse:
+#ifdef BATCH_TRANSFORM_SSE
+            return true;
+#else
+            return false;
+#endif
+        case TransformKernel::Avx2:
+#ifdef BATCH_TRANSFORM_AVX2
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// Fastest supported kernel, detected on the first call
+TransformKernel fastestTransformKernel() {
+    static const TransformKernel fastest = isTransformKernelSupported(TransformKernel::Avx2) ? TransformKernel::Avx2
+        : isTransformKernelSupported(TransformKernel::Sse) ? TransformKernel::Sse : TransformKernel::Scalar;
+    return fastest;
+}
+
+// Name of a kernel
+const char* transformKernelName(TransformKernel kernel) {
+    switch (kernel) {
+        case TransformKernel::Scalar: return "scalar";
+        case TransformKernel::Sse: return "SSE2";
+        case TransformKernel::Avx2: return "AVX2";
+    }
+    return "unknown";
+}
+
+// Places the bodies a vector at a time with the requested kernel, or the fastest one if it is not supported. The vector kernels place the
+// bodies left over in one padded vector of 4, and the scalar kernel places every body one at a time
+void computeBatchTransforms(const TransformBatch& batch, std::vector<BodyTransform>& transforms, TransformKernel kernel) {
+
+    size_t count = batch.size();
+    transforms.resize(count);
+    if (!isTransformKernelSupported(kernel)) {
+        kernel = fastestTransformKernel();
+    }
+
+    size_t i = 0;
+#ifdef BATCH_TRANSFORM_AVX2
+    if (kernel == TransformKernel::Avx2) {
+        for (; i + 8 <= count; i += 8) {
+            transformBlockAvx2(batch, i, transforms.data());
+        }
+    }
+#endif
+#ifdef BATCH_TRANSFORM_SSE
+    if (kernel != TransformKernel::Scalar) {
+        for (; i + 4 <= count; i += 4) {
+            transformBlockSse(batch, i, transforms.data());
+        }
+
+        // The bodies left over are copied into a vector padded with identity placements, so that small batches such as the Sun,
+        // Earth and Moon of every frame are vectorized too. The padding is kept between calls, so that it is not reallocated
+        if (i < count) {
+            thread_local TransformBatch tail;
+            tail.resize(4);
+            for (size_t j = 0; j < 4; ++j) {
+                size_t body = i + j;
+                bool isPadding = body >= count;
+                tail.positionX[j] = isPadding ? 0.0f : batch.positionX[body];
+                tail.positionY[j] = isPadding ? 0.0f : batch.positionY[body];
+                tail.positionZ[j] = isPadding ? 0.0f : batch.positionZ[body];
+                tail.axisX[j] = isPadding ? 0.0f : batch.axisX[body];
+                tail.axisY[j] = isPadding ? 1.0f : batch.axisY[body];
+                tail.axisZ[j] = isPadding ? 0.0f : batch.axisZ[body];
+                tail.angle[j] = isPadding ? 0.0f : batch.angle[body];
+                tail.scaleX[j] = isPadding ? 1.0f : batch.scaleX[body];
+                tail.scaleY[j] = isPadding ? 1.0f : batch.scaleY[body];
+                tail.scaleZ[j] = isPadding ? 1.0f : batch.scaleZ[body];
+            }
+            BodyTransform tailTransforms[4];
+            transformBlockSse(tail, 0, tailTransforms);
+            std::copy(tailTransforms, tailTransforms + (count - i), transforms.begin() + static_cast<std::ptrdiff_t>(i));
+            i = count;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        transformScalar(batch, i, transforms[i]);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Placements of a batch of bodies as a structure of arrays: the position, a rotation of 'angle' radians about a unit axis,
+// and a scale along each model axis. Each body is placed by translate(position) * rotate(angle, axis) * scale(scale)
+struct TransformBatch {
+
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> axisX, axisY, axisZ;
+    std::vector<float> angle;
+    std::vector<float> scaleX, scaleY, scaleZ;
+
+    // Number of bodies
+    size_t size() const;
+
+    // Sets the number of bodies, adding bodies placed at the origin without rotation or scale
+    void resize(size_t count);
+
+    // Sets the placement of a body. The axis is normalized here, so that the kernels can assume unit axes
+    void set(size_t body, const glm::vec3& position, const glm::vec3& axis, float angle, const glm::vec3& scale);
+
+};
+
+// Model and normal matrices of one body, laid out as a mat4 followed by a mat3 in a std430 or std140 block, where each column of the mat3
+// is padded to a vec4
+struct BodyTransform {
+
+    // Model matrix, transforming model coordinates to world coordinates
+    glm::mat4 model;
+
+    // Normal matrix, the inverse transpose of the model matrix's upper 3x3, in the xyz of each column
+    glm::vec4 normal[3];
+
+    // Normal matrix without its padding, for glUniformMatrix3fv()
+    glm::mat3 normalMatrix() const;
+
+};
+
+// Implementations of computeBatchTransforms(), from the slowest
+enum class TransformKernel {
+
+    // One body at a time, with std::sin() and std::cos()
+    Scalar,
+
+    // 4 bodies at once with SSE2
+    Sse,
+
+    // 8 bodies at once with AVX2 and FMA, when the processor supports them
+    Avx2
+
+};
+
+// Whether the compiler built the kernel and the processor running it supports it
+bool isTransformKernelSupported(TransformKernel kernel);
+
+// Fastest supported kernel, detected once
+TransformKernel fastestTransformKernel();
+
+// Name of a kernel, for reports
+const char* transformKernelName(TransformKernel kernel);
+
+// Computes the model and normal matrices of every body of the batch into 'transforms', resized to the batch. The sine and cosine of
+// the SIMD kernels are polynomials accurate to about 1e-7 for angles within a few thousand radians, so animated angles should be wrapped
+void computeBatchTransforms(const TransformBatch& batch, std::vector<BodyTransform>& transforms, TransformKernel kernel = fastestTransformKernel());
+
+#endif
@@ -0,0 +1,73 @@
+#include "SceneGraph.h"
+#include <iostream>
+
+// Adds a node under 'parent'. As the parent already exists, the new node comes after it
+uint32_t SceneGraph::addNode(uint32_t parent, const glm::mat4& localMatrix) {
+
+    uint32_t node = static_cast<uint32_t>(parents.size());
+    if (parent != noParent && parent >= node) {
+        std::cerr << "ERROR::SCENE_GRAPH::INVALID_PARENT: " << parent << " for node " << node << ", added as a root" << std::endl;
+        parent = noParent;
+    }
+    parents.push_back(parent);
+    localMatrices.push_back(localMatrix);
+    worldMatrices.push_back(localMatrix);
+    dirty.push_back(1);
+    changed.push_back(0);
+    return node;
+}
+
+// Sets the transform of a node relative to its parent
+void SceneGraph::setLocalMatrix(uint32_t node, const glm::mat4& localMatrix) {
+    if (localMatrices[node] != localMatrix) {
+        localMatrices[node] = localMatrix;
+        dirty[node] = 1;
+    }
+}
+
+// Recomputes the world matrices in one pass, parents first
+size_t SceneGraph::updateWorldMatrices() {
+
+    size_t count = parents.size();
+    size_t recomputed = 0;
+    for (size_t node = 0; node < count; ++node) {
+
+        uint32_t parent = parents[node];
+        bool parentChanged = parent != noParent && changed[parent];
+        if (dirty[node] || parentChanged) {
+            worldMatrices[node] = parent == noParent ? localMatrices[node] : worldMatrices[parent] * localMatrices[node];
+            changed[node] = 1;
+            ++recomputed;
+        }
+        else {
+            changed[node] = 0;
+        }
+        dirty[node] = 0;
+    }
+    return recomputed;
+}
+
+const glm::mat4& SceneGraph::localMatrix(uint32_t node) const {
+    return localMatrices[node];
+}
+
+const glm::mat4& SceneGraph::worldMatrix(uint32_t node) const {
+    return worldMatrices[node];
+}
+
+uint32_t SceneGraph::parent(uint32_t node) const {
+    return parents[node];
+}
+
+size_t SceneGraph::nodeCount() const {
+    return parents.size();
+}
+
+// Reserves memory for 'count' nodes
+void SceneGraph::reserve(size_t count) {
+    parents.reserve(count);
+    localMatrices.reserve(count);
+    worldMatrices.reserve(count);
+    dirty.reserve(count);
+    changed.reserve(count);
+}
@@ -0,0 +1,53 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Hierarchy of transforms in flat arrays. A node is an index; its parent always has a smaller index, so the arrays
+// are in topological order and one pass from the front updates every world matrix after its parent's.
+// Only nodes whose local matrix changed, or whose ancestors' did, have their world matrix recomputed
+class SceneGraph {
+
+public:
+
+    // Index of the parent of root nodes
+    static const uint32_t noParent = 0xffffffffu;
+
+    // Adds a node under 'parent' (or as a root with noParent) and returns its index
+    uint32_t addNode(uint32_t parent, const glm::mat4& localMatrix = glm::mat4(1.0f));
+
+    // Sets the transform of a node relative to its parent. Marks it dirty only if the matrix actually changed
+    void setLocalMatrix(uint32_t node, const glm::mat4& localMatrix);
+
+    // Recomputes the world matrix of every dirty node and of every node below one. Returns the number of recomputed nodes
+    size_t updateWorldMatrices();
+
+    // Transform of a node relative to its parent, and relative to the world as of the last update
+    const glm::mat4& localMatrix(uint32_t node) const;
+    const glm::mat4& worldMatrix(uint32_t node) const;
+
+    // Parent of a node, or noParent
+    uint32_t parent(uint32_t node) const;
+
+    // Number of nodes
+    size_t nodeCount() const;
+
+    // Reserves memory for 'count' nodes
+    void reserve(size_t count);
+
+private:
+
+    // One entry per node, in topological order
+    std::vector<uint32_t> parents;
+    std::vector<glm::mat4> localMatrices;
+    std::vector<glm::mat4> worldMatrices;
+
+    // Whether the local matrix changed since the last update, and whether the world matrix changed in the last update
+    std::vector<uint8_t> dirty;
+    std::vector<uint8_t> changed;
+
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "SceneGraphBenchmark.h"
+#include "SceneGraph.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Time spent repeating each measurement, in seconds
+const double benchmarkDuration = 0.25;
+
+// Shapes of the benchmarked hierarchies
+enum class Shape { Deep, Wide, Balanced };
+
+// Small rigid motion, so that matrices stay well-conditioned along a chain of any length
+glm::mat4 nodeMatrix(float angle) {
+    return glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.01f, 0.0f, 0.0f)), angle, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+void buildHierarchy(SceneGraph& graph, Shape shape, size_t nodeCount) {
+
+    graph.reserve(nodeCount);
+    graph.addNode(SceneGraph::noParent, nodeMatrix(0.0f));
+    for (size_t node = 1; node < nodeCount; ++node) {
+        uint32_t parent = 0;
+        if (shape == Shape::Deep) {
+            parent = static_cast<uint32_t>(node - 1);
+        }
+        else if (shape == Shape::Balanced) {
+            parent = static_cast<uint32_t>((node - 1) / 8);
+        }
+        graph.addNode(parent, nodeMatrix(0.001f * static_cast<float>(node % 100)));
+    }
+    graph.updateWorldMatrices();
+}
+
+// Repeats 'change' then an update until 'benchmarkDuration' has passed, and prints the average time of an update
+template <typename Change>
+void measure(SceneGraph& graph, const char* shapeName, const char* caseName, Change change, std::ostream& stream) {
+
+    unsigned int updates = 0;
+    size_t recomputed = 0;
+    double updateSeconds = 0.0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < benchmarkDuration || updates < 3) {
+
+        // Only the update is timed, not the change
+        change(updates);
+        std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+        recomputed = graph.updateWorldMatrices();
+        updateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+        ++updates;
+    }
+
+    stream << std::fixed << std::setprecision(3)
+           << "  " << std::left << std::setw(9) << shapeName << std::setw(12) << caseName << std::right
+           << updateSeconds * 1000.0 / updates << " ms per update, "
+           << recomputed << " world matrices recomputed, "
+           << updateSeconds * 1.0e9 / updates / static_cast<double>(graph.nodeCount()) << " ns per node"
+           << std::defaultfloat << std::endl;
+}
+
+}
+
+// Times the updates of every shape of hierarchy
+void runSceneGraphBenchmark(size_t nodeCount, std::ostream& stream) {
+
+    stream << "Scene graph: " << nodeCount << " nodes" << std::endl;
+
+    const Shape shapes[] = { Shape::Deep, Shape::Wide, Shape::Balanced };
+    const char* shapeNames[] = { "deep", "wide", "balanced" };
+    for (int i = 0; i < 3; ++i) {
+
+        SceneGraph graph;
+        buildHierarchy(graph, shapes[i], nodeCount);
+
+        // The same random 1 % of the nodes every time, so that every run changes the same nodes
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<uint32_t> anyNode(0, static_cast<uint32_t>(nodeCount - 1));
+        std::vector<uint32_t> someNodes(std::max<size_t>(nodeCount / 100, 1));
+        for (uint32_t& node : someNodes) {
+            node = anyNode(generator);
+        }
+
+        // Changing the root recomputes every node, as a renderer without dirty flags would every frame
+        measure(graph, shapeNames[i], "root", [&](unsigned int update) {
+            graph.setLocalMatrix(0, nodeMatrix(0.001f * static_cast<float>(update % 2 + 1)));
+        }, stream);
+        measure(graph, shapeNames[i], "1% nodes", [&](unsigned int update) {
+            for (uint32_t node : someNodes) {
+                graph.setLocalMatrix(node, nodeMatrix(0.001f * static_cast<float>(update % 2 + 1)));
+            }
+        }, stream);
+        measure(graph, shapeNames[i], "nothing", [](unsigned int) {}, stream);
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef SCENE_GRAPH_BENCHMARK_H
+#define SCENE_GRAPH_BENCHMARK_H
+
+#include <cstddef>
+#include <ostream>
+
+// Times SceneGraph::updateWorldMatrices() on deep (a single chain), wide (one root with every other node as its child)
+// and balanced (8 children per node) hierarchies of 'nodeCount' nodes, after changing the root, 1 % of the nodes, or nothing
+void runSceneGraphBenchmark(size_t nodeCount, std::ostream& stream);
+
+#endif
@@ -0,0 +1,117 @@
+#include "TransformBenchmark.h"
+#include "BatchTransform.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+namespace {
+
+// Time spent repeating each measurement, in seconds
+const double benchmarkDuration = 0.25;
+
+// Random placements within the extent of the scene, with angles of a few turns
+void randomBatch(TransformBatch& batch, size_t count) {
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.03f, 0.2f);
+    batch.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 position(12.0f * unit(generator), 12.0f * unit(generator), 12.0f * unit(generator));
+        glm::vec3 axis(unit(generator), unit(generator), unit(generator));
+        if (glm::length(axis) < 0.01f) {
+            axis = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        batch.set(i, position, axis, 20.0f * unit(generator), glm::vec3(scale(generator), scale(generator), scale(generator)));
+    }
+}
+
+// Places every body one at a time as the models did, and computes the normal matrix the shaders computed for each vertex
+void transformWithGlm(const TransformBatch& batch, std::vector<BodyTransform>& transforms) {
+
+    transforms.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(batch.positionX[i], batch.positionY[i], batch.positionZ[i]));
+        model = glm::rotate(model, batch.angle[i], glm::vec3(batch.axisX[i], batch.axisY[i], batch.axisZ[i]));
+        model = glm::scale(model, glm::vec3(batch.scaleX[i], batch.scaleY[i], batch.scaleZ[i]));
+        glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(model)));
+        transforms[i].model = model;
+        for (int column = 0; column < 3; ++column) {
+            transforms[i].normal[column] = glm::vec4(normal[column], 0.0f);
+        }
+    }
+}
+
+// Repeats 'transform' until 'benchmarkDuration' has passed, and returns the average time of a pass in seconds
+template <typename Transform>
+double measure(Transform transform) {
+
+    unsigned int passes = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < benchmarkDuration || passes < 3) {
+        transform();
+        ++passes;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds / passes;
+}
+
+// Largest difference between two sets of transforms, relative to the magnitude of each element
+float largestError(const std::vector<BodyTransform>& transforms, const std::vector<BodyTransform>& reference) {
+
+    float error = 0.0f;
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        const float* values = reinterpret_cast<const float*>(&transforms[i]);
+        const float* referenceValues = reinterpret_cast<const float*>(&reference[i]);
+        for (size_t j = 0; j < sizeof(BodyTransform) / sizeof(float); ++j) {
+            error = std::max(error, std::fabs(values[j] - referenceValues[j]) / std::max(1.0f, std::fabs(referenceValues[j])));
+        }
+    }
+    return error;
+}
+
+// Prints one line of the report
+void printLine(const char* name, double seconds, double glmSeconds, size_t count, float error, std::ostream& stream) {
+    stream << std::fixed << std::setprecision(3)
+           << "  " << std::left << std::setw(8) << name << std::right
+           << seconds * 1000.0 << " ms, "
+           << seconds * 1.0e9 / static_cast<double>(count) << " ns per body, "
+           << std::setprecision(2) << glmSeconds / seconds << "x glm, "
+           << std::scientific << std::setprecision(1) << "largest error " << error
+           << std::defaultfloat << std::endl;
+}
+
+}
+
+// Times the glm path and every supported kernel for each number of bodies
+void runTransformBenchmark(const std::vector<size_t>& counts, std::ostream& stream) {
+
+    stream << "Batch transforms: fastest kernel " << transformKernelName(fastestTransformKernel()) << std::endl;
+
+    for (size_t count : counts) {
+
+        stream << count << " bodies" << std::endl;
+
+        TransformBatch batch;
+        randomBatch(batch, count);
+
+        std::vector<BodyTransform> reference;
+        double glmSeconds = measure([&]() { transformWithGlm(batch, reference); });
+        printLine("glm", glmSeconds, glmSeconds, count, 0.0f, stream);
+
+        const TransformKernel kernels[] = { TransformKernel::Scalar, TransformKernel::Sse, TransformKernel::Avx2 };
+        for (TransformKernel kernel : kernels) {
+            if (!isTransformKernelSupported(kernel)) {
+                continue;
+            }
+            std::vector<BodyTransform> transforms;
+            double seconds = measure([&]() { computeBatchTransforms(batch, transforms, kernel); });
+            printLine(transformKernelName(kernel), seconds, glmSeconds, count, largestError(transforms, reference), stream);
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef TRANSFORM_BENCHMARK_H
+#define TRANSFORM_BENCHMARK_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Times the placement of 'counts' random bodies with chained glm::translate(), rotate() and scale() calls followed by the inverse
+// transpose of each model matrix, as the shaders computed per vertex, then with every supported kernel of computeBatchTransforms()
+void runTransformBenchmark(const std::vector<size_t>& counts, std::ostream& stream);
+
+#endif
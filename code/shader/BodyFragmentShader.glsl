@@ -0,0 +1,114 @@
+// Fragment shader of every body, compiled once per material after the same preamble as BodyVertexShader.glsl
+
+in vec2 TexCoord;
+
+#if !defined(EMISSIVE)
+in vec3 Normal;
+in vec3 FragPos;
+#endif
+
+#if defined(INDIRECT)
+
+flat in int TextureSlot;
+flat in int SkinLayer;
+
+// 2D textures of the frame, and the texture array holding the skins of the planets, as bound by the IndirectRenderer
+uniform sampler2D bodyTextures[4];
+uniform sampler2DArray planetSkins;
+
+// Color of the draw's texture. Samplers can only be chosen by a constant index within a draw, so each slot is sampled in its own branch,
+// with the derivatives taken outside the branches, where every fragment computes them
+vec4 textureColor() {
+    vec2 dx = dFdx(TexCoord);
+    vec2 dy = dFdy(TexCoord);
+    switch (TextureSlot) {
+    case 0: return textureGrad(bodyTextures[0], TexCoord, dx, dy);
+    case 1: return textureGrad(bodyTextures[1], TexCoord, dx, dy);
+    case 2: return textureGrad(bodyTextures[2], TexCoord, dx, dy);
+    case 3: return textureGrad(bodyTextures[3], TexCoord, dx, dy);
+    default: return textureGrad(planetSkins, vec3(TexCoord, SkinLayer), dx, dy);
+    }
+}
+
+#elif defined(SKIN_ARRAY)
+
+// Every planet skin, one per layer
+uniform sampler2DArray planetSkins;
+
+#if defined(INSTANCED)
+
+// Layer of the instance's skin
+flat in int SkinLayer;
+
+vec4 textureColor() {
+    return texture(planetSkins, vec3(TexCoord, SkinLayer));
+}
+
+#else
+
+// Layer of the planet's skin
+uniform int skinLayer;
+
+vec4 textureColor() {
+    return texture(planetSkins, vec3(TexCoord, skinLayer));
+}
+
+#endif
+
+#else
+
+uniform sampler2D textureSampler;
+
+vec4 textureColor() {
+    return texture(textureSampler, TexCoord);
+}
+
+#endif
+
+out vec4 FragColor;
+
+void main() {
+
+#if defined(EMISSIVE)
+    vec4 texColor = textureColor();
+
+    const float emissiveStrength = 0.2;
+
+    vec3 emissiveColor = vec3(emissiveStrength,emissiveStrength,emissiveStrength);
+
+    // Add emissive color
+    vec3 colorWithEmission = texColor.rgb + emissiveColor;
+
+    FragColor = vec4(colorWithEmission, 1.0);
+#else
+    vec3 lightPos = vec3(0.0, 0.0, 0.0);
+
+    // Ambient light
+    float ambientStrength = 0.2;
+    vec3 ambientColor = vec3(1.0, 1.0, 1.0);
+    vec3 ambientLight = ambientStrength * ambientColor;
+
+    // Normalize the normal vector of the surface and light direction vectors
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(lightPos - FragPos);
+
+    // Calculate the angle between the normal and light direction
+    float angle = max(dot(norm, lightDir), 0.0);
+
+    // Diffuse light
+    vec3 diffuseColor = vec3(1.0, 1.0, 1.0);
+    vec3 diffuseLight = angle * diffuseColor;
+
+    // Specular light
+    float specularStrength = 1.0;
+    vec3 viewDir = normalize(vec3(0.0, 0.0, 0.0) - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specularLight = specularStrength * spec * vec3(1.0, 1.0, 1.0) * angle;
+
+    // Combine lighting components and texture
+    vec3 result = (ambientLight + diffuseLight + specularLight) * textureColor().rgb;
+    FragColor = vec4(result, 1.0);
+#endif
+
+}
@@ -0,0 +1,161 @@
+// Vertex shader of every body. It has no #version: the resource cache compiles it once per material, after a preamble holding
+// the material's #version and the #define of each of its features (see Material.h):
+//   EMISSIVE    the surface is not lit, so it needs no normal
+//   SKIN_ARRAY  the texture is a layer of the texture array of the planet skins
+//   INSTANCED   each instance is a planet placed by per-instance attributes, as drawn by PlanetField
+//   INDIRECT    each instance reads its placement and texture from the draw data of the IndirectRenderer (GLSL 430)
+
+// Position vector of each vertex (x, y, z coordinates)
+layout (location = 0) in vec3 aPos;
+
+// Texture coordinate of each vertex (u, v coordinates)
+layout (location = 1) in vec2 aTexCoord;
+
+// Normal vector of each vertex (x, y, z coordinates)
+layout (location = 2) in vec3 aNormal;
+
+#if defined(INDIRECT)
+
+// Index of the instance's draw data: the command's base instance plus the instance's index
+layout (location = 5) in uint aDrawIndex;
+
+// Data of one draw, written by the IndirectRenderer
+struct Draw {
+
+    // Model matrix for transforming model coordinates to world coordinates
+    mat4 model;
+
+    // Normal matrix for transforming normals to world coordinates, computed once per draw on the CPU
+    mat3 normalMatrix;
+
+    // Dequantization of packed positions: position = positionOffset + aPos * positionScale
+    vec4 positionOffset;
+    vec4 positionScale;
+
+    // Texture slot of the draw (x) and layer in the texture array (y)
+    ivec4 texture;
+
+};
+
+// Data of every draw of the frame
+layout (std430, binding = 0) readonly buffer Draws {
+    Draw draws[];
+};
+
+#else
+
+#if defined(INSTANCED)
+
+// Per-instance position of the planet (x, y, z) and its uniform scale (w)
+layout (location = 3) in vec4 aPositionScale;
+
+// Per-instance layer of the planet's skin in the texture array
+layout (location = 4) in int aSkinLayer;
+
+#else
+
+// Model matrix for transforming model coordinates to world coordinates
+uniform mat4 model;
+
+#if !defined(EMISSIVE)
+
+// Normal matrix for transforming normals to world coordinates: the inverse transpose of the model matrix, computed once per draw on the CPU
+uniform mat3 normalMatrix;
+
+#endif
+
+#endif
+
+// Dequantization of packed positions, which are stored as fractions of the mesh's bounding box: position = positionOffset + aPos * positionScale.
+// Meshes of floats use an offset of 0 and a scale of 1
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+#endif
+
+// Camera of the current frame, shared by every shader program through a uniform buffer
+layout (std140) uniform Camera {
+
+    // View matrix for transforming world coordinates to camera coordinates
+    mat4 view;
+
+    // Projection matrix for projecting 3D coordinates onto a 2D plane
+    mat4 projection;
+
+    // Position of the camera in world coordinates
+    vec4 cameraPosition;
+
+};
+
+// Passed to fragment shader: texture coordinate for texturing
+out vec2 TexCoord;
+
+#if !defined(EMISSIVE)
+
+// Passed to fragment shader: normal vector transformed to world space
+out vec3 Normal;
+
+// Passed to fragment shader: fragment position in world coordinates
+out vec3 FragPos;
+
+#endif
+
+#if defined(INDIRECT)
+
+// Passed to fragment shader: texture slot of the draw
+flat out int TextureSlot;
+
+#endif
+
+#if defined(INDIRECT) || defined(INSTANCED)
+
+// Passed to fragment shader: layer of the planet's skin
+flat out int SkinLayer;
+
+#endif
+
+void main() {
+
+#if defined(INDIRECT)
+    Draw draw = draws[aDrawIndex];
+    mat4 model = draw.model;
+#if !defined(EMISSIVE)
+    mat3 normalMatrix = draw.normalMatrix;
+#endif
+    TextureSlot = draw.texture.x;
+    SkinLayer = draw.texture.y;
+
+    // Position of the vertex in model coordinates
+    vec3 position = draw.positionOffset.xyz + aPos * draw.positionScale.xyz;
+#else
+    // Position of the vertex in model coordinates
+    vec3 position = positionOffset + aPos * positionScale;
+#endif
+
+    TexCoord = aTexCoord;
+
+#if defined(INSTANCED)
+    SkinLayer = aSkinLayer;
+
+    // Transforms vertex position from model to world coordinates
+    vec3 worldPosition = position * aPositionScale.w + aPositionScale.xyz;
+#else
+    // Transforms vertex position from model to world coordinates
+    vec3 worldPosition = vec3(model * vec4(position, 1.0));
+#endif
+
+#if !defined(EMISSIVE)
+#if defined(INSTANCED)
+    // Planets are only translated and uniformly scaled, so normals need no correction
+    Normal = aNormal;
+#else
+    // Converts normal vector from model to world coordinates for correct lighting
+    Normal = normalMatrix * aNormal;
+#endif
+    FragPos = worldPosition;
+#endif
+
+    // Calculates final position of vertex on screen, combining all transformations
+    gl_Position = projection * view * vec4(worldPosition, 1.0);
+
+}
@@ -0,0 +1,18 @@
+#include "Material.h"
+
+// The #version line must come first, so the features are defined right after it
+std::string materialPreamble(Material material) {
+
+    const MaterialPermutation& permutation = materialPermutation(material);
+
+    std::string preamble = "#version " + std::to_string(permutation.glslVersion) + " core\n";
+    for (size_t i = 0; i < sizeof(materialFeatureNames) / sizeof(materialFeatureNames[0]); ++i) {
+        if (permutation.features & (1u << i)) {
+            preamble += "#define " + std::string(materialFeatureNames[i]) + "\n";
+        }
+    }
+
+    // Number the lines of the source from 1 in the compile errors
+    preamble += "#line 1\n";
+    return preamble;
+}
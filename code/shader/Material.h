@@ -0,0 +1,81 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <cstdint>
+#include <string>
+
+// Sources of the body shaders, from which every material is compiled
+const char* const bodyVertexShaderPath = "./code/shader/BodyVertexShader.glsl";
+const char* const bodyFragmentShaderPath = "./code/shader/BodyFragmentShader.glsl";
+
+// Features of the body shaders. Each is compiled in by a #define of its name, listed in materialFeatureNames
+const uint32_t materialEmissive = 1u << 0;
+const uint32_t materialSkinArray = 1u << 1;
+const uint32_t materialInstanced = 1u << 2;
+const uint32_t materialIndirect = 1u << 3;
+
+// Names of the features' #defines, indexed by the bit of the feature
+const char* const materialFeatureNames[] = { "EMISSIVE", "SKIN_ARRAY", "INSTANCED", "INDIRECT" };
+
+// Surfaces of the bodies, each one permutation of the body shaders. Models reference a material, and the resource cache compiles
+// one program per material in use, shared by every model referencing it
+enum class Material {
+
+    // Texture brightened by a constant emission, for the sun
+    Emissive,
+
+    // Texture lit by the sun at the origin, for the earth and the moon
+    Lit,
+
+    // Layer of the planet skins, chosen by the 'skinLayer' uniform, lit by the sun, for the per-object planets
+    LitSkinArray,
+
+    // Layer of the planet skins, placed and chosen by per-instance attributes, lit by the sun, for the planet field
+    LitInstanced,
+
+    // The emissive and lit surfaces drawn by the IndirectRenderer, placed and textured by the draw data in its storage buffer
+    IndirectEmissive,
+    IndirectLit,
+
+    Count
+
+};
+
+// One permutation of the body shaders
+struct MaterialPermutation {
+
+    // Name of the material, which forms the key of its program in the resource cache
+    const char* name;
+
+    // GLSL version of the permutation. The storage buffer of the indirect draws needs 430
+    int glslVersion;
+
+    // Features compiled in
+    uint32_t features;
+
+    // Material drawing the same surface through the IndirectRenderer
+    Material indirect;
+
+};
+
+// Permutation of every material, indexed by Material
+constexpr MaterialPermutation materialPermutations[] = {
+    { "emissive", 330, materialEmissive, Material::IndirectEmissive },
+    { "lit", 330, 0, Material::IndirectLit },
+    { "lit-skin-array", 330, materialSkinArray, Material::IndirectLit },
+    { "lit-instanced", 330, materialSkinArray | materialInstanced, Material::IndirectLit },
+    { "indirect-emissive", 430, materialIndirect | materialEmissive, Material::IndirectEmissive },
+    { "indirect-lit", 430, materialIndirect, Material::IndirectLit },
+};
+
+static_assert(sizeof(materialPermutations) / sizeof(materialPermutations[0]) == static_cast<size_t>(Material::Count), "Every material needs a permutation");
+
+// Permutation of a material
+constexpr const MaterialPermutation& materialPermutation(Material material) {
+    return materialPermutations[static_cast<int>(material)];
+}
+
+// Lines placed before the body shaders' sources to compile a material: the #version of the permutation and the #define of every feature
+std::string materialPreamble(Material material);
+
+#endif
@@ -0,0 +1,164 @@
+#include "ProgramBinaryCache.h"
+#include "../mesh/BinaryMesh.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const char programBinaryMagic[4] = { 'S', 'S', 'P', 'B' };
+
+// Appends a string to a hash, with its terminating zero so that consecutive strings cannot run into each other
+uint64_t hashString(const std::string& text, uint64_t hash) {
+    return hashBytes(reinterpret_cast<const unsigned char*>(text.c_str()), text.size() + 1, hash);
+}
+
+// Driver string, or an empty string if the driver has none
+std::string driverString(GLenum name) {
+    const GLubyte* text = glGetString(name);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+}
+
+// Selects how programs use the binaries, and the directory holding them
+void ProgramBinaryCache::setMode(ShaderCacheMode newMode, const std::string& newDirectory) {
+    mode = newMode;
+    directory = newDirectory;
+}
+
+// Loading needs the enabled mode and a driver supporting binaries
+bool ProgramBinaryCache::isLoading() {
+    return mode == ShaderCacheMode::Enabled && queryDriver();
+}
+
+// Saving needs the binaries enabled or rebuilt, and a driver supporting them
+bool ProgramBinaryCache::isSaving() {
+    return mode != ShaderCacheMode::Disabled && queryDriver();
+}
+
+// Checks the version or extension and the number of binary formats once, and keeps the driver's strings for the keys
+bool ProgramBinaryCache::queryDriver() {
+
+    if (isQueried) {
+        return isSupported;
+    }
+    isQueried = true;
+
+    GLint formatCount = 0;
+    if (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1) || GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+    if (formatCount == 0) {
+        std::cerr << "ERROR::SHADER_CACHE::UNSUPPORTED: the driver cannot save program binaries, every program is compiled" << std::endl;
+        return false;
+    }
+
+    driver = driverString(GL_VENDOR) + "|" + driverString(GL_RENDERER) + "|" + driverString(GL_VERSION);
+    isSupported = true;
+    return true;
+}
+
+// Hashes both sources and the driver's strings
+uint64_t ProgramBinaryCache::programKey(const std::string& vertexSource, const std::string& fragmentSource) {
+    queryDriver();
+    uint64_t hash = hashString(vertexSource, hashOffsetBasis);
+    hash = hashString(fragmentSource, hash);
+    return hashString(driver, hash);
+}
+
+// One file per key, named by the key in hexadecimal
+std::string ProgramBinaryCache::binaryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Reads the binary and hands it to the driver, which may reject it, e.g. after an update that kept its version string
+unsigned int ProgramBinaryCache::load(uint64_t key) {
+
+    std::ifstream file(binaryPath(key), std::ios::binary);
+    if (!file) {
+        return 0;
+    }
+
+    ProgramBinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, programBinaryMagic, sizeof(header.magic)) != 0
+        || header.version != programBinaryVersion || header.key != key) {
+        std::cerr << "ERROR::SHADER_CACHE::INVALID: " << binaryPath(key) << std::endl;
+        return 0;
+    }
+
+    std::vector<char> binary(header.binaryBytes);
+    if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) {
+        std::cerr << "ERROR::SHADER_CACHE::INVALID: " << binaryPath(key) << std::endl;
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cerr << "ERROR::SHADER_CACHE::REJECTED: " << binaryPath(key) << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// Writes the binary under a temporary name and renames it, so that a crash never leaves a truncated binary behind
+bool ProgramBinaryCache::save(uint64_t key, unsigned int program) {
+
+    GLint binaryBytes = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryBytes);
+    if (binaryBytes <= 0) {
+        return false;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(binaryBytes));
+    GLsizei length = 0;
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, binaryBytes, &length, &binaryFormat, binary.data());
+    if (length <= 0) {
+        return false;
+    }
+
+    ProgramBinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, programBinaryMagic, sizeof(header.magic));
+    header.version = programBinaryVersion;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryBytes = static_cast<uint32_t>(length);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    std::string path = binaryPath(key);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "ERROR::SHADER_CACHE::CANNOT_WRITE: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "ERROR::SHADER_CACHE::CANNOT_RENAME: " << temporaryPath << " " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
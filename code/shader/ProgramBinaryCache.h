@@ -0,0 +1,91 @@
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// How programs use the program binaries saved in the cache directory
+enum class ShaderCacheMode {
+
+    // Load the binary of a program if the driver accepts it, otherwise compile the shaders and save the binary
+    Enabled,
+
+    // Always compile the shaders and never save binaries
+    Disabled,
+
+    // Always compile the shaders and overwrite the binaries
+    Rebuild
+
+};
+
+// Version of the program binary files. Files of any other version are ignored
+const uint32_t programBinaryVersion = 1;
+
+// Header at the start of a program binary file, followed by the binary returned by glGetProgramBinary()
+struct ProgramBinaryHeader {
+
+    // "SSPB"
+    char magic[4];
+
+    // Must equal programBinaryVersion
+    uint32_t version;
+
+    // Key of the program, which also names the file
+    uint64_t key;
+
+    // Format of the binary, as returned by glGetProgramBinary()
+    uint32_t binaryFormat;
+
+    // Size of the binary, in bytes
+    uint32_t binaryBytes;
+
+};
+
+// Linked programs saved with glGetProgramBinary() into a directory, one file per program, and created again with glProgramBinary()
+// instead of compiling their shaders. A program is keyed by the hash of its sources and of the driver's vendor, renderer and version
+// strings, so that editing a shader or updating the driver misses the cache. Requires a current OpenGL context
+class ProgramBinaryCache {
+
+public:
+
+    // Selects how programs use the binaries, and the directory holding them
+    void setMode(ShaderCacheMode mode, const std::string& directory);
+
+    // Whether programs may be loaded from binaries
+    bool isLoading();
+
+    // Whether linked programs must be saved as binaries. They must then be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    bool isSaving();
+
+    // Key of the program linked from the two sources with the current driver
+    uint64_t programKey(const std::string& vertexSource, const std::string& fragmentSource);
+
+    // Creates the program from its binary. Returns 0 if the binary is missing, corrupt or rejected by the driver
+    unsigned int load(uint64_t key);
+
+    // Saves the binary of a linked program
+    bool save(uint64_t key, unsigned int program);
+
+private:
+
+    ShaderCacheMode mode = ShaderCacheMode::Enabled;
+
+    std::string directory = "./shader-cache";
+
+    // Whether the driver was queried, and whether it supports program binaries
+    bool isQueried = false;
+    bool isSupported = false;
+
+    // Vendor, renderer and version strings of the driver, part of every key
+    std::string driver;
+
+    // Queries the driver on the first use: program binaries need OpenGL 4.1 or ARB_get_program_binary, and at least one binary format
+    bool queryDriver();
+
+    // Path of the file of a key
+    std::string binaryPath(uint64_t key) const;
+
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "ShaderProgram.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Names of the uniforms in the shaders, indexed by Uniform
+const char* const uniformNames[] = { "model", "normalMatrix", "textureSampler", "planetSkins", "bodyTextures", "skinLayer", "positionOffset", "positionScale" };
+
+static_assert(sizeof(uniformNames) / sizeof(uniformNames[0]) == static_cast<size_t>(Uniform::Count), "Every uniform needs a name");
+
+}
+
+// Reads shader source code from a file
+std::string ShaderProgram::readShaderFile(const std::string& filePath) {
+
+    std::ifstream shaderFile(filePath);
+    if (!shaderFile) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_FOUND: " << filePath << std::endl;
+        return "";
+    }
+    std::stringstream shaderStream;
+    shaderStream << shaderFile.rdbuf();
+    return shaderStream.str();
+}
+
+// Compiles one shader and checks for compile errors
+unsigned int ShaderProgram::compileShader(GLenum type, const std::string& source, const char* stageName) {
+
+    unsigned int shader = glCreateShader(type);
+    const char* code = source.c_str();
+    glShaderSource(shader, 1, &code, NULL);
+    glCompileShader(shader);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+    return shader;
+}
+
+// Loads the program from its binary if the cache has it, otherwise compiles and links the shaders and saves the binary.
+// Then resolves the uniform locations
+bool ShaderProgram::build(const std::string& vertexPath, const std::string& fragmentPath, const std::string& preamble, ProgramBinaryCache* binaryCache) {
+
+    std::string vertexSource = preamble + readShaderFile(vertexPath);
+    std::string fragmentSource = preamble + readShaderFile(fragmentPath);
+
+    bool isLoading = binaryCache && binaryCache->isLoading();
+    bool isSaving = binaryCache && binaryCache->isSaving();
+    uint64_t key = isLoading || isSaving ? binaryCache->programKey(vertexSource, fragmentSource) : 0;
+
+    // Any failure to load the binary falls back to the sources
+    shaderProgram = isLoading ? binaryCache->load(key) : 0;
+    fromBinary = shaderProgram != 0;
+
+    bool success = true;
+    if (!fromBinary) {
+        success = compileAndLink(vertexSource, fragmentSource, isSaving);
+        if (success && isSaving) {
+            binaryCache->save(key, shaderProgram);
+        }
+    }
+
+    resolveUniforms();
+
+    return success;
+}
+
+// Compiles the vertex and fragment shaders and links them into shaderProgram
+bool ShaderProgram::compileAndLink(const std::string& vertexSource, const std::string& fragmentSource, bool isBinaryRetrievable) {
+
+    // Compile the vertex and fragment shaders
+    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+
+    // Link shaders into a program
+    shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    if (isBinaryRetrievable) {
+        glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(shaderProgram);
+
+    // Check for linking errors
+    int success;
+    char infoLog[512];
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    // Delete shaders
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return success != 0;
+}
+
+// Resolves every uniform once, so that rendering never looks them up by name
+void ShaderProgram::resolveUniforms() {
+
+    for (int i = 0; i < static_cast<int>(Uniform::Count); ++i) {
+        locations[i] = glGetUniformLocation(shaderProgram, uniformNames[i]);
+    }
+
+    // GLSL 3.30 cannot declare the binding point of a block, so bind the camera block here
+    GLuint cameraBlock = glGetUniformBlockIndex(shaderProgram, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shaderProgram, cameraBlock, cameraBlockBinding);
+    }
+}
+
+// Whether the program was loaded from its binary
+bool ShaderProgram::isFromBinary() const {
+    return fromBinary;
+}
+
+// Makes the program current
+void ShaderProgram::use() const {
+    glUseProgram(shaderProgram);
+}
+
+// Location of a uniform, or -1 if the program does not use it
+GLint ShaderProgram::location(Uniform uniform) const {
+    return locations[static_cast<int>(uniform)];
+}
+
+// OpenGL identifier of the program
+unsigned int ShaderProgram::id() const {
+    return shaderProgram;
+}
+
+// Deletes the program
+void ShaderProgram::destroy() {
+
+    if (shaderProgram)
+        glDeleteProgram(shaderProgram);
+
+    shaderProgram = 0;
+}
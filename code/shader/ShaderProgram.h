@@ -0,0 +1,91 @@
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include <glad/glad.h>
+#include <string>
+#include "ProgramBinaryCache.h"
+
+// Uniforms set by the models. Their locations are resolved once, when the program is linked
+enum class Uniform {
+
+    // Model matrix, transforming model coordinates to world coordinates
+    Model,
+
+    // Normal matrix, the inverse transpose of the model matrix's upper 3x3, for the lit materials
+    NormalMatrix,
+
+    // Sampler of the model's texture
+    TextureSampler,
+
+    // Sampler of the texture array holding the skins of the planets
+    PlanetSkins,
+
+    // Array of samplers holding the 2D textures of the draws submitted together by the IndirectRenderer
+    BodyTextures,
+
+    // Layer of the planet's skin in the texture array, for planets drawn one at a time
+    SkinLayer,
+
+    // Dequantization of the mesh's packed positions: offset and scale of its bounding box
+    PositionOffset,
+    PositionScale,
+
+    Count
+
+};
+
+// A linked vertex and fragment shader pair, with the locations of its uniforms resolved at link time
+// and its "Camera" uniform block bound to the binding point of the shared camera uniform buffer
+class ShaderProgram {
+
+public:
+
+    // Binding point of the "Camera" uniform block (view, projection and camera position), shared by every program
+    static const unsigned int cameraBlockBinding = 0;
+
+    // Compiles and links the vertex and fragment shaders, then resolves the uniform locations. The preamble is placed before both sources,
+    // for shaders compiled in several permutations, which leave their #version to it. With a binary cache, the program is loaded from
+    // its binary when the cache has one, and its binary is saved otherwise
+    bool build(const std::string& vertexPath, const std::string& fragmentPath, const std::string& preamble = "", ProgramBinaryCache* binaryCache = nullptr);
+
+    // Whether the last build() loaded the program from its binary instead of compiling it
+    bool isFromBinary() const;
+
+    // Makes the program current
+    void use() const;
+
+    // Location of a uniform, or -1 if the program does not use it
+    GLint location(Uniform uniform) const;
+
+    // OpenGL identifier of the program
+    unsigned int id() const;
+
+    // Deletes the program
+    void destroy();
+
+private:
+
+    // Identifier for the compiled and linked shader program
+    unsigned int shaderProgram = 0;
+
+    // Whether the program was loaded from its binary
+    bool fromBinary = false;
+
+    // Location of each uniform, indexed by Uniform
+    GLint locations[static_cast<int>(Uniform::Count)] = {};
+
+    // Reads the source code of a shader from a file
+    static std::string readShaderFile(const std::string& filePath);
+
+    // Compiles one shader, printing its log on failure
+    static unsigned int compileShader(GLenum type, const std::string& source, const char* stageName);
+
+    // Compiles and links the sources into shaderProgram, letting the driver keep the binary if it will be saved. Returns whether it linked
+    bool compileAndLink(const std::string& vertexSource, const std::string& fragmentSource, bool isBinaryRetrievable);
+
+    // Looks up the uniforms and binds the camera block of the linked program
+    void resolveUniforms();
+
+};
+
+#endif
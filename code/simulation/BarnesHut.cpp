@@ -0,0 +1,532 @@
+#include "BarnesHut.h"
+#include "../threading/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BARNES_HUT_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Bits per axis of the Morton keys, and so the deepest level of the octree
+const unsigned int mortonBits = 21;
+
+// Cells with at most this many bodies are not split further
+const uint32_t leafCapacity = 8;
+
+// Marks a build that does not split into tasks
+const unsigned int noSplit = ~0u;
+
+// Number of bodies per chunk of the parallel loops, and of groups per chunk of the traversal
+const size_t bodyGrain = 4096;
+const size_t groupGrain = 16;
+
+// Number of consecutive bodies, in Morton order, sharing one walk of the octree
+const size_t groupSize = 32;
+
+// Spreads the 21 low bits of a value to every third bit
+uint64_t spreadBits(uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffffULL;
+    value = (value | value << 16) & 0x1f0000ff0000ffULL;
+    value = (value | value << 8) & 0x100f00f00f00f00fULL;
+    value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+    value = (value | value << 2) & 0x1249249249249249ULL;
+    return value;
+}
+
+// Gathers every third bit of a value into its 21 low bits
+uint32_t compactBits(uint64_t value) {
+    value &= 0x1249249249249249ULL;
+    value = (value ^ (value >> 2)) & 0x10c30c30c30c30c3ULL;
+    value = (value ^ (value >> 4)) & 0x100f00f00f00f00fULL;
+    value = (value ^ (value >> 8)) & 0x1f0000ff0000ffULL;
+    value = (value ^ (value >> 16)) & 0x1f00000000ffffULL;
+    value = (value ^ (value >> 32)) & 0x1fffff;
+    return static_cast<uint32_t>(value);
+}
+
+#ifdef BARNES_HUT_SSE
+
+// Adds up the 4 lanes of a vector
+float horizontalSum(__m128 value) {
+    __m128 shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(value, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+#endif
+
+// Cells and bodies pulling a group of bodies, in a structure-of-arrays layout padded like Bodies.
+// Kept by each traversal chunk, so its memory is reused by every group of the chunk
+struct InteractionList {
+
+    std::vector<float> x, y, z, mass;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        mass.clear();
+    }
+
+    void add(float positionX, float positionY, float positionZ, float bodyMass) {
+        x.push_back(positionX);
+        y.push_back(positionY);
+        z.push_back(positionZ);
+        mass.push_back(bodyMass);
+    }
+
+    // Pads the list with massless entries to a multiple of Bodies::simdWidth
+    void pad() {
+        while (x.size() % Bodies::simdWidth != 0) {
+            add(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    // Sums the pull of the list on a body, skipping entries at distance 0 (the body itself, without softening)
+    void sum(float positionX, float positionY, float positionZ, float softeningSquared, float& ax, float& ay, float& az) const {
+
+        size_t count = x.size();
+#ifdef BARNES_HUT_SSE
+        __m128 xi = _mm_set1_ps(positionX);
+        __m128 yi = _mm_set1_ps(positionY);
+        __m128 zi = _mm_set1_ps(positionZ);
+        __m128 epsilon = _mm_set1_ps(softeningSquared);
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 zero = _mm_setzero_ps();
+        __m128 sumX = zero, sumY = zero, sumZ = zero;
+
+        for (size_t j = 0; j < count; j += Bodies::simdWidth) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(&x[j]), xi);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(&y[j]), yi);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(&z[j]), zi);
+            __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_add_ps(_mm_mul_ps(dz, dz), epsilon));
+
+            __m128 inverseDistance = _mm_div_ps(one, _mm_sqrt_ps(distanceSquared));
+            __m128 inverseCube = _mm_mul_ps(_mm_mul_ps(inverseDistance, inverseDistance), inverseDistance);
+            inverseCube = _mm_and_ps(inverseCube, _mm_cmpgt_ps(distanceSquared, zero));
+
+            __m128 strength = _mm_mul_ps(_mm_loadu_ps(&mass[j]), inverseCube);
+            sumX = _mm_add_ps(sumX, _mm_mul_ps(dx, strength));
+            sumY = _mm_add_ps(sumY, _mm_mul_ps(dy, strength));
+            sumZ = _mm_add_ps(sumZ, _mm_mul_ps(dz, strength));
+        }
+
+        ax = horizontalSum(sumX);
+        ay = horizontalSum(sumY);
+        az = horizontalSum(sumZ);
+#else
+        ax = ay = az = 0.0f;
+        for (size_t j = 0; j < count; ++j) {
+            float dx = x[j] - positionX;
+            float dy = y[j] - positionY;
+            float dz = z[j] - positionZ;
+            float distanceSquared = dx * dx + dy * dy + dz * dz + softeningSquared;
+            if (distanceSquared <= 0.0f) {
+                continue;
+            }
+            float inverseDistance = 1.0f / std::sqrt(distanceSquared);
+            float strength = mass[j] * inverseDistance * inverseDistance * inverseDistance;
+            ax += dx * strength;
+            ay += dy * strength;
+            az += dz * strength;
+        }
+#endif
+    }
+};
+
+// Quantizes a coordinate inside the root cell to 21 bits
+uint64_t quantize(float coordinate, float origin, float scale) {
+    float cell = (coordinate - origin) * scale;
+    return static_cast<uint64_t>(std::min(std::max(cell, 0.0f), static_cast<float>((1u << mortonBits) - 1)));
+}
+
+// Octant (0 to 7) of a key at a level of the octree
+unsigned int octant(uint64_t key, unsigned int level) {
+    return static_cast<unsigned int>(key >> (3 * (mortonBits - 1 - level))) & 7;
+}
+
+}
+
+// Constructor: Creates a solver with the given opening angle
+BarnesHutSolver::BarnesHutSolver(float openingAngle) : theta(openingAngle) {
+}
+
+void BarnesHutSolver::setOpeningAngle(float openingAngle) {
+    theta = openingAngle;
+}
+
+float BarnesHutSolver::openingAngle() const {
+    return theta;
+}
+
+// Number of cells of the last octree
+size_t BarnesHutSolver::nodeCount() const {
+    return nodes.size();
+}
+
+// Computes the acceleration of every body: sort, build, then traverse the octree once per group of bodies
+void BarnesHutSolver::computeAccelerations(Bodies& bodies, float gravitationalConstant, float softening, ThreadPool* pool) {
+
+    if (bodies.count == 0) {
+        return;
+    }
+
+    sortBodies(bodies, pool);
+    buildTree(pool);
+
+    // Consecutive bodies in Morton order are close to each other, so they walk the octree together
+    float softeningSquared = softening * softening;
+    size_t groupCount = (bodies.count + groupSize - 1) / groupSize;
+    auto traverseRange = [&](size_t begin, size_t end) {
+        traverse(bodies, gravitationalConstant, softeningSquared, begin, end);
+    };
+    if (pool) {
+        pool->parallelFor(groupCount, groupGrain, traverseRange);
+    }
+    else {
+        traverseRange(0, groupCount);
+    }
+}
+
+// Sorts the bodies along the Morton curve of their bounding cube, and gathers their positions and masses in that order
+void BarnesHutSolver::sortBodies(const Bodies& bodies, ThreadPool* pool) {
+
+    size_t count = bodies.count;
+    auto parallelFor = [pool](size_t loopCount, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (pool) {
+            pool->parallelFor(loopCount, grain, body);
+        }
+        else if (loopCount > 0) {
+            body(0, loopCount);
+        }
+    };
+
+    // Bounding box of the bodies, reduced per chunk
+    size_t chunkCount = (count + bodyGrain - 1) / bodyGrain;
+    std::vector<float> chunkBounds(chunkCount * 6);
+    parallelFor(count, bodyGrain, [&](size_t begin, size_t end) {
+        float* bounds = &chunkBounds[(begin / bodyGrain) * 6];
+        bounds[0] = bounds[3] = bodies.positionX[begin];
+        bounds[1] = bounds[4] = bodies.positionY[begin];
+        bounds[2] = bounds[5] = bodies.positionZ[begin];
+        for (size_t i = begin; i < end; ++i) {
+            bounds[0] = std::min(bounds[0], bodies.positionX[i]);
+            bounds[1] = std::min(bounds[1], bodies.positionY[i]);
+            bounds[2] = std::min(bounds[2], bodies.positionZ[i]);
+            bounds[3] = std::max(bounds[3], bodies.positionX[i]);
+            bounds[4] = std::max(bounds[4], bodies.positionY[i]);
+            bounds[5] = std::max(bounds[5], bodies.positionZ[i]);
+        }
+    });
+    float minimum[3] = { chunkBounds[0], chunkBounds[1], chunkBounds[2] };
+    float maximum[3] = { chunkBounds[3], chunkBounds[4], chunkBounds[5] };
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        for (int axis = 0; axis < 3; ++axis) {
+            minimum[axis] = std::min(minimum[axis], chunkBounds[chunk * 6 + axis]);
+            maximum[axis] = std::max(maximum[axis], chunkBounds[chunk * 6 + 3 + axis]);
+        }
+    }
+
+    // The root cell is the cube enclosing the box, slightly enlarged so that no body lies on its far faces
+    rootX = minimum[0];
+    rootY = minimum[1];
+    rootZ = minimum[2];
+    rootSize = std::max(std::max(maximum[0] - minimum[0], maximum[1] - minimum[1]), maximum[2] - minimum[2]);
+    rootSize = std::max(rootSize * 1.0001f, std::numeric_limits<float>::min());
+
+    // Morton keys
+    entries.resize(count);
+    float scale = static_cast<float>(1u << mortonBits) / rootSize;
+    parallelFor(count, bodyGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t x = quantize(bodies.positionX[i], rootX, scale);
+            uint64_t y = quantize(bodies.positionY[i], rootY, scale);
+            uint64_t z = quantize(bodies.positionZ[i], rootZ, scale);
+            entries[i].key = spreadBits(x) << 2 | spreadBits(y) << 1 | spreadBits(z);
+            entries[i].body = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Sort one run per thread, then merge the runs pairwise
+    auto byKey = [](const MortonEntry& a, const MortonEntry& b) { return a.key < b.key; };
+    size_t runCount = pool ? pool->threadCount() : 1;
+    size_t runLength = (count + runCount - 1) / runCount;
+    parallelFor(runCount, 1, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; ++run) {
+            size_t first = std::min(run * runLength, count);
+            size_t last = std::min(first + runLength, count);
+            std::sort(entries.begin() + first, entries.begin() + last, byKey);
+        }
+    });
+    for (size_t width = runLength; width < count; width *= 2) {
+        size_t pairCount = (count + 2 * width - 1) / (2 * width);
+        parallelFor(pairCount, 1, [&](size_t begin, size_t end) {
+            for (size_t pair = begin; pair < end; ++pair) {
+                size_t first = pair * 2 * width;
+                size_t middle = std::min(first + width, count);
+                size_t last = std::min(first + 2 * width, count);
+                std::inplace_merge(entries.begin() + first, entries.begin() + middle, entries.begin() + last, byKey);
+            }
+        });
+    }
+
+    // Gather the positions and masses in Morton order
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedZ.resize(count);
+    sortedMass.resize(count);
+    parallelFor(count, bodyGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t body = entries[i].body;
+            sortedX[i] = bodies.positionX[body];
+            sortedY[i] = bodies.positionY[body];
+            sortedZ[i] = bodies.positionZ[body];
+            sortedMass[i] = bodies.mass[body];
+        }
+    });
+}
+
+// Builds the top levels of the octree, then the subtrees below them in parallel, and splices them together
+void BarnesHutSolver::buildTree(ThreadPool* pool) {
+
+    // Split the tree at the shallowest level with enough cells to keep every thread busy
+    unsigned int threads = pool ? pool->threadCount() : 1;
+    unsigned int splitLevel = 0;
+    while (splitLevel < 4 && (1u << (3 * splitLevel)) < 4 * threads) {
+        ++splitLevel;
+    }
+
+    nodes.clear();
+    tasks.clear();
+    topNodes.clear();
+    nodes.resize(1);
+    buildNode(nodes, 0, 0, static_cast<uint32_t>(entries.size()), 0, splitLevel);
+
+    // Build every subtree into its own arena. Their root is their first node
+    if (taskNodes.size() < tasks.size()) {
+        taskNodes.resize(tasks.size());
+    }
+    auto buildTasks = [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            std::vector<OctreeNode>& arena = taskNodes[t];
+            arena.clear();
+            arena.resize(1);
+            buildNode(arena, 0, tasks[t].firstBody, tasks[t].lastBody, tasks[t].level, noSplit);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(tasks.size(), 1, buildTasks);
+    }
+    else {
+        buildTasks(0, tasks.size());
+    }
+
+    // Splice the subtrees: their root replaces the task's cell, and the rest is appended with shifted child indices
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        const std::vector<OctreeNode>& arena = taskNodes[t];
+        uint32_t offset = static_cast<uint32_t>(nodes.size()) - 1;
+        nodes.insert(nodes.end(), arena.begin() + 1, arena.end());
+        nodes[tasks[t].node] = arena[0];
+        if (arena[0].childCount > 0) {
+            nodes[tasks[t].node].firstChild += offset;
+        }
+        for (size_t i = offset + 1; i < nodes.size(); ++i) {
+            if (nodes[i].childCount > 0) {
+                nodes[i].firstChild += offset;
+            }
+        }
+    }
+
+    // Finish the cells above the subtrees. They were recorded after their children
+    for (const TopNode& top : topNodes) {
+        finishNode(nodes, top.node, top.level);
+    }
+}
+
+// Builds the cell covering entries [first, last)
+void BarnesHutSolver::buildNode(std::vector<OctreeNode>& arena, uint32_t node, uint32_t first, uint32_t last, unsigned int level, unsigned int splitLevel) {
+
+    arena[node].firstBody = first;
+    arena[node].bodyCount = last - first;
+    arena[node].firstChild = 0;
+    arena[node].childCount = 0;
+
+    // Small cells, and cells at the deepest level, are leaves
+    if (last - first <= leafCapacity || level == mortonBits) {
+        finishNode(arena, node, level);
+        return;
+    }
+
+    // Cells at the split level are built later by a task
+    if (level == splitLevel) {
+        tasks.push_back({ node, first, last, level });
+        return;
+    }
+
+    // The entries are sorted, so each octant's bodies form a contiguous range
+    uint32_t bounds[9];
+    bounds[0] = first;
+    bounds[8] = last;
+    for (unsigned int child = 1; child < 8; ++child) {
+        bounds[child] = static_cast<uint32_t>(std::partition_point(entries.begin() + bounds[child - 1], entries.begin() + last,
+            [&](const MortonEntry& entry) { return octant(entry.key, level) < child; }) - entries.begin());
+    }
+
+    // Allocate the non-empty children next to each other
+    uint32_t childCount = 0;
+    for (unsigned int child = 0; child < 8; ++child) {
+        childCount += bounds[child + 1] > bounds[child] ? 1 : 0;
+    }
+    uint32_t firstChild = static_cast<uint32_t>(arena.size());
+    arena.resize(arena.size() + childCount);
+    arena[node].firstChild = firstChild;
+    arena[node].childCount = childCount;
+
+    uint32_t childNode = firstChild;
+    for (unsigned int child = 0; child < 8; ++child) {
+        if (bounds[child + 1] > bounds[child]) {
+            buildNode(arena, childNode++, bounds[child], bounds[child + 1], level + 1, splitLevel);
+        }
+    }
+
+    // Above the split level, children may still be waiting for their task
+    if (splitLevel != noSplit) {
+        topNodes.push_back({ node, level });
+    }
+    else {
+        finishNode(arena, node, level);
+    }
+}
+
+// Sets the mass, center of mass and opening distance of a cell
+void BarnesHutSolver::finishNode(std::vector<OctreeNode>& arena, uint32_t node, unsigned int level) {
+
+    OctreeNode& cell = arena[node];
+
+    // Sum the bodies of a leaf, or the children of an inner cell
+    double mass = 0.0, x = 0.0, y = 0.0, z = 0.0;
+    if (cell.childCount == 0) {
+        for (uint32_t i = cell.firstBody; i < cell.firstBody + cell.bodyCount; ++i) {
+            mass += sortedMass[i];
+            x += static_cast<double>(sortedMass[i]) * sortedX[i];
+            y += static_cast<double>(sortedMass[i]) * sortedY[i];
+            z += static_cast<double>(sortedMass[i]) * sortedZ[i];
+        }
+    }
+    else {
+        for (uint32_t i = cell.firstChild; i < cell.firstChild + cell.childCount; ++i) {
+            const OctreeNode& child = arena[i];
+            mass += child.mass;
+            x += static_cast<double>(child.mass) * child.centerOfMassX;
+            y += static_cast<double>(child.mass) * child.centerOfMassY;
+            z += static_cast<double>(child.mass) * child.centerOfMassZ;
+        }
+    }
+
+    // Geometric center of the cell, from the Morton key of any of its bodies
+    float size = rootSize / static_cast<float>(1u << level);
+    uint64_t key = entries[cell.firstBody].key;
+    unsigned int shift = mortonBits - level;
+    float centerX = rootX + (static_cast<float>(compactBits(key >> 2) >> shift) + 0.5f) * size;
+    float centerY = rootY + (static_cast<float>(compactBits(key >> 1) >> shift) + 0.5f) * size;
+    float centerZ = rootZ + (static_cast<float>(compactBits(key) >> shift) + 0.5f) * size;
+
+    // Massless cells keep their center, where they exert no force anyway
+    if (mass > 0.0) {
+        cell.centerOfMassX = static_cast<float>(x / mass);
+        cell.centerOfMassY = static_cast<float>(y / mass);
+        cell.centerOfMassZ = static_cast<float>(z / mass);
+    }
+    else {
+        cell.centerOfMassX = centerX;
+        cell.centerOfMassY = centerY;
+        cell.centerOfMassZ = centerZ;
+    }
+    cell.mass = static_cast<float>(mass);
+
+    // Adding the offset of the center of mass keeps bodies inside the cell from ever treating it as a single body, for theta up to 1
+    float offsetX = cell.centerOfMassX - centerX;
+    float offsetY = cell.centerOfMassY - centerY;
+    float offsetZ = cell.centerOfMassZ - centerZ;
+    float offset = std::sqrt(offsetX * offsetX + offsetY * offsetY + offsetZ * offsetZ);
+    if (theta > 0.0f) {
+        float openingDistance = size / theta + offset;
+        cell.openingDistanceSquared = openingDistance * openingDistance;
+    }
+    else {
+        cell.openingDistanceSquared = std::numeric_limits<float>::infinity();
+    }
+}
+
+// Computes the acceleration of the groups [firstGroup, lastGroup): each group walks the octree once into an interaction list,
+// then every body of the group sums the pull of the list
+void BarnesHutSolver::traverse(Bodies& bodies, float gravitationalConstant, float softeningSquared, size_t firstGroup, size_t lastGroup) const {
+
+    // Every level pushes at most 8 children and pops one
+    uint32_t stack[8 * (mortonBits + 1)];
+    InteractionList list;
+
+    for (size_t group = firstGroup; group < lastGroup; ++group) {
+
+        size_t begin = group * groupSize;
+        size_t end = std::min(begin + groupSize, entries.size());
+
+        // Bounding box of the group
+        float minimumX = sortedX[begin], minimumY = sortedY[begin], minimumZ = sortedZ[begin];
+        float maximumX = minimumX, maximumY = minimumY, maximumZ = minimumZ;
+        for (size_t i = begin + 1; i < end; ++i) {
+            minimumX = std::min(minimumX, sortedX[i]);
+            minimumY = std::min(minimumY, sortedY[i]);
+            minimumZ = std::min(minimumZ, sortedZ[i]);
+            maximumX = std::max(maximumX, sortedX[i]);
+            maximumY = std::max(maximumY, sortedY[i]);
+            maximumZ = std::max(maximumZ, sortedZ[i]);
+        }
+
+        list.clear();
+        unsigned int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const OctreeNode& cell = nodes[stack[--stackSize]];
+
+            // Distance from the center of mass to the nearest point of the group's box
+            float dx = std::max(std::max(minimumX - cell.centerOfMassX, cell.centerOfMassX - maximumX), 0.0f);
+            float dy = std::max(std::max(minimumY - cell.centerOfMassY, cell.centerOfMassY - maximumY), 0.0f);
+            float dz = std::max(std::max(minimumZ - cell.centerOfMassZ, cell.centerOfMassZ - maximumZ), 0.0f);
+
+            // Far enough from every body of the group: the whole cell pulls like a single body at its center of mass
+            if (dx * dx + dy * dy + dz * dz > cell.openingDistanceSquared) {
+                list.add(cell.centerOfMassX, cell.centerOfMassY, cell.centerOfMassZ, cell.mass);
+            }
+            // Too close to a leaf: its bodies pull one by one
+            else if (cell.childCount == 0) {
+                for (uint32_t i = cell.firstBody; i < cell.firstBody + cell.bodyCount; ++i) {
+                    list.add(sortedX[i], sortedY[i], sortedZ[i], sortedMass[i]);
+                }
+            }
+            // Too close to an inner cell: open it
+            else {
+                for (uint32_t child = 0; child < cell.childCount; ++child) {
+                    stack[stackSize++] = cell.firstChild + child;
+                }
+            }
+        }
+
+        list.pad();
+        for (size_t i = begin; i < end; ++i) {
+            float ax, ay, az;
+            list.sum(sortedX[i], sortedY[i], sortedZ[i], softeningSquared, ax, ay, az);
+
+            uint32_t body = entries[i].body;
+            bodies.accelerationX[body] = gravitationalConstant * ax;
+            bodies.accelerationY[body] = gravitationalConstant * ay;
+            bodies.accelerationZ[body] = gravitationalConstant * az;
+        }
+    }
+}
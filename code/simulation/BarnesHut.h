@@ -0,0 +1,110 @@
+#ifndef BARNES_HUT_H
+#define BARNES_HUT_H
+
+#include "Bodies.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Cell of the octree. The children of a cell are stored next to each other in the node arena
+struct OctreeNode {
+
+    // Center of mass and total mass of the bodies in the cell
+    float centerOfMassX, centerOfMassY, centerOfMassZ;
+    float mass;
+
+    // Squared distance beyond which the cell is far enough to act as a single body:
+    // (size / theta + offset of the center of mass from the center of the cell)^2
+    float openingDistanceSquared;
+
+    // Index of the first child in the arena, and the number of (non-empty) children. Leaves have no children
+    uint32_t firstChild;
+    uint32_t childCount;
+
+    // Range of the cell's bodies in Morton order
+    uint32_t firstBody;
+    uint32_t bodyCount;
+
+};
+
+// Barnes-Hut gravity solver: bodies are sorted along a Morton curve and grouped into an octree, then every body
+// treats each cell that is far enough (size / distance < opening angle) as a single body at its center of mass. O(N log N).
+// Small groups of neighbouring bodies walk the octree together, and sum the resulting interaction list with SSE.
+// The octree is rebuilt every step into arenas that keep their memory between steps, so building allocates no nodes
+class BarnesHutSolver {
+
+public:
+
+    // Constructor: Creates a solver with the given opening angle (theta). 0 is exact, larger values are faster and less accurate
+    explicit BarnesHutSolver(float openingAngle = 0.5f);
+
+    // Opening angle of the solver
+    void setOpeningAngle(float openingAngle);
+    float openingAngle() const;
+
+    // Computes the acceleration of every body. Spreads the sort, the build and the traversal over the pool when given
+    void computeAccelerations(Bodies& bodies, float gravitationalConstant, float softening, ThreadPool* pool);
+
+    // Number of cells of the last octree
+    size_t nodeCount() const;
+
+private:
+
+    // A body with its position on the Morton curve
+    struct MortonEntry {
+        uint64_t key;
+        uint32_t body;
+    };
+
+    // A subtree built by one task into its own arena, then spliced into the main arena
+    struct BuildTask {
+        uint32_t node;
+        uint32_t firstBody;
+        uint32_t lastBody;
+        unsigned int level;
+    };
+
+    // An internal cell above the subtrees
+    struct TopNode {
+        uint32_t node;
+        unsigned int level;
+    };
+
+    float theta;
+
+    // Bodies sorted along the Morton curve, with their positions and masses gathered in that order
+    std::vector<MortonEntry> entries;
+    std::vector<float> sortedX, sortedY, sortedZ, sortedMass;
+
+    // Node arena of the octree. The root is node 0
+    std::vector<OctreeNode> nodes;
+
+    // Arenas of the subtrees built in parallel, and the subtrees themselves
+    std::vector<std::vector<OctreeNode>> taskNodes;
+    std::vector<BuildTask> tasks;
+
+    // Internal cells above the subtrees, children before parents, whose mass is summed after the subtrees are spliced
+    std::vector<TopNode> topNodes;
+
+    // Origin and side length of the root cell
+    float rootX = 0.0f, rootY = 0.0f, rootZ = 0.0f, rootSize = 1.0f;
+
+    // Sorts the bodies along the Morton curve and gathers their positions and masses
+    void sortBodies(const Bodies& bodies, ThreadPool* pool);
+
+    // Builds the octree, splitting it into subtrees built in parallel
+    void buildTree(ThreadPool* pool);
+
+    // Builds the cell covering entries [first, last) into an arena. Cells at 'splitLevel' become tasks instead, when splitting
+    void buildNode(std::vector<OctreeNode>& arena, uint32_t node, uint32_t first, uint32_t last, unsigned int level, unsigned int splitLevel);
+
+    // Sets the mass, center of mass and opening distance of a cell from its bodies or its children
+    void finishNode(std::vector<OctreeNode>& arena, uint32_t node, unsigned int level);
+
+    // Computes the acceleration of the groups of sorted bodies [firstGroup, lastGroup)
+    void traverse(Bodies& bodies, float gravitationalConstant, float softeningSquared, size_t firstGroup, size_t lastGroup) const;
+
+};
+
+#endif
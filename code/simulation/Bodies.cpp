@@ -0,0 +1,42 @@
+#include "Bodies.h"
+
+// Appends a body, growing the padding when the last vector is full
+size_t Bodies::add(const glm::vec3& position, const glm::vec3& velocity, float bodyMass) {
+
+    size_t body = count++;
+
+    // Grow every array by a whole vector of massless bodies at the origin
+    if (body == mass.size()) {
+        size_t newSize = mass.size() + simdWidth;
+        for (std::vector<float>* component : { &positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ,
+                                               &accelerationX, &accelerationY, &accelerationZ, &mass }) {
+            component->resize(newSize, 0.0f);
+        }
+    }
+
+    positionX[body] = position.x;
+    positionY[body] = position.y;
+    positionZ[body] = position.z;
+    velocityX[body] = velocity.x;
+    velocityY[body] = velocity.y;
+    velocityZ[body] = velocity.z;
+    mass[body] = bodyMass;
+    return body;
+}
+
+// Number of bodies including the padding
+size_t Bodies::paddedCount() const {
+    return mass.size();
+}
+
+glm::vec3 Bodies::position(size_t body) const {
+    return glm::vec3(positionX[body], positionY[body], positionZ[body]);
+}
+
+glm::vec3 Bodies::velocity(size_t body) const {
+    return glm::vec3(velocityX[body], velocityY[body], velocityZ[body]);
+}
+
+glm::vec3 Bodies::acceleration(size_t body) const {
+    return glm::vec3(accelerationX[body], accelerationY[body], accelerationZ[body]);
+}
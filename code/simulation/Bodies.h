@@ -0,0 +1,40 @@
+#ifndef BODIES_H
+#define BODIES_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Bodies of a simulation in a structure-of-arrays layout: every component is a separate contiguous array,
+// so that the force kernels load the same component of several bodies at once.
+// The arrays are padded with massless bodies to a multiple of 'simdWidth', so that the kernels only load whole vectors
+struct Bodies {
+
+    // Number of floats processed at once by the force kernels
+    static const size_t simdWidth = 4;
+
+    // Positions, velocities and accelerations, one array per axis
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<float> accelerationX, accelerationY, accelerationZ;
+
+    // Masses. Padding bodies have a mass of 0, so they exert no force
+    std::vector<float> mass;
+
+    // Number of actual bodies, without the padding
+    size_t count = 0;
+
+    // Appends a body and returns its index
+    size_t add(const glm::vec3& position, const glm::vec3& velocity, float bodyMass);
+
+    // Number of bodies including the padding, a multiple of 'simdWidth'
+    size_t paddedCount() const;
+
+    // Position, velocity and acceleration of a body
+    glm::vec3 position(size_t body) const;
+    glm::vec3 velocity(size_t body) const;
+    glm::vec3 acceleration(size_t body) const;
+
+};
+
+#endif
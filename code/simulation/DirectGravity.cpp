@@ -0,0 +1,90 @@
+#include "DirectGravity.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIRECT_GRAVITY_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef DIRECT_GRAVITY_SSE
+
+// Adds up the 4 lanes of a vector
+float horizontalSum(__m128 value) {
+    __m128 shuffled = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(value, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+#endif
+
+}
+
+// Computes the acceleration of the bodies [begin, end) by direct summation
+void computeDirectAccelerations(Bodies& bodies, float gravitationalConstant, float softening, size_t begin, size_t end) {
+
+    const float* positionX = bodies.positionX.data();
+    const float* positionY = bodies.positionY.data();
+    const float* positionZ = bodies.positionZ.data();
+    const float* mass = bodies.mass.data();
+    size_t paddedCount = bodies.paddedCount();
+    float softeningSquared = softening * softening;
+
+    for (size_t i = begin; i < end; ++i) {
+
+#ifdef DIRECT_GRAVITY_SSE
+        __m128 xi = _mm_set1_ps(positionX[i]);
+        __m128 yi = _mm_set1_ps(positionY[i]);
+        __m128 zi = _mm_set1_ps(positionZ[i]);
+        __m128 epsilon = _mm_set1_ps(softeningSquared);
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 zero = _mm_setzero_ps();
+        __m128 ax = zero, ay = zero, az = zero;
+
+        for (size_t j = 0; j < paddedCount; j += Bodies::simdWidth) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(positionX + j), xi);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(positionY + j), yi);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(positionZ + j), zi);
+            __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_add_ps(_mm_mul_ps(dz, dz), epsilon));
+
+            // 1 / r^3, masked to 0 for the body itself (and for padding bodies on top of it), where r is 0
+            __m128 inverseDistance = _mm_div_ps(one, _mm_sqrt_ps(distanceSquared));
+            __m128 inverseCube = _mm_mul_ps(_mm_mul_ps(inverseDistance, inverseDistance), inverseDistance);
+            inverseCube = _mm_and_ps(inverseCube, _mm_cmpgt_ps(distanceSquared, zero));
+
+            __m128 strength = _mm_mul_ps(_mm_loadu_ps(mass + j), inverseCube);
+            ax = _mm_add_ps(ax, _mm_mul_ps(dx, strength));
+            ay = _mm_add_ps(ay, _mm_mul_ps(dy, strength));
+            az = _mm_add_ps(az, _mm_mul_ps(dz, strength));
+        }
+
+        bodies.accelerationX[i] = gravitationalConstant * horizontalSum(ax);
+        bodies.accelerationY[i] = gravitationalConstant * horizontalSum(ay);
+        bodies.accelerationZ[i] = gravitationalConstant * horizontalSum(az);
+#else
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        for (size_t j = 0; j < paddedCount; ++j) {
+            float dx = positionX[j] - positionX[i];
+            float dy = positionY[j] - positionY[i];
+            float dz = positionZ[j] - positionZ[i];
+            float distanceSquared = dx * dx + dy * dy + dz * dz + softeningSquared;
+
+            // Skip the body itself, and padding bodies on top of it
+            if (distanceSquared <= 0.0f) {
+                continue;
+            }
+            float inverseDistance = 1.0f / std::sqrt(distanceSquared);
+            float strength = mass[j] * inverseDistance * inverseDistance * inverseDistance;
+            ax += dx * strength;
+            ay += dy * strength;
+            az += dz * strength;
+        }
+
+        bodies.accelerationX[i] = gravitationalConstant * ax;
+        bodies.accelerationY[i] = gravitationalConstant * ay;
+        bodies.accelerationZ[i] = gravitationalConstant * az;
+#endif
+    }
+}
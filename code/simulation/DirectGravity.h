@@ -0,0 +1,11 @@
+#ifndef DIRECT_GRAVITY_H
+#define DIRECT_GRAVITY_H
+
+#include "Bodies.h"
+
+// Computes the gravitational acceleration of the bodies [begin, end) by summing the pull of every other body.
+// O(N) per body. 'softening' is added to every distance, to keep close encounters finite.
+// Uses SSE when the target supports it, processing 4 pulling bodies at once
+void computeDirectAccelerations(Bodies& bodies, float gravitationalConstant, float softening, size_t begin, size_t end);
+
+#endif
@@ -0,0 +1,155 @@
+#include "Simulation.h"
+#include "DirectGravity.h"
+#include "../threading/ThreadPool.h"
+#include <cmath>
+#include <cstring>
+
+// Constructor: Creates an empty simulation
+Simulation::Simulation(float gravitationalConstant, float softening)
+    : gravity(gravitationalConstant), softening(softening) {
+}
+
+// Selects the gravity solver
+void Simulation::setGravitySolver(GravitySolver gravitySolver, float openingAngle) {
+    solver = gravitySolver;
+    barnesHut.setOpeningAngle(openingAngle);
+    accelerationsValid = false;
+}
+
+// Spreads the force computation over the given pool
+void Simulation::setThreadPool(ThreadPool* pool) {
+    threadPool = pool;
+}
+
+// Adds a body and returns its index
+size_t Simulation::addBody(const glm::vec3& position, const glm::vec3& velocity, float mass) {
+    accelerationsValid = false;
+    return state.add(position, velocity, mass);
+}
+
+// Advances every body with one velocity Verlet (kick-drift-kick) step
+void Simulation::step(float timeStep) {
+
+    // The accelerations of the previous step's end are reused, unless bodies were added since
+    if (!accelerationsValid) {
+        computeAccelerations();
+        accelerationsValid = true;
+    }
+
+    kick(0.5f * timeStep);
+    drift(timeStep);
+    computeAccelerations();
+    kick(0.5f * timeStep);
+}
+
+// Computes the acceleration of every body with the selected solver
+void Simulation::computeAccelerations() {
+
+    if (solver == GravitySolver::BarnesHut) {
+        barnesHut.computeAccelerations(state, gravity, softening, threadPool);
+        return;
+    }
+
+    // Each body's sum is independent, so direct summation splits into ranges of bodies
+    if (threadPool) {
+        threadPool->parallelFor(state.count, 64, [this](size_t begin, size_t end) {
+            computeDirectAccelerations(state, gravity, softening, begin, end);
+        });
+    }
+    else {
+        computeDirectAccelerations(state, gravity, softening, 0, state.count);
+    }
+}
+
+// Adds 'timeStep' times the acceleration to the velocity of every body. The padding is updated too, as it keeps the loops branch-free
+void Simulation::kick(float timeStep) {
+
+    size_t count = state.paddedCount();
+    float* velocityX = state.velocityX.data();
+    float* velocityY = state.velocityY.data();
+    float* velocityZ = state.velocityZ.data();
+    const float* accelerationX = state.accelerationX.data();
+    const float* accelerationY = state.accelerationY.data();
+    const float* accelerationZ = state.accelerationZ.data();
+
+    for (size_t i = 0; i < count; ++i) {
+        velocityX[i] += timeStep * accelerationX[i];
+        velocityY[i] += timeStep * accelerationY[i];
+        velocityZ[i] += timeStep * accelerationZ[i];
+    }
+}
+
+// Adds 'timeStep' times the velocity to the position of every body
+void Simulation::drift(float timeStep) {
+
+    size_t count = state.paddedCount();
+    float* positionX = state.positionX.data();
+    float* positionY = state.positionY.data();
+    float* positionZ = state.positionZ.data();
+    const float* velocityX = state.velocityX.data();
+    const float* velocityY = state.velocityY.data();
+    const float* velocityZ = state.velocityZ.data();
+
+    for (size_t i = 0; i < count; ++i) {
+        positionX[i] += timeStep * velocityX[i];
+        positionY[i] += timeStep * velocityY[i];
+        positionZ[i] += timeStep * velocityZ[i];
+    }
+}
+
+// Number of bodies
+size_t Simulation::bodyCount() const {
+    return state.count;
+}
+
+glm::vec3 Simulation::position(size_t body) const {
+    return state.position(body);
+}
+
+glm::vec3 Simulation::velocity(size_t body) const {
+    return state.velocity(body);
+}
+
+// Every body, for the renderer to read
+const Bodies& Simulation::bodies() const {
+    return state;
+}
+
+// Gravitational constant of the simulation
+float Simulation::gravitationalConstant() const {
+    return gravity;
+}
+
+// FNV-1a hash of the bits of every position and velocity
+unsigned long long Simulation::stateHash() const {
+
+    unsigned long long hash = 14695981039346656037ULL;
+    const std::vector<float>* components[] = { &state.positionX, &state.positionY, &state.positionZ, &state.velocityX, &state.velocityY, &state.velocityZ };
+    for (const std::vector<float>* component : components) {
+        for (size_t i = 0; i < state.count; ++i) {
+            unsigned int bits;
+            std::memcpy(&bits, &(*component)[i], sizeof(bits));
+            for (int byte = 0; byte < 4; ++byte) {
+                hash = (hash ^ ((bits >> (8 * byte)) & 0xff)) * 1099511628211ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+// Kinetic plus potential energy, with the same softening as the forces
+double Simulation::totalEnergy() const {
+
+    double kinetic = 0.0, potential = 0.0;
+    for (size_t i = 0; i < state.count; ++i) {
+        glm::dvec3 velocity(state.velocity(i));
+        kinetic += 0.5 * state.mass[i] * glm::dot(velocity, velocity);
+
+        for (size_t j = i + 1; j < state.count; ++j) {
+            glm::dvec3 offset = glm::dvec3(state.position(j)) - glm::dvec3(state.position(i));
+            double distance = std::sqrt(glm::dot(offset, offset) + static_cast<double>(softening) * softening);
+            potential -= static_cast<double>(gravity) * state.mass[i] * state.mass[j] / distance;
+        }
+    }
+    return kinetic + potential;
+}
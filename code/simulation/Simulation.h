@@ -0,0 +1,86 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Bodies.h"
+#include "BarnesHut.h"
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+// How the simulation sums the pull of the bodies
+enum class GravitySolver {
+    // Every pair of bodies, O(N^2). Exact
+    Direct,
+    // Barnes-Hut octree, O(N log N). Approximate, controlled by the opening angle
+    BarnesHut
+};
+
+// Gravitational N-body simulation. Bodies attract each other pairwise and are integrated with velocity Verlet,
+// a symplectic scheme that keeps the energy of orbits bounded over long runs. Needs no GL context
+class Simulation {
+
+public:
+
+    // Constructor: Creates an empty simulation. 'softening' is added to every distance, to keep close encounters finite
+    explicit Simulation(float gravitationalConstant = 1.0f, float softening = 0.0f);
+
+    // Selects the gravity solver. 'openingAngle' is only used by the Barnes-Hut solver
+    void setGravitySolver(GravitySolver solver, float openingAngle = 0.5f);
+
+    // Spreads the force computation over the given pool. nullptr (the default) computes on the calling thread
+    void setThreadPool(ThreadPool* pool);
+
+    // Adds a body and returns its index
+    size_t addBody(const glm::vec3& position, const glm::vec3& velocity, float mass);
+
+    // Advances every body by 'timeStep' seconds
+    void step(float timeStep);
+
+    // Number of bodies
+    size_t bodyCount() const;
+
+    // Position and velocity of a body
+    glm::vec3 position(size_t body) const;
+    glm::vec3 velocity(size_t body) const;
+
+    // Every body, for the renderer to read
+    const Bodies& bodies() const;
+
+    // Kinetic plus potential energy of the bodies, accumulated in double precision. O(N^2), meant for validation
+    double totalEnergy() const;
+
+    // Gravitational constant of the simulation
+    float gravitationalConstant() const;
+
+    // Hash of the bits of every position and velocity. Two runs have the same hash only if their states are bit-identical
+    unsigned long long stateHash() const;
+
+private:
+
+    // Bodies in a structure-of-arrays layout
+    Bodies state;
+
+    // Gravitational constant and softening length
+    float gravity;
+    float softening;
+
+    // Gravity solver, its octree, and the pool running it
+    GravitySolver solver = GravitySolver::Direct;
+    BarnesHutSolver barnesHut;
+    ThreadPool* threadPool = nullptr;
+
+    // Whether the accelerations match the current positions. Adding a body invalidates them
+    bool accelerationsValid = false;
+
+    // Computes the acceleration of every body from the current positions
+    void computeAccelerations();
+
+    // Adds 'timeStep' times the acceleration to the velocity of every body
+    void kick(float timeStep);
+
+    // Adds 'timeStep' times the velocity to the position of every body
+    void drift(float timeStep);
+
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "SimulationBenchmark.h"
+#include "BarnesHut.h"
+#include "DirectGravity.h"
+#include "../threading/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+namespace {
+
+// Time spent stepping each cluster, in seconds
+const double benchmarkDuration = 1.0;
+
+// Radius, total mass and softening length of the clusters, and the time step
+const float clusterRadius = 10.0f;
+const float clusterMass = 1.0f;
+const float clusterSoftening = 0.05f;
+const float clusterTimeStep = 0.001f;
+
+// Number of bodies whose accelerations are checked against direct summation
+const size_t accuracySampleSize = 2000;
+
+// Opening angles compared by the accuracy benchmark
+const float accuracyOpeningAngles[] = { 0.2f, 0.3f, 0.5f, 0.7f, 1.0f };
+
+// Fills 'bodies' with bodies spread uniformly in a sphere, at rest. The seed is fixed, so every run uses the same cluster
+void makeCluster(Bodies& bodies, size_t bodyCount) {
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    float bodyMass = clusterMass / static_cast<float>(bodyCount);
+
+    while (bodies.count < bodyCount) {
+        glm::vec3 position(coordinate(generator), coordinate(generator), coordinate(generator));
+        if (glm::dot(position, position) <= 1.0f) {
+            bodies.add(clusterRadius * position, glm::vec3(0.0f), bodyMass);
+        }
+    }
+}
+
+// Seconds elapsed since 'start'
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+// Steps random clusters of the given sizes and prints their throughput
+void runSimulationBenchmark(const std::vector<size_t>& bodyCounts, GravitySolver solver, float openingAngle, ThreadPool* pool, std::ostream& stream) {
+
+    stream << "Simulation solver: " << (solver == GravitySolver::BarnesHut ? "Barnes-Hut" : "direct");
+    if (solver == GravitySolver::BarnesHut) {
+        stream << ", theta " << openingAngle;
+    }
+    stream << ", " << (pool ? pool->threadCount() : 1) << " thread(s)" << std::endl;
+
+    for (size_t bodyCount : bodyCounts) {
+
+        Bodies cluster;
+        makeCluster(cluster, bodyCount);
+
+        Simulation simulation(1.0f, clusterSoftening);
+        simulation.setGravitySolver(solver, openingAngle);
+        simulation.setThreadPool(pool);
+        for (size_t i = 0; i < cluster.count; ++i) {
+            simulation.addBody(cluster.position(i), glm::vec3(0.0f), cluster.mass[i]);
+        }
+
+        // The first step also computes the initial accelerations, so leave it out of the measurement
+        simulation.step(clusterTimeStep);
+
+        unsigned int steps = 0;
+        double elapsed = 0.0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (elapsed < benchmarkDuration || steps < 2) {
+            simulation.step(clusterTimeStep);
+            ++steps;
+            elapsed = secondsSince(start);
+        }
+
+        // For Barnes-Hut, interactions are the pairs direct summation would have needed for the same step
+        double stepsPerSecond = steps / elapsed;
+        double bodiesPerSecond = stepsPerSecond * static_cast<double>(bodyCount);
+        double interactionsPerSecond = bodiesPerSecond * static_cast<double>(bodyCount);
+        stream << std::fixed << std::setprecision(2)
+               << "Simulation: " << bodyCount << " bodies, " << steps << " steps, "
+               << stepsPerSecond << " steps/s, "
+               << bodiesPerSecond / 1.0e6 << " million bodies/s, "
+               << interactionsPerSecond / 1.0e9 << " billion interactions/s"
+               << std::defaultfloat << std::endl;
+    }
+}
+
+// Measures the error of the Barnes-Hut solver against direct summation, for every opening angle
+void runBarnesHutAccuracy(size_t bodyCount, ThreadPool* pool, std::ostream& stream) {
+
+    Bodies cluster;
+    makeCluster(cluster, bodyCount);
+
+    // Reference accelerations of the first bodies, which are as random as any others
+    size_t sampleSize = std::min(bodyCount, accuracySampleSize);
+    Bodies reference = cluster;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    computeDirectAccelerations(reference, 1.0f, clusterSoftening, 0, sampleSize);
+    double directSeconds = secondsSince(start) * static_cast<double>(bodyCount) / static_cast<double>(sampleSize);
+
+    stream << std::fixed << std::setprecision(3)
+           << "Barnes-Hut accuracy: " << bodyCount << " bodies, " << (pool ? pool->threadCount() : 1) << " thread(s), "
+           << "direct summation " << directSeconds * 1000.0 << " ms per step (single thread, estimated from "
+           << sampleSize << " bodies)" << std::endl;
+
+    std::vector<double> errors(sampleSize);
+    for (float openingAngle : accuracyOpeningAngles) {
+
+        // The second computation reuses the arenas of the first, as in a running simulation
+        BarnesHutSolver solver(openingAngle);
+        Bodies approximate = cluster;
+        solver.computeAccelerations(approximate, 1.0f, clusterSoftening, pool);
+        start = std::chrono::steady_clock::now();
+        solver.computeAccelerations(approximate, 1.0f, clusterSoftening, pool);
+        double seconds = secondsSince(start);
+
+        for (size_t i = 0; i < sampleSize; ++i) {
+            glm::vec3 exact = reference.acceleration(i);
+            glm::vec3 difference = approximate.acceleration(i) - exact;
+            errors[i] = std::sqrt(static_cast<double>(glm::dot(difference, difference)) / static_cast<double>(glm::dot(exact, exact)));
+        }
+        std::sort(errors.begin(), errors.end());
+
+        stream << "  theta " << std::setprecision(1) << openingAngle << std::setprecision(3)
+               << ": relative error median " << errors[sampleSize / 2] * 100.0
+               << " %, p99 " << errors[std::min(sampleSize - 1, sampleSize * 99 / 100)] * 100.0
+               << " %, max " << errors.back() * 100.0
+               << " %, " << seconds * 1000.0 << " ms per step, " << solver.nodeCount() << " cells" << std::endl;
+    }
+    stream << std::defaultfloat;
+}
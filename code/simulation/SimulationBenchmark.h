@@ -0,0 +1,19 @@
+#ifndef SIMULATION_BENCHMARK_H
+#define SIMULATION_BENCHMARK_H
+
+#include "Simulation.h"
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+class ThreadPool;
+
+// Steps random star clusters of the given sizes without any GL context and prints the throughput of each:
+// steps per second, bodies advanced per second and pairwise interactions per second (or their direct-summation equivalent)
+void runSimulationBenchmark(const std::vector<size_t>& bodyCounts, GravitySolver solver, float openingAngle, ThreadPool* pool, std::ostream& stream);
+
+// Compares the Barnes-Hut accelerations of a random cluster to direct summation, for a range of opening angles,
+// and prints the relative error (median, 99th percentile, maximum) and the time of each
+void runBarnesHutAccuracy(size_t bodyCount, ThreadPool* pool, std::ostream& stream);
+
+#endif
@@ -0,0 +1,182 @@
+#include "SimulationThread.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Seconds of the steady clock since its epoch
+double steadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+// Position of a body interpolated between the last two steps
+glm::vec3 SimulationSnapshot::position(size_t body, float alpha) const {
+    return previousPositions[body] + alpha * (positions[body] - previousPositions[body]);
+}
+
+// Simulated time interpolated between the last two steps
+double SimulationSnapshot::interpolatedTime(float alpha) const {
+    return previousTime + alpha * (time - previousTime);
+}
+
+// Constructor: Publishes the initial positions, and picks them up for the renderer
+SimulationThread::SimulationThread(Simulation& simulation, double timeStep)
+    : simulation(simulation), clock(timeStep) {
+    publish();
+    snapshots.update();
+}
+
+// Starts stepping on a dedicated thread
+void SimulationThread::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+// Stops and joins the thread
+void SimulationThread::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool SimulationThread::isRunning() const {
+    return running;
+}
+
+// Steps on the calling thread
+void SimulationThread::advance(double elapsedRealTime) {
+    stepBy(elapsedRealTime);
+}
+
+void SimulationThread::setPaused(bool isPaused) {
+    paused = isPaused;
+}
+
+bool SimulationThread::isPaused() const {
+    return paused;
+}
+
+void SimulationThread::setTimeWarp(double timeWarp) {
+    warp = timeWarp;
+}
+
+double SimulationThread::timeWarp() const {
+    return warp;
+}
+
+// Picks up the latest snapshot
+bool SimulationThread::update() {
+    return snapshots.update();
+}
+
+const SimulationSnapshot& SimulationThread::snapshot() const {
+    return snapshots.readSlot();
+}
+
+// How far to interpolate the snapshot's positions
+float SimulationThread::interpolationAlpha() const {
+
+    // Stepped on this thread: the clock is up to date
+    if (!running) {
+        return static_cast<float>(clock.alpha());
+    }
+
+    // Stepped on its own thread: add the time elapsed since the snapshot was published
+    const SimulationSnapshot& latest = snapshots.readSlot();
+    double lag = latest.lag;
+    if (!paused) {
+        lag += (steadySeconds() - latest.publishTime) * warp;
+    }
+    return static_cast<float>(std::min(lag / clock.timeStep(), 1.0));
+}
+
+unsigned long SimulationThread::stepCount() const {
+    return steps;
+}
+
+double SimulationThread::busySeconds() const {
+    return static_cast<double>(busyNanoseconds) * 1.0e-9;
+}
+
+// Steps in real time, sleeping until the next step is due
+void SimulationThread::run() {
+
+    std::chrono::steady_clock::time_point lastTime = std::chrono::steady_clock::now();
+    while (running) {
+
+        std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+        stepBy(std::chrono::duration<double>(currentTime - lastTime).count());
+        lastTime = currentTime;
+
+        // Wake up when the next step is due, in real time. When the steps are slower than real time, this is right away
+        double warpFactor = std::max(static_cast<double>(warp), 1.0e-3);
+        double untilNextStep = (clock.timeStep() - clock.lag()) / warpFactor;
+        std::this_thread::sleep_until(currentTime + std::chrono::duration<double>(std::min(untilNextStep, 0.01)));
+    }
+}
+
+// Takes the steps due and publishes the result
+void SimulationThread::stepBy(double elapsedRealTime) {
+
+    clock.setPaused(paused);
+    clock.setTimeWarp(warp);
+    unsigned int dueSteps = clock.advance(elapsedRealTime);
+    if (dueSteps == 0) {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    SimulationSnapshot& slot = snapshots.writeSlot();
+    const Bodies& bodies = simulation.bodies();
+    float timeStep = static_cast<float>(clock.timeStep());
+    for (unsigned int i = 0; i < dueSteps; ++i) {
+
+        // Keep the positions before the last step, to interpolate from
+        if (i + 1 == dueSteps) {
+            slot.previousPositions.resize(bodies.count);
+            for (size_t body = 0; body < bodies.count; ++body) {
+                slot.previousPositions[body] = bodies.position(body);
+            }
+        }
+        simulation.step(timeStep);
+        ++steps;
+    }
+    busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    slot.previousTime = clock.simulatedTime() - clock.timeStep();
+    publish();
+}
+
+// Copies the positions into the write slot and publishes it. The slot's vectors keep their memory, so publishing allocates nothing
+void SimulationThread::publish() {
+
+    SimulationSnapshot& slot = snapshots.writeSlot();
+    const Bodies& bodies = simulation.bodies();
+    slot.positions.resize(bodies.count);
+    for (size_t i = 0; i < bodies.count; ++i) {
+        slot.positions[i] = bodies.position(i);
+    }
+
+    // Before the first step, there is no previous state to interpolate from
+    slot.time = clock.simulatedTime();
+    if (slot.previousPositions.size() != bodies.count) {
+        slot.previousPositions = slot.positions;
+        slot.previousTime = slot.time;
+    }
+
+    slot.step = clock.stepCount();
+    slot.lag = clock.lag();
+    slot.publishTime = steadySeconds();
+    snapshots.publish();
+}
+
+// Destructor: Stops the thread
+SimulationThread::~SimulationThread() {
+    stop();
+}
@@ -0,0 +1,111 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include "Simulation.h"
+#include "../threading/TripleBuffer.h"
+#include "../time/SimulationClock.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Positions of the bodies after the last two steps of a simulation, as handed to the renderer
+struct SimulationSnapshot {
+
+    // Positions before and after the last step
+    std::vector<glm::vec3> previousPositions;
+    std::vector<glm::vec3> positions;
+
+    // Simulated time before and after the last step, and the number of steps taken when the snapshot was published
+    double previousTime = 0.0;
+    double time = 0.0;
+    unsigned long step = 0;
+
+    // Simulated time left over after the last step, and the steady-clock time of the publication in seconds
+    double lag = 0.0;
+    double publishTime = 0.0;
+
+    // Position of a body interpolated between the last two steps, 'alpha' going from 0 (previous) to 1 (last)
+    glm::vec3 position(size_t body, float alpha) const;
+
+    // Simulated time interpolated the same way, to animate what the simulation does not move, such as the spin of the bodies
+    double interpolatedTime(float alpha) const;
+
+};
+
+// Steps a simulation by a SimulationClock, either on its own thread at its own rate (start()) or on the caller's
+// thread (advance()). Each batch of steps publishes a snapshot of the positions through a triple buffer, which the
+// render loop picks up without ever waiting for the simulation
+class SimulationThread {
+
+public:
+
+    // Constructor: Publishes the initial positions. The simulation must not be touched elsewhere while the thread runs
+    SimulationThread(Simulation& simulation, double timeStep);
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Starts stepping on a dedicated thread, in real time
+    void start();
+
+    // Stops and joins the thread
+    void stop();
+
+    // Whether the dedicated thread is running
+    bool isRunning() const;
+
+    // Steps by 'elapsedRealTime' seconds on the calling thread. Only when the dedicated thread is not running
+    void advance(double elapsedRealTime);
+
+    // Pauses or resumes the simulated time
+    void setPaused(bool paused);
+    bool isPaused() const;
+
+    // Simulated seconds per real second
+    void setTimeWarp(double warp);
+    double timeWarp() const;
+
+    // Picks up the latest snapshot, if a new one was published. Never blocks. Render thread only
+    bool update();
+
+    // Snapshot picked up by the last update(). Render thread only
+    const SimulationSnapshot& snapshot() const;
+
+    // How far to interpolate the snapshot's positions for a frame drawn now, from 0 to 1. Render thread only
+    float interpolationAlpha() const;
+
+    // Number of steps taken, and wall-clock seconds spent inside them
+    unsigned long stepCount() const;
+    double busySeconds() const;
+
+    // Destructor: Stops the thread
+    ~SimulationThread();
+
+private:
+
+    Simulation& simulation;
+
+    // Owned by the thread stepping the simulation, which copies the pause and time warp into it before each advance
+    SimulationClock clock;
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> paused{ false };
+    std::atomic<double> warp{ 1.0 };
+    std::atomic<unsigned long> steps{ 0 };
+    std::atomic<long long> busyNanoseconds{ 0 };
+
+    TripleBuffer<SimulationSnapshot> snapshots;
+
+    // Main function of the dedicated thread
+    void run();
+
+    // Takes the steps due after 'elapsedRealTime' seconds and publishes the result
+    void stepBy(double elapsedRealTime);
+
+    // Copies the current positions into the write slot and publishes it
+    void publish();
+
+};
+
+#endif
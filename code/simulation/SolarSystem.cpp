@@ -0,0 +1,115 @@
+#include "SolarSystem.h"
+#include <cmath>
+#include <random>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+
+// Masses, with a gravitational constant of 1. The Earth orbits the Sun in about 10 seconds and the Moon orbits the Earth in about 1.4 seconds
+const float sunMass = 5.6f;
+const float earthMass = 0.56f;
+const float moonMass = 0.006f;
+
+// Radius of the Earth's orbit around the Sun and of the Moon's orbit around the Earth
+const float earthOrbitRadius = 2.5f;
+const float moonOrbitRadius = 0.3f;
+
+// Mean distance between the centers of the Earth and the Moon, and length of an AU, in kilometers
+const double moonMeanDistance = 385000.56;
+const double astronomicalUnit = 149597870.7;
+
+// Scene coordinates of ecliptic coordinates: the ecliptic's x stays x, its north pole becomes y, and its y becomes -z, a rotation
+// that keeps the planets turning counterclockwise seen from the north
+glm::vec3 sceneFromEcliptic(const glm::vec3& ecliptic) {
+    return glm::vec3(ecliptic.x, ecliptic.z, -ecliptic.y);
+}
+
+// Starting angle of the Earth on its orbit, and inclination of the Moon's orbit to the Earth's, in degrees
+const float earthStartAngle = 10.0f;
+const float moonInclination = 20.0f;
+
+// Inner and outer radius of the asteroid belt, and its thickness
+const float beltInnerRadius = 3.5f;
+const float beltOuterRadius = 4.5f;
+const float beltThickness = 0.2f;
+
+// Speed of a circular orbit of the given radius around a total mass
+float circularSpeed(float gravitationalConstant, float totalMass, float radius) {
+    return std::sqrt(gravitationalConstant * totalMass / radius);
+}
+
+}
+
+// Adds the Sun, Earth and Moon to the simulation on circular orbits
+SolarSystemBodies addSolarSystem(Simulation& simulation) {
+
+    float gravity = simulation.gravitationalConstant();
+
+    // The Earth and Moon orbit their common center of mass, which orbits the Sun in the xz-plane
+    float angle = glm::radians(earthStartAngle);
+    glm::vec3 pairDirection(std::cos(angle), 0.0f, std::sin(angle));
+    glm::vec3 pairOrbitDirection(-std::sin(angle), 0.0f, std::cos(angle));
+    float pairMass = earthMass + moonMass;
+    glm::vec3 pairPosition = earthOrbitRadius * pairDirection;
+    glm::vec3 pairVelocity = circularSpeed(gravity, sunMass + pairMass, earthOrbitRadius) * pairOrbitDirection;
+
+    // The Moon starts beyond the Earth, on an orbit tilted around the Sun-Earth line
+    float inclination = glm::radians(moonInclination);
+    glm::vec3 moonOrbitDirection = std::cos(inclination) * pairOrbitDirection + std::sin(inclination) * glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 moonOffset = moonOrbitRadius * pairDirection;
+    glm::vec3 moonRelativeVelocity = circularSpeed(gravity, pairMass, moonOrbitRadius) * moonOrbitDirection;
+
+    // Split the Earth-Moon offset and relative velocity around the pair's center of mass
+    glm::vec3 earthPosition = pairPosition - (moonMass / pairMass) * moonOffset;
+    glm::vec3 moonPosition = pairPosition + (earthMass / pairMass) * moonOffset;
+    glm::vec3 earthVelocity = pairVelocity - (moonMass / pairMass) * moonRelativeVelocity;
+    glm::vec3 moonVelocity = pairVelocity + (earthMass / pairMass) * moonRelativeVelocity;
+
+    // Shift everything so that the center of mass is at rest at the origin
+    float totalMass = sunMass + pairMass;
+    glm::vec3 centerOfMass = (pairMass / totalMass) * pairPosition;
+    glm::vec3 centerOfMassVelocity = (pairMass / totalMass) * pairVelocity;
+
+    SolarSystemBodies bodies;
+    bodies.sun = simulation.addBody(-centerOfMass, -centerOfMassVelocity, sunMass);
+    bodies.earth = simulation.addBody(earthPosition - centerOfMass, earthVelocity - centerOfMassVelocity, earthMass);
+    bodies.moon = simulation.addBody(moonPosition - centerOfMass, moonVelocity - centerOfMassVelocity, moonMass);
+    return bodies;
+}
+
+// Adds massless asteroids on circular orbits around the whole system
+size_t addAsteroidBelt(Simulation& simulation, size_t asteroidCount, unsigned int seed) {
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> radius(beltInnerRadius, beltOuterRadius);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    std::uniform_real_distribution<float> height(-0.5f * beltThickness, 0.5f * beltThickness);
+
+    // Beyond the Earth, the Sun, Earth and Moon pull like a single body at the origin
+    float gravity = simulation.gravitationalConstant();
+    float totalMass = sunMass + earthMass + moonMass;
+
+    size_t first = simulation.bodyCount();
+    for (size_t i = 0; i < asteroidCount; ++i) {
+        float r = radius(generator);
+        float a = angle(generator);
+        glm::vec3 direction(std::cos(a), 0.0f, std::sin(a));
+        glm::vec3 orbitDirection(-std::sin(a), 0.0f, std::cos(a));
+        glm::vec3 position = r * direction + glm::vec3(0.0f, height(generator), 0.0f);
+        simulation.addBody(position, circularSpeed(gravity, totalMass, r) * orbitDirection, 0.0f);
+    }
+    return first;
+}
+
+// Places the bodies of an ephemeris in the scene
+SolarSystemPlacement ephemerisPlacement(const EphemerisState& state) {
+
+    SolarSystemPlacement placement;
+    placement.sun = glm::vec3(0.0f);
+    placement.earth = earthOrbitRadius * sceneFromEcliptic(state.earth);
+
+    // Scale the geocentric offset of the Moon from its mean distance to the radius of the simulated orbit
+    float moonScale = static_cast<float>(moonOrbitRadius * astronomicalUnit / moonMeanDistance);
+    placement.moon = placement.earth + moonScale * sceneFromEcliptic(state.moon - state.earth);
+    return placement;
+}
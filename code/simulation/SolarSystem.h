@@ -0,0 +1,38 @@
+#ifndef SOLAR_SYSTEM_H
+#define SOLAR_SYSTEM_H
+
+#include "Simulation.h"
+#include "../ephemeris/Ephemeris.h"
+
+// Indices of the bodies of the solar system in the simulation
+struct SolarSystemBodies {
+    size_t sun;
+    size_t earth;
+    size_t moon;
+};
+
+// Adds the Sun, Earth and Moon to the simulation, on circular orbits with zero total momentum, so that the
+// system's center of mass stays at the origin. Masses are scaled to the scene: the Earth is a tenth of the Sun,
+// heavy enough to hold the Moon at a visible distance, so the Sun visibly wobbles around the origin
+SolarSystemBodies addSolarSystem(Simulation& simulation);
+
+// Adds massless asteroids on circular orbits in a belt beyond the Earth's orbit. They follow the Sun and planets
+// without pulling them, so they only add to the cost of a step. Returns the index of the first asteroid
+size_t addAsteroidBelt(Simulation& simulation, size_t asteroidCount, unsigned int seed);
+
+// Days of the ephemeris that pass in one second of simulated time, so that the Earth goes around the Sun in about 10 seconds, as in the simulation
+const double ephemerisDaysPerSecond = 36.525;
+
+// Positions of the Sun, Earth and Moon in the scene
+struct SolarSystemPlacement {
+    glm::vec3 sun;
+    glm::vec3 earth;
+    glm::vec3 moon;
+};
+
+// Places the Sun, Earth and Moon of an ephemeris in the scene: the Sun at the origin, the ecliptic of J2000 in the xz-plane with its
+// north pole up, and an AU at the radius of the simulated Earth's orbit. The Moon keeps its direction from the Earth, but its distance is
+// exaggerated to the simulated Moon's orbit, like the sizes of the bodies
+SolarSystemPlacement ephemerisPlacement(const EphemerisState& state);
+
+#endif
@@ -3,58 +3,78 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <assimp/scene.h>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
+#include "../resources/ResourceCache.h"
+#include "../mesh/LevelOfDetail.h"
+#include "../render/IndirectRenderer.h"
+#include "../render/RenderQueue.h"
+#include "../scene/BatchTransform.h"
 
 class SunModel {
 
 public:
 
-    // Constructor: Initializes a new instance of SunModel with paths for model, shaders, and texture
-    SunModel(const std::string& modelPath, const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& texturePath);
+    // Constructor: Initializes a new instance of SunModel with paths for model and texture, and its material, loaded through the resource cache
+    SunModel(ResourceCache& resources, const std::string& modelPath, Material material, const std::string& texturePath);
     
-    // Renders the sun model
-    void render(const glm::mat4& viewMatrix);
+    // Models hold references to shared resources, so they cannot be copied
+    SunModel(const SunModel&) = delete;
+    SunModel& operator=(const SunModel&) = delete;
 
-    // Destructor: Cleans up resources
-    ~SunModel();
+    // Places the mesh around the sun's position as body 'index' of the batch, to be placed with the other bodies by computeBatchTransforms()
+    void placeMesh(TransformBatch& batch, size_t index, const glm::vec3& position) const;
 
-private:
+    // Sphere enclosing the mesh in model coordinates, for culling
+    const BoundingSphere& bounds() const;
+
+    // Chooses the level of detail drawn by render(), from the model's bounding sphere in world coordinates
+    void selectLevel(const LevelOfDetailView& view, const BoundingSphere& worldBounds);
+
+    // Number of triangles drawn by render()
+    unsigned int triangleCount() const;
+
+    // Largest error of the mesh's quantized positions, as a fraction of its bounding radius. 0 for meshes of floats
+    float quantizationError() const;
 
-    // Stores the vertex data of the model
-    std::vector<float> vertices;
+    // Whether the mesh and the texture are uploaded. Models requested while the asset loader runs are drawn only once they are
+    bool isLoaded() const;
 
-    // OpenGL identifiers for Vertex Array Object and Vertex Buffer Object
-    unsigned int VAO, VBO;
+    // Submits the sun model to the render queue with the transform computed from its placeMesh(). It is drawn by the queue's execute(), with
+    // the camera of the shared camera uniform buffer
+    void render(RenderQueue& queue, const BodyTransform& transform) const;
 
-    // Number of vertices, set during processMesh() and used in render()
-    unsigned int vertexCount; 
+    // Queues the selected level of detail with the transform computed from its placeMesh(), to be drawn by the renderer's next submit()
+    void queueDraw(IndirectRenderer& renderer, const BodyTransform& transform) const;
 
-    // OpenGL identifier for the texture
-    unsigned int texture;
+    // Destructor: Cleans up resources
+    ~SunModel();
+
+private:
 
-    // Identifier for the compiled and linked shader program
-    unsigned int shaderProgram;
+    // Cache that owns the shared mesh, texture and shader program
+    ResourceCache& resources;
 
-    // Loads the model from a given file path
-    void loadModel(const std::string& path);
+    // Mesh of the model, shared with every model loaded from the same file
+    const MeshResource* mesh;
 
-    // Compiles and links the vertex and fragment shaders
-    void compileShaders(const std::string& vertexPath, const std::string& fragmentPath);
+    // Texture of the model, shared with every model using the same image
+    const TextureResource* texture;
 
-    // Loads a texture from a given file path
-    void loadTexture(const std::string& texturePath);
+    // Material of the model, and its program, shared with every model of the same material
+    Material material;
+    const ProgramResource* program;
 
-    // Sets up the transformation matrices for the model
-    void setupMatrices();
+    // Level of detail of the mesh drawn by render(), kept between frames for hysteresis
+    unsigned int level = 0;
 
-    // Processes an individual mesh of the model
-    void processMesh(aiMesh* mesh, const aiScene* scene);
+    // Offset of the mesh from the sun's position, and its scale, set once in setupMatrices()
+    glm::vec3 meshOffset;
+    float meshScale;
 
-    // Sets up the vertex buffers and attributes
-    void setupBuffers();
+    // Sets up the placement of the mesh
+    void setupMatrices();
 
 };
 
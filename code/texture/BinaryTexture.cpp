@@ -0,0 +1,125 @@
+#include "BinaryTexture.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char binaryTextureMagic[4] = { 'S', 'S', 'B', 'T' };
+
+// Rounds an offset up to the next multiple of 16 bytes
+uint64_t alignOffset(uint64_t offset) {
+    return (offset + 15) & ~static_cast<uint64_t>(15);
+}
+
+}
+
+// Writes a cooked texture into a binary texture file. The file is written under a temporary name and renamed,
+// so that a crash never leaves a truncated cache behind
+bool writeBinaryTexture(const std::string& path, const TextureData& texture, const SourceFingerprint& source) {
+
+    if (texture.levels.empty() || texture.levels.size() > binaryTextureMaxLevels) {
+        std::cerr << "ERROR::BINARY_TEXTURE::TOO_MANY_LEVELS: " << path << std::endl;
+        return false;
+    }
+
+    BinaryTextureHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binaryTextureMagic, sizeof(header.magic));
+    header.version = binaryTextureVersion;
+    header.source = source;
+    header.internalFormat = texture.internalFormat;
+    header.format = texture.format;
+    header.levelCount = static_cast<uint32_t>(texture.levels.size());
+    header.dataOffset = alignOffset(sizeof(BinaryTextureHeader));
+    header.dataBytes = texture.bytes.size();
+    std::copy(texture.levels.begin(), texture.levels.end(), header.levels);
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "ERROR::BINARY_TEXTURE::CANNOT_WRITE: " << temporaryPath << std::endl;
+            return false;
+        }
+
+        static const char zeros[16] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+        file.write(reinterpret_cast<const char*>(texture.bytes.data()), static_cast<std::streamsize>(header.dataBytes));
+
+        if (!file) {
+            std::cerr << "ERROR::BINARY_TEXTURE::CANNOT_WRITE: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "ERROR::BINARY_TEXTURE::CANNOT_RENAME: " << temporaryPath << " " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+// Maps the binary texture and validates it against its source image
+bool BinaryTexture::open(const std::string& path, const std::string& sourcePath) {
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // Check that the header, the blob and every level fit in the file
+    const BinaryTextureHeader& textureHeader = header();
+    bool valid = file.size() >= sizeof(BinaryTextureHeader)
+        && std::memcmp(textureHeader.magic, binaryTextureMagic, sizeof(textureHeader.magic)) == 0
+        && textureHeader.version == binaryTextureVersion
+        && isRangeInFile(textureHeader.dataOffset, textureHeader.dataBytes, file.size())
+        && textureHeader.levelCount >= 1 && textureHeader.levelCount <= binaryTextureMaxLevels;
+    for (uint32_t i = 0; valid && i < textureHeader.levelCount; ++i) {
+        valid = isRangeInFile(textureHeader.levels[i].offset, textureHeader.levels[i].bytes, textureHeader.dataBytes);
+    }
+    if (!valid) {
+        std::cerr << "ERROR::BINARY_TEXTURE::INVALID: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    SourceFingerprint current;
+    if (!isSourceUnchanged(sourcePath, textureHeader.source, current)) {
+        file.close();
+        return false;
+    }
+
+    // Only the modification time of the image changed: store the new one, with the file unmapped while it is written
+    if (current.modifiedTime != textureHeader.source.modifiedTime) {
+        file.close();
+        updateFingerprint(path, offsetof(BinaryTextureHeader, source), current);
+        if (!file.open(path)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Header of the mapped file
+const BinaryTextureHeader& BinaryTexture::header() const {
+    return *reinterpret_cast<const BinaryTextureHeader*>(file.data());
+}
+
+// Start of the blob of levels inside the mapping
+const unsigned char* BinaryTexture::levelData() const {
+    return file.data() + header().dataOffset;
+}
+
+// Levels stored in the header
+std::vector<TextureLevel> BinaryTexture::levels() const {
+    return std::vector<TextureLevel>(header().levels, header().levels + header().levelCount);
+}
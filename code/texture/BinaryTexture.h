@@ -0,0 +1,71 @@
+#ifndef BINARY_TEXTURE_H
+#define BINARY_TEXTURE_H
+
+#include "TextureData.h"
+#include "../mesh/BinaryMesh.h"
+#include "../resources/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Version of the binary texture format. Files of any other version are treated as stale
+const uint32_t binaryTextureVersion = 1;
+
+// Maximum number of levels stored in a binary texture, enough for images of 32768 x 32768 texels
+const uint32_t binaryTextureMaxLevels = 16;
+
+// Header at the start of a binary texture file. The levels follow in one blob at a 16-byte aligned offset
+struct BinaryTextureHeader {
+
+    // "SSBT"
+    char magic[4];
+
+    // Must equal binaryTextureVersion
+    uint32_t version;
+
+    // Fingerprint of the image, used to detect stale caches
+    SourceFingerprint source;
+
+    // Formats of the levels, as in TextureData
+    uint32_t internalFormat;
+    uint32_t format;
+
+    // Number of used entries in 'levels'
+    uint32_t levelCount;
+
+    // Location and size of the blob of levels, from the start of the file
+    uint64_t dataOffset;
+    uint64_t dataBytes;
+
+    // Levels of the mip chain, with their offsets from the start of the blob. Level 0 is the full image
+    TextureLevel levels[binaryTextureMaxLevels];
+
+};
+
+// Writes a cooked texture into a binary texture file
+bool writeBinaryTexture(const std::string& path, const TextureData& texture, const SourceFingerprint& source);
+
+// A binary texture file mapped into memory. The levels are uploaded straight from the mapping
+class BinaryTexture {
+
+public:
+
+    // Maps the binary texture and validates it against its source image. Returns false if it is missing, corrupt or stale
+    bool open(const std::string& path, const std::string& sourcePath);
+
+    // Header of the mapped file
+    const BinaryTextureHeader& header() const;
+
+    // Start of the blob of levels inside the mapping
+    const unsigned char* levelData() const;
+
+    // Levels stored in the header
+    std::vector<TextureLevel> levels() const;
+
+private:
+
+    MappedFile file;
+
+};
+
+#endif
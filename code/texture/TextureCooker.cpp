@@ -0,0 +1,404 @@
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Bytes of a BC1 block of 4 x 4 texels
+const int bc1BlockBytes = 8;
+
+// Source texel and weight of one tap of a box filter
+struct FilterTap {
+    int source;
+    float weight;
+};
+
+// Taps of a box filter shrinking 'sourceSize' texels to 'destinationSize', for every destination texel. Each destination texel
+// averages the source interval it covers, so halving an odd size weighs the texels shared by two destination texels by half
+std::vector<std::vector<FilterTap>> boxFilterTaps(int sourceSize, int destinationSize) {
+
+    std::vector<std::vector<FilterTap>> taps(destinationSize);
+    double ratio = static_cast<double>(sourceSize) / destinationSize;
+    for (int i = 0; i < destinationSize; ++i) {
+        double start = i * ratio;
+        double end = (i + 1) * ratio;
+        for (int source = static_cast<int>(std::floor(start)); source < std::min(static_cast<int>(std::ceil(end)), sourceSize); ++source) {
+            double overlap = std::min(end, source + 1.0) - std::max(start, static_cast<double>(source));
+            if (overlap > 0.0) {
+                taps[i].push_back({ source, static_cast<float>(overlap / ratio) });
+            }
+        }
+    }
+    return taps;
+}
+
+// Shrinks an image to the next level of its mip chain, filtering the rows first and then the columns.
+// The channels are averaged as stored, as glGenerateMipmap() does for textures that are not sRGB
+void downsample(const unsigned char* source, int sourceWidth, int sourceHeight, int channels, unsigned char* destination, int width, int height) {
+
+    std::vector<std::vector<FilterTap>> columnTaps = boxFilterTaps(sourceWidth, width);
+    std::vector<std::vector<FilterTap>> rowTaps = boxFilterTaps(sourceHeight, height);
+
+    // Every source row, shrunk horizontally
+    std::vector<float> rows(static_cast<size_t>(width) * sourceHeight * channels, 0.0f);
+    for (int y = 0; y < sourceHeight; ++y) {
+        const unsigned char* sourceRow = source + static_cast<size_t>(y) * sourceWidth * channels;
+        float* row = rows.data() + static_cast<size_t>(y) * width * channels;
+        for (int x = 0; x < width; ++x) {
+            for (const FilterTap& tap : columnTaps[x]) {
+                for (int c = 0; c < channels; ++c) {
+                    row[x * channels + c] += tap.weight * sourceRow[tap.source * channels + c];
+                }
+            }
+        }
+    }
+
+    // Then shrunk vertically, rounding to the nearest value
+    for (int y = 0; y < height; ++y) {
+        unsigned char* destinationRow = destination + static_cast<size_t>(y) * width * channels;
+        for (int i = 0; i < width * channels; ++i) {
+            float value = 0.0f;
+            for (const FilterTap& tap : rowTaps[y]) {
+                value += tap.weight * rows[static_cast<size_t>(tap.source) * width * channels + i];
+            }
+            destinationRow[i] = static_cast<unsigned char>(std::min(std::max(std::lround(value), 0L), 255L));
+        }
+    }
+}
+
+// Expands a 5:6:5 color to 8 bits per channel, repeating the high bits in the low ones as the GPU does
+void unpack565(uint16_t color, int rgb[3]) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Rounds a color to 5:6:5
+uint16_t pack565(const float rgb[3]) {
+    auto quantize = [](float value, int maximum) {
+        return static_cast<int>(std::lround(std::min(std::max(value, 0.0f), 255.0f) * maximum / 255.0f));
+    };
+    return static_cast<uint16_t>((quantize(rgb[0], 31) << 11) | (quantize(rgb[1], 63) << 5) | quantize(rgb[2], 31));
+}
+
+// The four colors of a block whose first endpoint is greater, which selects the mode without transparency:
+// both endpoints, then the points at a third and two thirds of the way from the first to the second
+void bc1Palette(uint16_t color0, uint16_t color1, int palette[4][3]) {
+    unpack565(color0, palette[0]);
+    unpack565(color1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+// Chooses the nearest color of the palette for every texel, and returns the squared error of the block
+int chooseIndices(const int texels[16][3], uint16_t color0, uint16_t color1, uint8_t indices[16]) {
+
+    int palette[4][3];
+    bc1Palette(color0, color1, palette);
+
+    int totalError = 0;
+    for (int i = 0; i < 16; ++i) {
+        int bestError = std::numeric_limits<int>::max();
+        for (uint8_t p = 0; p < 4; ++p) {
+            int dr = texels[i][0] - palette[p][0], dg = texels[i][1] - palette[p][1], db = texels[i][2] - palette[p][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < bestError) {
+                bestError = error;
+                indices[i] = p;
+            }
+        }
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+// Puts the endpoints in the order of the mode without transparency, whose palette is the same either way round.
+// Equal endpoints cannot be ordered, but then every texel takes the first one, which both modes decode alike
+void orderEndpoints(uint16_t& color0, uint16_t& color1) {
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+}
+
+// Encodes a block: the endpoints are first taken along the principal axis of the texels' colors, slightly inset, then
+// refined once by least squares for the indices they give, keeping whichever has the smaller error
+void encodeBc1Block(const int texels[16][3], unsigned char* block) {
+
+    // Mean and covariance of the colors
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += texels[i][c] / 16.0f;
+        }
+    }
+    float covariance[3][3] = {};
+    for (int i = 0; i < 16; ++i) {
+        float d[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+        for (int a = 0; a < 3; ++a) {
+            for (int b = 0; b < 3; ++b) {
+                covariance[a][b] += d[a] * d[b];
+            }
+        }
+    }
+
+    // Principal axis by power iteration, starting from the channel that varies most
+    int widest = covariance[1][1] > covariance[0][0] ? 1 : 0;
+    widest = covariance[2][2] > covariance[widest][widest] ? 2 : widest;
+    float axis[3] = { 0.0f, 0.0f, 0.0f };
+    axis[widest] = 1.0f;
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[3];
+        for (int a = 0; a < 3; ++a) {
+            next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+        }
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length <= 0.0f) {
+            break;
+        }
+        for (int a = 0; a < 3; ++a) {
+            axis[a] = next[a] / length;
+        }
+    }
+
+    // Extremes of the colors along the axis, moved inwards by a sixteenth of their distance
+    float lowest = std::numeric_limits<float>::max(), highest = -std::numeric_limits<float>::max();
+    for (int i = 0; i < 16; ++i) {
+        float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+        lowest = std::min(lowest, t);
+        highest = std::max(highest, t);
+    }
+    float inset = (highest - lowest) / 16.0f;
+    float high[3], low[3];
+    for (int c = 0; c < 3; ++c) {
+        high[c] = mean[c] + (highest - inset) * axis[c];
+        low[c] = mean[c] + (lowest + inset) * axis[c];
+    }
+
+    uint16_t color0 = pack565(high), color1 = pack565(low);
+    uint8_t indices[16];
+    orderEndpoints(color0, color1);
+    int error = chooseIndices(texels, color0, color1, indices);
+
+    // Least squares endpoints for these indices: each texel is w * endpoint0 + (1 - w) * endpoint1
+    if (color0 != color1) {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; ++i) {
+            float a = weights[indices[i]], b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; ++c) {
+                ax[c] += a * texels[i][c];
+                bx[c] += b * texels[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) > 1e-6f) {
+            float refined0[3], refined1[3];
+            for (int c = 0; c < 3; ++c) {
+                refined0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+                refined1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+            }
+            uint16_t refinedColor0 = pack565(refined0), refinedColor1 = pack565(refined1);
+            uint8_t refinedIndices[16];
+            orderEndpoints(refinedColor0, refinedColor1);
+            int refinedError = chooseIndices(texels, refinedColor0, refinedColor1, refinedIndices);
+            if (refinedColor0 != refinedColor1 && refinedError < error) {
+                color0 = refinedColor0;
+                color1 = refinedColor1;
+                std::memcpy(indices, refinedIndices, sizeof(indices));
+            }
+        }
+    }
+
+    // Both endpoints in little endian, then 2 bits per texel, the first texel in the lowest bits
+    uint32_t packedIndices = 0;
+    for (int i = 0; i < 16; ++i) {
+        packedIndices |= static_cast<uint32_t>(indices[i]) << (2 * i);
+    }
+    block[0] = static_cast<unsigned char>(color0 & 0xff);
+    block[1] = static_cast<unsigned char>(color0 >> 8);
+    block[2] = static_cast<unsigned char>(color1 & 0xff);
+    block[3] = static_cast<unsigned char>(color1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        block[4 + i] = static_cast<unsigned char>((packedIndices >> (8 * i)) & 0xff);
+    }
+}
+
+// Size of a level in BC1 blocks
+size_t bc1Bytes(int width, int height) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * bc1BlockBytes;
+}
+
+}
+
+// Builds the mip chain, then compresses it
+bool cookTexture(const unsigned char* pixels, int width, int height, int channels, TextureCompression compression, TextureData& texture) {
+
+    if ((channels != 3 && channels != 4) || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    // Every level of the chain, uncompressed
+    std::vector<std::vector<unsigned char>> chain;
+    std::vector<std::pair<int, int>> sizes;
+    chain.emplace_back(pixels, pixels + static_cast<size_t>(width) * height * channels);
+    sizes.emplace_back(width, height);
+    while (sizes.back().first > 1 || sizes.back().second > 1) {
+        int levelWidth = std::max(sizes.back().first / 2, 1);
+        int levelHeight = std::max(sizes.back().second / 2, 1);
+        std::vector<unsigned char> level(static_cast<size_t>(levelWidth) * levelHeight * channels);
+        downsample(chain.back().data(), sizes.back().first, sizes.back().second, channels, level.data(), levelWidth, levelHeight);
+        chain.push_back(std::move(level));
+        sizes.emplace_back(levelWidth, levelHeight);
+    }
+
+    bool isCompressed = compression == TextureCompression::Bc1;
+    texture.internalFormat = isCompressed ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : (channels == 3 ? GL_RGB8 : GL_RGBA8);
+    texture.format = isCompressed ? 0 : (channels == 3 ? GL_RGB : GL_RGBA);
+    texture.levels.clear();
+    texture.bytes.clear();
+
+    // Lay the levels out one after the other
+    for (size_t i = 0; i < chain.size(); ++i) {
+        TextureLevel level;
+        level.width = static_cast<uint32_t>(sizes[i].first);
+        level.height = static_cast<uint32_t>(sizes[i].second);
+        level.offset = texture.bytes.size();
+        level.bytes = isCompressed ? bc1Bytes(sizes[i].first, sizes[i].second) : chain[i].size();
+        texture.bytes.resize(texture.bytes.size() + level.bytes);
+        if (isCompressed) {
+            compressBc1(chain[i].data(), sizes[i].first, sizes[i].second, channels, texture.bytes.data() + level.offset);
+        }
+        else {
+            std::memcpy(texture.bytes.data() + level.offset, chain[i].data(), chain[i].size());
+        }
+        texture.levels.push_back(level);
+    }
+
+    return true;
+}
+
+// Compresses the image block by block, repeating the last row and column into the blocks they do not fill
+void compressBc1(const unsigned char* pixels, int width, int height, int channels, unsigned char* blocks) {
+
+    int blockColumns = (width + 3) / 4;
+    int blockRows = (height + 3) / 4;
+    for (int blockRow = 0; blockRow < blockRows; ++blockRow) {
+        for (int blockColumn = 0; blockColumn < blockColumns; ++blockColumn) {
+            int texels[16][3];
+            for (int i = 0; i < 16; ++i) {
+                int x = std::min(blockColumn * 4 + i % 4, width - 1);
+                int y = std::min(blockRow * 4 + i / 4, height - 1);
+                const unsigned char* texel = pixels + (static_cast<size_t>(y) * width + x) * channels;
+                texels[i][0] = texel[0];
+                texels[i][1] = texel[1];
+                texels[i][2] = texel[2];
+            }
+            encodeBc1Block(texels, blocks + (static_cast<size_t>(blockRow) * blockColumns + blockColumn) * bc1BlockBytes);
+        }
+    }
+}
+
+// Decodes every block with the palette of its mode
+void decompressBc1(const unsigned char* blocks, int width, int height, unsigned char* pixels) {
+
+    int blockColumns = (width + 3) / 4;
+    int blockRows = (height + 3) / 4;
+    for (int blockRow = 0; blockRow < blockRows; ++blockRow) {
+        for (int blockColumn = 0; blockColumn < blockColumns; ++blockColumn) {
+            const unsigned char* block = blocks + (static_cast<size_t>(blockRow) * blockColumns + blockColumn) * bc1BlockBytes;
+            uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+            uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+            uint32_t indices = static_cast<uint32_t>(block[4]) | (static_cast<uint32_t>(block[5]) << 8) | (static_cast<uint32_t>(block[6]) << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+            // Without ordered endpoints, the third color is halfway and the fourth is black
+            int palette[4][3];
+            bc1Palette(color0, color1, palette);
+            if (color0 <= color1) {
+                for (int c = 0; c < 3; ++c) {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                int x = blockColumn * 4 + i % 4;
+                int y = blockRow * 4 + i / 4;
+                if (x >= width || y >= height) {
+                    continue;
+                }
+                const int* color = palette[(indices >> (2 * i)) & 3];
+                unsigned char* texel = pixels + (static_cast<size_t>(y) * width + x) * 3;
+                texel[0] = static_cast<unsigned char>(color[0]);
+                texel[1] = static_cast<unsigned char>(color[1]);
+                texel[2] = static_cast<unsigned char>(color[2]);
+            }
+        }
+    }
+}
+
+// Mean squared error of the RGB channels, against the largest value of a channel
+double colorPsnr(const unsigned char* original, int originalChannels, const unsigned char* decoded, int decodedChannels, int width, int height) {
+
+    double squaredError = 0.0;
+    size_t texelCount = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < texelCount; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            double difference = static_cast<double>(original[i * originalChannels + c]) - decoded[i * decodedChannels + c];
+            squaredError += difference * difference;
+        }
+    }
+
+    double meanSquaredError = squaredError / (3.0 * texelCount);
+    if (meanSquaredError <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+// Resamples an image bilinearly, aligning the centers of the corner texels, and converts between 3 and 4 channels
+void resizeImage(const unsigned char* pixels, int width, int height, int channels, int newWidth, int newHeight, int newChannels, std::vector<unsigned char>& resized) {
+
+    resized.resize(static_cast<size_t>(newWidth) * newHeight * newChannels);
+
+    // Position of a destination texel in the source, clamped to its edges
+    auto sourcePosition = [](int destination, int sourceSize, int destinationSize, int& first, int& second, float& fraction) {
+        float position = destinationSize > 1 ? static_cast<float>(destination) * (sourceSize - 1) / (destinationSize - 1) : 0.0f;
+        first = std::min(static_cast<int>(position), sourceSize - 1);
+        second = std::min(first + 1, sourceSize - 1);
+        fraction = position - first;
+    };
+
+    for (int y = 0; y < newHeight; ++y) {
+        int y0, y1;
+        float fy;
+        sourcePosition(y, height, newHeight, y0, y1, fy);
+
+        for (int x = 0; x < newWidth; ++x) {
+            int x0, x1;
+            float fx;
+            sourcePosition(x, width, newWidth, x0, x1, fx);
+
+            unsigned char* texel = &resized[(static_cast<size_t>(y) * newWidth + x) * newChannels];
+            for (int c = 0; c < newChannels; ++c) {
+
+                // Images without alpha become opaque
+                if (c >= channels) {
+                    texel[c] = 255;
+                    continue;
+                }
+                auto at = [&](int sx, int sy) { return static_cast<float>(pixels[(static_cast<size_t>(sy) * width + sx) * channels + c]); };
+                float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * fx;
+                float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * fx;
+                texel[c] = static_cast<unsigned char>(std::lround(top + (bottom - top) * fy));
+            }
+        }
+    }
+}
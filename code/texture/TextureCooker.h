@@ -0,0 +1,24 @@
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include "TextureData.h"
+
+// Builds the full mip chain of an image of 3 or 4 channels, each level the box-filtered average of the previous one, and
+// compresses every level if asked to. Returns false for other numbers of channels
+bool cookTexture(const unsigned char* pixels, int width, int height, int channels, TextureCompression compression, TextureData& texture);
+
+// Compresses an image of 'channels' bytes per texel into BC1 blocks, ignoring alpha. The edges of images whose size is not a
+// multiple of 4 are repeated to fill their blocks. 'blocks' receives 8 bytes per block, in rows of blocks
+void compressBc1(const unsigned char* pixels, int width, int height, int channels, unsigned char* blocks);
+
+// Decodes BC1 blocks into RGB texels, 3 bytes each
+void decompressBc1(const unsigned char* blocks, int width, int height, unsigned char* pixels);
+
+// Peak signal-to-noise ratio of the RGB channels of two images, in decibels. Infinite for identical images
+double colorPsnr(const unsigned char* original, int originalChannels, const unsigned char* decoded, int decodedChannels, int width, int height);
+
+// Resamples an image of 3 or 4 channels bilinearly to another size and number of channels, adding opaque alpha or dropping it.
+// Meant for enlarging images: shrinking by more than half skips texels
+void resizeImage(const unsigned char* pixels, int width, int height, int channels, int newWidth, int newHeight, int newChannels, std::vector<unsigned char>& resized);
+
+#endif
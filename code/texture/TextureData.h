@@ -0,0 +1,58 @@
+#ifndef TEXTURE_DATA_H
+#define TEXTURE_DATA_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// How cooked textures are stored on the GPU
+enum class TextureCompression {
+
+    // The decoded pixels, 3 or 4 bytes per texel
+    None,
+
+    // BC1 (S3TC DXT1) blocks of 4 x 4 texels in 8 bytes, without alpha. Requires GL_EXT_texture_compression_s3tc
+    Bc1
+
+};
+
+// One level of a mip chain, stored in a byte blob.
+// Stored as-is in binary textures, so only fixed-width members are used
+struct TextureLevel {
+
+    uint32_t width;
+    uint32_t height;
+
+    // Location and size of the level in the blob, in bytes
+    uint64_t offset;
+    uint64_t bytes;
+
+};
+
+// An image with its mip chain, as uploaded to a texture
+struct TextureData {
+
+    // OpenGL internal format, e.g. GL_RGBA8 or GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    uint32_t internalFormat = 0;
+
+    // OpenGL format of the uncompressed pixels, e.g. GL_RGBA. 0 for compressed textures
+    uint32_t format = 0;
+
+    // Levels from the full image down to 1 x 1, or the full image alone when the mipmaps are left to glGenerateMipmap()
+    std::vector<TextureLevel> levels;
+
+    // Number of layers of a texture array. Each level then holds the level of every layer, one after the other
+    uint32_t layerCount = 1;
+
+    // Tightly packed bytes of every level
+    std::vector<unsigned char> bytes;
+
+    bool isCompressed() const { return format == 0; }
+
+};
+
+#endif
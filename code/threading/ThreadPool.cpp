@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+// One less than the number of cores, as the calling thread also runs chunks
+unsigned int ThreadPool::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+// Constructor: Starts the worker threads
+ThreadPool::ThreadPool(unsigned int workerCount) {
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+// Number of threads taking part in a loop
+unsigned int ThreadPool::threadCount() const {
+    return static_cast<unsigned int>(workers.size()) + 1;
+}
+
+// Spreads the chunks of [0, count) over every thread and waits for them
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+
+    grain = std::max<size_t>(grain, 1);
+
+    // Small loops are not worth waking the workers
+    if (workers.empty() || count <= grain) {
+        if (count > 0) {
+            body(0, count);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loopBody = &body;
+        loopCount = count;
+        loopGrain = grain;
+        nextIndex.store(0);
+        busyWorkers = static_cast<unsigned int>(workers.size());
+        ++generation;
+    }
+    loopStarted.notify_all();
+
+    runChunks();
+
+    // The loop's fields must stay valid until every worker has left it
+    std::unique_lock<std::mutex> lock(mutex);
+    loopFinished.wait(lock, [this] { return busyWorkers == 0; });
+    loopBody = nullptr;
+}
+
+// Runs chunks of the current loop until none are left
+void ThreadPool::runChunks() {
+    for (;;) {
+        size_t begin = nextIndex.fetch_add(loopGrain);
+        if (begin >= loopCount) {
+            return;
+        }
+        (*loopBody)(begin, std::min(begin + loopGrain, loopCount));
+    }
+}
+
+// Waits for loops and runs their chunks, until the pool is destroyed
+void ThreadPool::workerLoop() {
+
+    unsigned long seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            loopStarted.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            loopFinished.notify_one();
+        }
+    }
+}
+
+// Destructor: Stops and joins the worker threads
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    loopStarted.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
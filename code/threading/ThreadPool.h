@@ -0,0 +1,71 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads running data-parallel loops. The calling thread takes part in every loop,
+// so a pool of N threads keeps N + 1 cores busy. Loops cannot be nested
+class ThreadPool {
+
+public:
+
+    // Constructor: Starts 'workerCount' worker threads. By default, one less than the number of cores
+    explicit ThreadPool(unsigned int workerCount = defaultWorkerCount());
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls 'body(begin, end)' on chunks of at most 'grain' indices covering [0, count), spread over every thread,
+    // and returns once all the chunks are done
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Number of threads taking part in a loop, including the calling thread
+    unsigned int threadCount() const;
+
+    // One less than the number of cores, or 0 when the number of cores is unknown
+    static unsigned int defaultWorkerCount();
+
+    // Destructor: Stops and joins the worker threads
+    ~ThreadPool();
+
+private:
+
+    std::vector<std::thread> workers;
+
+    // Protects the fields of the current loop and wakes the workers
+    std::mutex mutex;
+    std::condition_variable loopStarted;
+    std::condition_variable loopFinished;
+
+    // Incremented for every loop, so that each worker runs each loop once
+    unsigned long generation = 0;
+
+    // Number of workers that have not finished the current loop
+    unsigned int busyWorkers = 0;
+
+    // Set by the destructor to stop the workers
+    bool stopping = false;
+
+    // The current loop
+    const std::function<void(size_t, size_t)>* loopBody = nullptr;
+    size_t loopCount = 0;
+    size_t loopGrain = 1;
+
+    // Start of the next chunk to run
+    std::atomic<size_t> nextIndex{ 0 };
+
+    // Main function of the worker threads
+    void workerLoop();
+
+    // Runs chunks of the current loop until none are left
+    void runChunks();
+
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Hands values from one writer thread to one reader thread without locks or waiting. Of the three slots, the writer
+// owns one, the reader owns another, and the third holds the latest published value. Publishing and picking up
+// swap a slot with the third one atomically, so the writer never waits for the reader and the reader always
+// gets the most recent complete value. Values skipped by the reader are simply overwritten
+template <typename T>
+class TripleBuffer {
+
+public:
+
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Slot the writer fills before calling publish(). Writer thread only
+    T& writeSlot() {
+        return slots[writeIndex];
+    }
+
+    // Makes the write slot the latest value, and takes the previous latest slot (or the one the reader released) for the next write
+    void publish() {
+        writeIndex = latest.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Picks up the latest value if one was published since the last call, and returns whether it did. Reader thread only
+    bool update() {
+        if ((latest.load(std::memory_order_relaxed) & freshBit) == 0) {
+            return false;
+        }
+        readIndex = latest.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // Latest value picked up by update(). Reader thread only
+    const T& readSlot() const {
+        return slots[readIndex];
+    }
+
+private:
+
+    // Marks a latest slot the reader has not picked up yet
+    static const unsigned int freshBit = 4;
+    static const unsigned int indexMask = 3;
+
+    T slots[3];
+
+    // Slot being written, slot being read, and latest published slot with its fresh bit
+    unsigned int writeIndex = 0;
+    unsigned int readIndex = 1;
+    std::atomic<unsigned int> latest{ 2 };
+
+};
+
+#endif
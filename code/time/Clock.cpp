@@ -0,0 +1,30 @@
+#include "Clock.h"
+#include <GLFW/glfw3.h>
+
+bool Clock::virtualTime = false;
+double Clock::virtualNow = 0.0;
+double Clock::virtualStep = 0.0;
+
+// Current time in seconds
+double Clock::now() {
+    return virtualTime ? virtualNow : glfwGetTime();
+}
+
+// Switches to a virtual clock advanced by a fixed step per frame
+void Clock::useVirtualTime(double frameStep) {
+    virtualTime = true;
+    virtualNow = 0.0;
+    virtualStep = frameStep;
+}
+
+// Advances the virtual clock by one frame
+void Clock::advance() {
+    if (virtualTime) {
+        virtualNow += virtualStep;
+    }
+}
+
+// Whether the virtual clock is in use
+bool Clock::isVirtual() {
+    return virtualTime;
+}
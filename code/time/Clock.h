@@ -0,0 +1,35 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+// Source of time for the animations and the camera. Reads the GLFW timer, or a virtual clock
+// advanced by a fixed step per frame so that headless runs are reproducible
+class Clock {
+
+public:
+
+    // Current time in seconds
+    static double now();
+
+    // Switches to a virtual clock, starting at 0 and advanced by 'frameStep' seconds on every advance()
+    static void useVirtualTime(double frameStep);
+
+    // Advances the virtual clock by one frame. Does nothing when reading the GLFW timer
+    static void advance();
+
+    // Whether the virtual clock is in use
+    static bool isVirtual();
+
+private:
+
+    // Whether the virtual clock is in use
+    static bool virtualTime;
+
+    // Current time of the virtual clock
+    static double virtualNow;
+
+    // Step of the virtual clock per frame
+    static double virtualStep;
+
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "FrameTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+// Prints the average, median, 95th percentile, maximum and standard deviation of a set of measurements, skipping negative (missing) values
+void printStatistics(std::ostream& stream, const char* name, const std::vector<double>& values) {
+
+    std::vector<double> sorted;
+    sorted.reserve(values.size());
+    for (double value : values) {
+        if (value >= 0.0) {
+            sorted.push_back(value);
+        }
+    }
+    if (sorted.empty()) {
+        stream << name << ": no samples" << std::endl;
+        return;
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double value : sorted) {
+        total += value;
+    }
+    double average = total / sorted.size();
+
+    // The standard deviation of the frame interval is its jitter
+    double squaredDeviations = 0.0;
+    for (double value : sorted) {
+        squaredDeviations += (value - average) * (value - average);
+    }
+
+    stream << std::fixed << std::setprecision(3)
+           << name << " (ms): average " << average
+           << ", median " << sorted[sorted.size() / 2]
+           << ", p95 " << sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)]
+           << ", max " << sorted.back()
+           << ", standard deviation " << std::sqrt(squaredDeviations / sorted.size())
+           << std::defaultfloat << std::endl;
+}
+
+}
+
+// Constructor: Creates the timer queries
+FrameTimer::FrameTimer() {
+
+    glGenQueries(queryCount, queries);
+    for (unsigned int i = 0; i < queryCount; ++i) {
+        queryFrame[i] = -1;
+    }
+
+    frameStart = previousFrameStart = std::chrono::steady_clock::now();
+}
+
+// Marks the start of a frame's work
+void FrameTimer::beginFrame() {
+
+    previousFrameStart = frameStart;
+    frameStart = std::chrono::steady_clock::now();
+
+    // The first frame has no previous frame to measure the interval from
+    size_t frame = cpuTimes.size();
+    frameIntervals.push_back(frame == 0 ? -1.0 : std::chrono::duration<double, std::milli>(frameStart - previousFrameStart).count());
+    cpuTimes.push_back(-1.0);
+    gpuTimes.push_back(-1.0);
+    visibleCounts.push_back(0);
+    culledCounts.push_back(0);
+    triangleCounts.push_back(0);
+    vertexErrors.push_back(0.0f);
+    drawCallCounts.push_back(0);
+    stateChangeCounts.push_back(0);
+    submissionTimes.push_back(-1.0);
+
+    // Reuse the oldest query of the ring. Its frame was issued 'queryCount' frames ago, so its result is normally ready
+    unsigned int slot = static_cast<unsigned int>(frame % queryCount);
+    collect(slot);
+
+    queryFrame[slot] = static_cast<long>(frame);
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+}
+
+// Marks the end of a frame's work
+void FrameTimer::endFrame() {
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+    cpuTimes.back() = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+}
+
+// Records the numbers of objects drawn and culled and of triangles drawn during the current frame, and the vertex error
+void FrameTimer::recordCounts(unsigned int visible, unsigned int culled, unsigned long triangles, float vertexErrorPixels) {
+    visibleCounts.back() = visible;
+    culledCounts.back() = culled;
+    triangleCounts.back() = triangles;
+    vertexErrors.back() = vertexErrorPixels;
+}
+
+// Records the draw calls and binds of the current frame and the time spent submitting them
+void FrameTimer::recordSubmission(unsigned int drawCalls, unsigned int stateChanges, double submissionMilliseconds) {
+    drawCallCounts.back() = drawCalls;
+    stateChangeCounts.back() = stateChanges;
+    submissionTimes.back() = submissionMilliseconds;
+}
+
+// Waits for the GPU times of the frames still in flight
+void FrameTimer::finish() {
+    for (unsigned int i = 0; i < queryCount; ++i) {
+        collect(i);
+    }
+}
+
+// Reads the result of a query into gpuTimes
+void FrameTimer::collect(unsigned int slot) {
+
+    if (queryFrame[slot] < 0) {
+        return;
+    }
+
+    GLuint64 elapsedNanoseconds = 0;
+    glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsedNanoseconds);
+    gpuTimes[static_cast<size_t>(queryFrame[slot])] = static_cast<double>(elapsedNanoseconds) / 1.0e6;
+    queryFrame[slot] = -1;
+}
+
+// Number of frames measured so far
+size_t FrameTimer::frameCount() const {
+    return cpuTimes.size();
+}
+
+// Writes one line per frame: frame index, interval, CPU and GPU time in milliseconds, visible and culled objects, triangles, vertex error,
+// draw calls, binds and submission time
+void FrameTimer::writeCsv(std::ostream& stream) const {
+
+    stream << "frame,interval_ms,cpu_ms,gpu_ms,visible,culled,triangles,vertex_error_px,draw_calls,state_changes,submit_ms" << std::endl;
+    for (size_t i = 0; i < cpuTimes.size(); ++i) {
+        stream << i << "," << frameIntervals[i] << "," << cpuTimes[i] << "," << gpuTimes[i] << "," << visibleCounts[i] << "," << culledCounts[i] << "," << triangleCounts[i] << "," << vertexErrors[i]
+               << "," << drawCallCounts[i] << "," << stateChangeCounts[i] << "," << submissionTimes[i] << std::endl;
+    }
+}
+
+// Prints the average, median, 95th percentile, maximum and standard deviation of every measurement, and the average counts
+void FrameTimer::printSummary(std::ostream& stream) const {
+
+    stream << "Frames: " << cpuTimes.size() << std::endl;
+    printStatistics(stream, "Frame interval", frameIntervals);
+    printStatistics(stream, "CPU time", cpuTimes);
+    printStatistics(stream, "GPU time", gpuTimes);
+    printStatistics(stream, "Submission CPU time", submissionTimes);
+
+    if (!visibleCounts.empty()) {
+        double visible = 0.0, culled = 0.0, triangles = 0.0, drawCalls = 0.0, stateChanges = 0.0;
+        for (size_t i = 0; i < visibleCounts.size(); ++i) {
+            visible += visibleCounts[i];
+            culled += culledCounts[i];
+            triangles += triangleCounts[i];
+            drawCalls += drawCallCounts[i];
+            stateChanges += stateChangeCounts[i];
+        }
+        double frames = static_cast<double>(visibleCounts.size());
+        stream << std::fixed << std::setprecision(1)
+               << "Objects per frame: " << visible / frames << " visible, " << culled / frames << " culled" << std::endl
+               << "Triangles per frame: " << triangles / frames << std::endl
+               << "Draw calls per frame: " << drawCalls / frames << std::endl
+               << "State changes per frame: " << stateChanges / frames
+               << std::defaultfloat << std::endl;
+
+        // Only packed vertices have an error. It bounds how far any drawn vertex moved on the screen
+        float vertexError = *std::max_element(vertexErrors.begin(), vertexErrors.end());
+        if (vertexError > 0.0f) {
+            stream << std::fixed << std::setprecision(3) << "Vertex quantization error: at most " << vertexError << " pixels" << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+// Destructor: Deletes the timer queries
+FrameTimer::~FrameTimer() {
+    glDeleteQueries(queryCount, queries);
+}
@@ -0,0 +1,89 @@
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+#include <glad/glad.h>
+#include <ostream>
+#include <vector>
+#include <chrono>
+
+// Measures the CPU time, GPU time and wall-clock interval of every frame.
+// GPU times are read through a ring of timer queries, a few frames late, so that the pipeline never stalls
+class FrameTimer {
+
+public:
+
+    // Constructor: Creates the timer queries. Requires a current GL context
+    FrameTimer();
+
+    FrameTimer(const FrameTimer&) = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+
+    // Marks the start of a frame's work
+    void beginFrame();
+
+    // Marks the end of a frame's work, before the buffers are swapped
+    void endFrame();
+
+    // Records the numbers of objects drawn and culled and of triangles drawn during the current frame, and the largest
+    // on-screen error of the quantized vertex positions in pixels
+    void recordCounts(unsigned int visible, unsigned int culled, unsigned long triangles, float vertexErrorPixels);
+
+    // Records the numbers of draw calls and of binds of programs, VAOs and textures issued during the current frame, and the CPU
+    // time spent choosing and submitting them
+    void recordSubmission(unsigned int drawCalls, unsigned int stateChanges, double submissionMilliseconds);
+
+    // Waits for the GPU times of the frames still in flight
+    void finish();
+
+    // Number of frames measured so far
+    size_t frameCount() const;
+
+    // Writes one line per frame: frame index, interval, CPU and GPU time in milliseconds, visible and culled objects, triangles, vertex error,
+    // draw calls, binds and submission time
+    void writeCsv(std::ostream& stream) const;
+
+    // Prints the average, median, 95th percentile, maximum and standard deviation of every measurement, and the average counts
+    void printSummary(std::ostream& stream) const;
+
+    // Destructor: Deletes the timer queries
+    ~FrameTimer();
+
+private:
+
+    // Number of frames whose GPU time can be in flight at once
+    static const unsigned int queryCount = 4;
+
+    // GL_TIME_ELAPSED queries, used in turn by consecutive frames
+    unsigned int queries[queryCount];
+
+    // Frame measured by each query, or -1 if the query holds no pending result
+    long queryFrame[queryCount];
+
+    // Start of the current and of the previous frame
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point previousFrameStart;
+
+    // Per-frame measurements in milliseconds. GPU times are -1 until their query is read
+    std::vector<double> frameIntervals;
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+
+    // Per-frame numbers of objects drawn and culled, and of triangles drawn
+    std::vector<unsigned int> visibleCounts;
+    std::vector<unsigned int> culledCounts;
+    std::vector<unsigned long> triangleCounts;
+
+    // Per-frame largest on-screen error of the quantized vertex positions, in pixels
+    std::vector<float> vertexErrors;
+
+    // Per-frame numbers of draw calls and binds, and CPU time spent submitting them in milliseconds
+    std::vector<unsigned int> drawCallCounts;
+    std::vector<unsigned int> stateChangeCounts;
+    std::vector<double> submissionTimes;
+
+    // Reads the result of a query into gpuTimes, waiting for it if needed
+    void collect(unsigned int query);
+
+};
+
+#endif
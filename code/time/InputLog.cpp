@@ -0,0 +1,87 @@
+#include "InputLog.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+// Appends the inputs of a frame
+void InputLog::record(const InputFrame& frame) {
+    frames.push_back(frame);
+}
+
+size_t InputLog::frameCount() const {
+    return frames.size();
+}
+
+const InputFrame& InputLog::frame(size_t index) const {
+    return frames[index];
+}
+
+// Saves the log as text, with round-trip precision
+bool InputLog::save(const std::string& path) const {
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::INPUT_LOG::FILE_NOT_WRITABLE: " << path << std::endl;
+        return false;
+    }
+
+    file << "# elapsedTime timeWarp paused yaw pitch" << std::endl;
+    file << "seed " << seed << std::endl;
+    for (const InputFrame& frame : frames) {
+        file << std::setprecision(std::numeric_limits<double>::max_digits10) << frame.elapsedTime << ' ' << frame.timeWarp << ' ' << (frame.paused ? 1 : 0)
+             << std::setprecision(std::numeric_limits<float>::max_digits10) << ' ' << frame.yaw << ' ' << frame.pitch << std::endl;
+    }
+    return static_cast<bool>(file);
+}
+
+// Loads a log saved by save()
+bool InputLog::load(const std::string& path) {
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "ERROR::INPUT_LOG::FILE_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<InputFrame> loaded;
+    unsigned int loadedSeed = 0;
+    bool hasSeed = false;
+    std::string line;
+    while (std::getline(file, line)) {
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream values(line);
+        if (!hasSeed) {
+            std::string keyword;
+            if (!(values >> keyword >> loadedSeed) || keyword != "seed") {
+                std::cerr << "ERROR::INPUT_LOG::MISSING_SEED: " << path << std::endl;
+                return false;
+            }
+            hasSeed = true;
+            continue;
+        }
+
+        InputFrame frame;
+        int paused;
+        if (!(values >> frame.elapsedTime >> frame.timeWarp >> paused >> frame.yaw >> frame.pitch)) {
+            std::cerr << "ERROR::INPUT_LOG::INVALID_FRAME: " << line << std::endl;
+            return false;
+        }
+        frame.paused = paused != 0;
+        loaded.push_back(frame);
+    }
+
+    if (!hasSeed) {
+        std::cerr << "ERROR::INPUT_LOG::MISSING_SEED: " << path << std::endl;
+        return false;
+    }
+
+    seed = loadedSeed;
+    frames.swap(loaded);
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <string>
+#include <vector>
+
+// Everything a frame of a run depends on besides the seed: the elapsed real time fed to the simulation clock,
+// the state of the simulation controls and the orientation of the camera
+struct InputFrame {
+
+    // Real time elapsed since the previous frame, in seconds
+    double elapsedTime;
+
+    // Time warp and pause of the simulation during the frame
+    double timeWarp;
+    bool paused;
+
+    // Orientation of the camera
+    float yaw;
+    float pitch;
+
+};
+
+// The seed and inputs of every frame of a run. Recorded during a run and saved, then loaded to replay the run:
+// with the same options, the replayed simulation goes through bit-identical states
+class InputLog {
+
+public:
+
+    // Seed of the run
+    unsigned int seed = 0;
+
+    // Appends the inputs of a frame
+    void record(const InputFrame& frame);
+
+    // Number of frames, and the inputs of one of them
+    size_t frameCount() const;
+    const InputFrame& frame(size_t index) const;
+
+    // Saves the log as text: a "seed N" line, then one "elapsedTime timeWarp paused yaw pitch" line per frame.
+    // Values are written with enough digits to read back the exact same bits
+    bool save(const std::string& path) const;
+
+    // Loads a log saved by save(). Lines starting with '#' are ignored
+    bool load(const std::string& path);
+
+private:
+
+    std::vector<InputFrame> frames;
+
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "SimulationClock.h"
+#include <algorithm>
+
+// Constructor: Creates a running clock
+SimulationClock::SimulationClock(double timeStep) : step(timeStep) {
+}
+
+// Adds the scaled elapsed time and hands out the whole steps it covers
+unsigned int SimulationClock::advance(double elapsedRealTime) {
+
+    if (paused) {
+        return 0;
+    }
+
+    accumulator += std::min(std::max(elapsedRealTime, 0.0), maxElapsedRealTime) * warp;
+    unsigned int dueSteps = 0;
+    while (accumulator >= step) {
+        accumulator -= step;
+        ++dueSteps;
+    }
+    steps += dueSteps;
+    return dueSteps;
+}
+
+void SimulationClock::setPaused(bool isPaused) {
+    paused = isPaused;
+}
+
+bool SimulationClock::isPaused() const {
+    return paused;
+}
+
+void SimulationClock::setTimeWarp(double timeWarp) {
+    warp = std::max(timeWarp, 0.0);
+}
+
+double SimulationClock::timeWarp() const {
+    return warp;
+}
+
+double SimulationClock::timeStep() const {
+    return step;
+}
+
+double SimulationClock::lag() const {
+    return accumulator;
+}
+
+// Fraction of the next step already elapsed
+double SimulationClock::alpha() const {
+    return std::min(accumulator / step, 1.0);
+}
+
+unsigned long SimulationClock::stepCount() const {
+    return steps;
+}
+
+double SimulationClock::simulatedTime() const {
+    return static_cast<double>(steps) * step;
+}
@@ -0,0 +1,52 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+// Turns elapsed real time into a whole number of fixed simulation steps. Time warp scales the simulated time per real
+// second by taking more or fewer steps, never longer ones, so the simulated states do not depend on the warp or the
+// frame rate. The time left over, less than one step, gives the interpolation factor between the last two states
+class SimulationClock {
+
+public:
+
+    // Constructor: Creates a running clock with the given step in simulated seconds and a time warp of 1
+    explicit SimulationClock(double timeStep);
+
+    // Adds 'elapsedRealTime' seconds, scaled by the time warp, and returns the number of steps now due.
+    // Nothing is added while paused. At most 'maxElapsedRealTime' is added at once, so that a stall cannot snowball
+    unsigned int advance(double elapsedRealTime);
+
+    // Pauses or resumes the clock
+    void setPaused(bool paused);
+    bool isPaused() const;
+
+    // Simulated seconds per real second
+    void setTimeWarp(double warp);
+    double timeWarp() const;
+
+    // Simulated seconds per step
+    double timeStep() const;
+
+    // Simulated time not covered by the steps yet, between 0 and one step
+    double lag() const;
+
+    // Fraction of the next step already elapsed, from 0 to 1: how far to interpolate from the previous state to the current one
+    double alpha() const;
+
+    // Number of steps handed out so far, and the simulated time they cover
+    unsigned long stepCount() const;
+    double simulatedTime() const;
+
+    // Longest real time added by one advance()
+    static constexpr double maxElapsedRealTime = 0.25;
+
+private:
+
+    double step;
+    double warp = 1.0;
+    bool paused = false;
+    double accumulator = 0.0;
+    unsigned long steps = 0;
+
+};
+
+#endif
@@ -7,105 +7,665 @@
 #include "./code/sun/SunModel.h"
 #include "./code/moon/MoonModel.h"
 #include "./code/planet/PlanetModel.h"
+#include "./code/planet/PlanetField.h"
+#include "./code/render/IndirectRenderer.h"
+#include "./code/render/RenderQueue.h"
+#include "./code/render/StateTracker.h"
 #include "./code/earth/EarthModel.h"
 #include "./code/camera/Camera.h"
+#include "./code/options/Options.h"
+#include "./code/profiler/Profiler.h"
+#include "./code/camera/CameraPath.h"
+#include "./code/camera/CameraUniforms.h"
+#include "./code/culling/BoundingVolumeHierarchy.h"
+#include "./code/headless/HeadlessContext.h"
+#include "./code/time/Clock.h"
+#include "./code/time/FrameTimer.h"
+#include "./code/time/InputLog.h"
+#include "./code/resources/AssetLoader.h"
+#include "./code/resources/ResourceCache.h"
+#include "./code/scene/SceneGraph.h"
+#include "./code/scene/SceneGraphBenchmark.h"
+#include "./code/scene/BatchTransform.h"
+#include "./code/scene/TransformBenchmark.h"
+#include "./code/simulation/Simulation.h"
+#include "./code/simulation/SimulationBenchmark.h"
+#include "./code/simulation/SimulationThread.h"
+#include "./code/simulation/SolarSystem.h"
+#include "./code/ephemeris/Ephemeris.h"
+#include "./code/ephemeris/EphemerisBenchmark.h"
+#include "./code/threading/ThreadPool.h"
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 
-int main() {
+int main(int argc, char** argv) {
 
-    // Initialize GLFW
-    glfwInit();
+    // Read the settings of this run from the command line
+    Options options = parseOptions(argc, argv);
 
-    // Configure GLFW (OpenGL version 3.3)
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Get the primary monitor and its video mode
-    GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
+    // The benchmarks of the simulation, the scene graph, the batch transforms and the ephemeris need no window or GL context
+    if (options.sceneGraphBenchmarkCount > 0) {
+        runSceneGraphBenchmark(options.sceneGraphBenchmarkCount, std::cout);
+        return 0;
+    }
+    if (!options.transformBenchmarkCounts.empty()) {
+        runTransformBenchmark(options.transformBenchmarkCounts, std::cout);
+        return 0;
+    }
+    if (options.ephemerisBenchmarkCount > 0) {
+        ThreadPool pool(options.threads > 0 ? options.threads - 1 : ThreadPool::defaultWorkerCount());
+        runEphemerisBenchmark(options.ephemerisBenchmarkCount, &pool, std::cout);
+        return 0;
+    }
+    if (!options.simulationBenchmarkCounts.empty() || options.barnesHutAccuracyCount > 0) {
+        ThreadPool pool(options.threads > 0 ? options.threads - 1 : ThreadPool::defaultWorkerCount());
+        if (!options.simulationBenchmarkCounts.empty()) {
+            GravitySolver solver = options.solver == "barnes-hut" ? GravitySolver::BarnesHut : GravitySolver::Direct;
+            runSimulationBenchmark(options.simulationBenchmarkCounts, solver, options.openingAngle, &pool, std::cout);
+        }
+        if (options.barnesHutAccuracyCount > 0) {
+            runBarnesHutAccuracy(options.barnesHutAccuracyCount, &pool, std::cout);
+        }
+        return 0;
+    }
 
-    // Create a full-screen window with the monitor's resolution
-    GLFWwindow* window = glfwCreateWindow(mode->width, mode->height, "OpenGL Project: Solar System", primaryMonitor, NULL);
-    if (window == NULL) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
+    // Inputs replayed instead of the keyboard and the clock
+    InputLog replayLog;
+    bool isReplaying = !options.replayFile.empty();
+    if (isReplaying && !replayLog.load(options.replayFile)) {
         return -1;
     }
 
-    glfwMakeContextCurrent(window);
+    // Create either an offscreen context or a full-screen window
+    HeadlessContext headless;
+    GLFWwindow* window = NULL;
+    if (options.headless) {
+        if (!headless.create(options.width, options.height)) {
+            return -1;
+        }
 
-    // Initialize GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD" << std::endl;
-        return -1;
+        // Drive the animations with a fixed step per frame, so that every run renders the same frames
+        Clock::useVirtualTime(1.0 / options.frameRate);
+    }
+    else {
+        // Initialize GLFW
+        glfwInit();
+
+        // Get the primary monitor and its video mode
+        GLFWmonitor* primaryMonitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(primaryMonitor);
+
+        // Create a full-screen window with the monitor's resolution. Configure GLFW for OpenGL version 4.3, for the indirect
+        // submission, and fall back to 3.3 if the driver has no 4.3
+        const int versions[][2] = { { 4, 3 }, { 3, 3 } };
+        for (const int* version : versions) {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            window = glfwCreateWindow(mode->width, mode->height, "OpenGL Project: Solar System", primaryMonitor, NULL);
+            if (window != NULL) {
+                break;
+            }
+        }
+        if (window == NULL) {
+            std::cerr << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        glfwMakeContextCurrent(window);
+
+        // Initialize GLAD
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+
+        // Set the viewport to cover the full window
+        glViewport(0, 0, mode->width, mode->height);
     }
 
     // Enable Depth Testing
     glEnable(GL_DEPTH_TEST);
 
-    // Set the viewport to cover the full window
-    glViewport(0, 0, mode->width, mode->height);
+    // Release every model before the GL context is destroyed by glfwTerminate()
+    {
+
+        // Measure the time spent loading the scene
+        std::chrono::steady_clock::time_point loadStartTime = std::chrono::steady_clock::now();
+
+        // Create the cache through which all models share their meshes, textures and shader programs
+        ResourceCache resources;
+        if (options.meshCache == "off") {
+            resources.setMeshCacheMode(MeshCacheMode::Disabled);
+        }
+        else if (options.meshCache == "rebuild") {
+            resources.setMeshCacheMode(MeshCacheMode::Rebuild);
+        }
+        if (options.packedVertices) {
+            resources.setVertexFormat(VertexFormat::Packed);
+        }
+        if (options.textureCache == "off") {
+            resources.setTextureCacheMode(TextureCacheMode::Disabled);
+        }
+        else if (options.textureCache == "rebuild") {
+            resources.setTextureCacheMode(TextureCacheMode::Rebuild);
+        }
+        if (options.compressedTextures) {
+            resources.setTextureCompression(TextureCompression::Bc1);
+        }
+        if (options.shaderCache == "off") {
+            resources.setShaderCacheMode(ShaderCacheMode::Disabled, "./shader-cache");
+        }
+        else {
+            resources.setShaderCacheMode(options.shaderCache == "rebuild" ? ShaderCacheMode::Rebuild : ShaderCacheMode::Enabled, "./shader-cache");
+        }
+
+        // Decode the meshes and images on worker threads, and draw the first frames while they load. Headless runs load them
+        // before the first frame by default, so that every frame they dump is complete
+        bool isLoadingAsync = options.loading.empty() ? !options.headless : options.loading == "async";
+        std::unique_ptr<AssetLoader> assetLoader;
+        if (isLoadingAsync) {
+            assetLoader = std::make_unique<AssetLoader>();
+            resources.setAssetLoader(assetLoader.get());
+        }
+
+        // With --meshes procedural, generate the round bodies instead of loading their object files, in about the same place and with
+        // about the same texture mapping. The object files are then ignored, even if they are edited
+        if (options.proceduralMeshes) {
 
-    // Create an instance of SunModel
-    SunModel sunModel("./assets/sun/sun.obj", "./code/sun/SunVertexShader.glsl", "./code/sun/SunFragmentShader.glsl", "./assets/sun/sun.jpg");
+            // The Sun's object file is a UV sphere of 128 meridians and rings, of radius 1 around (1, 0.83, 0.92)
+            SphereDescription sunSphere;
+            sunSphere.kind = SphereKind::Uv;
+            sunSphere.segments = 128;
+            sunSphere.levelCount = 5;
+            sunSphere.placement = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.8306f, 0.9244f));
+            resources.defineSphere("./assets/sun/sun.obj", sunSphere);
 
-    // Create an instance of EarthModel
-    EarthModel earthModel("./assets/earth/Earth.obj", "./code/earth/EarthVertexShader.glsl", "./code/earth/EarthFragmentShader.glsl", "./assets/earth/Earth.png");
+            // The others are cube spheres of 8 x 8 quads per face, of radius 3.389. The columns below are where the cube's
+            // x, y (north pole of the cube-net textures) and z axes point in their object files, fitted to their vertices
+            SphereDescription bodySphere;
+            bodySphere.kind = SphereKind::Cube;
+            bodySphere.segments = 8;
+            bodySphere.levelCount = 3;
+            bodySphere.placement = glm::mat4(glm::mat3(
+                glm::vec3(-0.81209f, 0.48708f, -0.32135f),
+                glm::vec3(0.45908f, 0.19333f, -0.86711f),
+                glm::vec3(-0.36022f, -0.85169f, -0.38061f)) * 3.389152f);
+            resources.defineSphere("./assets/earth/Earth.obj", bodySphere);
+            resources.defineSphere("./assets/moon/Moon.obj", bodySphere);
+            resources.defineSphere("./assets/planet/Planet.obj", bodySphere);
+        }
+
+        // Create an instance of SunModel
+        SunModel sunModel(resources, "./assets/sun/sun.obj", Material::Emissive, "./assets/sun/sun.jpg");
+
+        // Create an instance of EarthModel
+        EarthModel earthModel(resources, "./assets/earth/Earth.obj", Material::Lit, "./assets/earth/Earth.png");
     
-    // Create an instance of MoonModel
-    MoonModel moonModel("./assets/moon/Moon.obj", "./code/moon/MoonVertexShader.glsl", "./code/moon/MoonFragmentShader.glsl", "./assets/moon/Moon.png");
+        // Create an instance of MoonModel
+        MoonModel moonModel(resources, "./assets/moon/Moon.obj", Material::Lit, "./assets/moon/Moon.png");
 
 
-    // Create an array to store the skins of the stars
-    std::vector<std::string> planetLinks = { "./assets/planet/Planet_1.png", "./assets/planet/Planet_2.png", "./assets/planet/Planet_3.png" };
+        // Create an array to store the skins of the stars
+        std::vector<std::string> planetLinks = { "./assets/planet/Planet_1.png", "./assets/planet/Planet_2.png", "./assets/planet/Planet_3.png" };
     
-    // Create an array to store the planets
-    std::vector<PlanetModel> planets;
-    unsigned int totalPlanets = 5;
-    srand(static_cast<unsigned int>(time(nullptr)));
-    for (unsigned int i = 0; i < totalPlanets; ++i) {
-        // Pass the vector of texture paths to the constructor
-        PlanetModel planetModel("./assets/planet/Planet.obj", "./code/planet/PlanetVertexShader.glsl", "./code/planet/PlanetFragmentShader.glsl", planetLinks);
-        planets.push_back(planetModel);
-    }
+        // Create the planets, either as a single instanced field or as one model per planet. Only the path in use acquires its mesh, program and skins
+        unsigned int totalPlanets = options.totalPlanets;
+        // Headless runs always place the planets the same way, unless asked for another seed. Replays use the recorded seed
+        unsigned int seed = isReplaying ? replayLog.seed : options.seed;
+        if (seed == 0) {
+            seed = options.headless ? 1u : static_cast<unsigned int>(time(nullptr));
+        }
+        srand(seed);
+        std::vector<std::unique_ptr<PlanetModel>> planets;
+        std::unique_ptr<PlanetField> planetField;
+        if (options.instancedPlanets) {
+            planetField = std::make_unique<PlanetField>(resources, "./assets/planet/Planet.obj", Material::LitInstanced, planetLinks, totalPlanets);
+        }
+        else {
+            planets.reserve(totalPlanets);
+            for (unsigned int i = 0; i < totalPlanets; ++i) {
+                // Pass the vector of texture paths to the constructor
+                planets.push_back(std::make_unique<PlanetModel>(resources, "./assets/planet/Planet.obj", Material::LitSkinArray, planetLinks));
+            }
+            PlanetModel::computeTransforms(planets);
+        }
+
+        // The per-object planets never move either, so they are culled through a hierarchy over their spheres, like the field's.
+        // The spheres come from the mesh, so the hierarchy is built once every planet is loaded, and the planets are drawn from then on
+        BoundingVolumeHierarchy planetHierarchy;
+        std::vector<uint32_t> visiblePlanets;
+        bool isPlanetHierarchyBuilt = false;
+        auto buildPlanetHierarchy = [&]() {
+            if (isPlanetHierarchyBuilt || !std::all_of(planets.begin(), planets.end(), [](const std::unique_ptr<PlanetModel>& planet) { return planet->isLoaded(); })) {
+                return;
+            }
+            std::vector<BoundingSphere> planetSpheres;
+            planetSpheres.reserve(planets.size());
+            for (const std::unique_ptr<PlanetModel>& planet : planets) {
+                planetSpheres.push_back(planet->worldBounds());
+            }
+            planetHierarchy.build(planetSpheres);
+            visiblePlanets.reserve(planets.size());
+            isPlanetHierarchyBuilt = true;
+        };
+        buildPlanetHierarchy();
+
+        // Time from the start of loading to the end of the first frame, and until every asset is uploaded. Once everything is
+        // loaded, report how many loads the cache saved, and how long loading took
+        double firstFrameMilliseconds = 0.0;
+        double loadedMilliseconds = 0.0;
+        auto reportLoaded = [&]() {
+            loadedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count();
+            resources.printReport(std::cout);
+            std::cout << "Loaded the scene in " << loadedMilliseconds << " ms" << std::endl;
+        };
+        if (assetLoader) {
+            std::cout << "Requested the scene in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count()
+                      << " ms, " << assetLoader->pendingCount() << " assets loading on " << assetLoader->workerCount() << " threads" << std::endl;
+        }
+        else {
+            reportLoaded();
+        }
+
+        // Submit the scene with a few multi-draw indirect calls when the context supports them, unless asked for one call per object
+        std::unique_ptr<IndirectRenderer> indirectRenderer;
+        if (options.drawSubmission != "direct") {
+            if (IndirectRenderer::isSupported()) {
+                indirectRenderer = std::make_unique<IndirectRenderer>(resources);
+            }
+            else if (options.drawSubmission == "indirect") {
+                std::cerr << "ERROR::MAIN::INDIRECT_SUBMISSION_UNSUPPORTED: OpenGL 4.3 is required, drawing one object at a time" << std::endl;
+            }
+        }
 
-    // Create an instance for the camera - window , initial position , initial up-vector, initial yaw (x-axis angle) , initial pitch (y-axis angle)
-    Camera camera(window, glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
+        // Otherwise the models submit their draws to a render queue, which orders them by state and binds through a tracker
+        // skipping the binds already in effect
+        RenderQueue renderQueue;
+        renderQueue.setStateSorting(options.stateSorting);
+        StateTracker renderState;
 
-    // Render loop
-    while (!glfwWindowShouldClose(window)) {
+        // Create an instance for the camera - window , initial position , initial up-vector, initial yaw (x-axis angle) , initial pitch (y-axis angle)
+        Camera camera(window, glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
+
+        // Gravitational simulation moving the sun, earth and moon, and optionally asteroids loading it
+        Simulation simulation;
+        SolarSystemBodies solarSystem = addSolarSystem(simulation);
+        addAsteroidBelt(simulation, options.asteroids, seed);
+
+        // With a date, the ephemeris places the Sun, Earth and Moon from that date on, advanced by the simulated time
+        double ephemerisStartDate = 0.0;
+        bool isEphemerisShown = !options.date.empty() && parseJulianDate(options.date, ephemerisStartDate);
+        simulation.setGravitySolver(options.solver == "barnes-hut" ? GravitySolver::BarnesHut : GravitySolver::Direct, options.openingAngle);
+        std::unique_ptr<ThreadPool> simulationPool;
+        if (options.asteroids > 0) {
+            simulationPool = std::make_unique<ThreadPool>(options.threads > 0 ? options.threads - 1 : ThreadPool::defaultWorkerCount());
+            simulation.setThreadPool(simulationPool.get());
+        }
 
-        // If ESCAPE was pressed..
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-            // Exit the render loop
-            glfwSetWindowShouldClose(window, GLFW_TRUE);
-            break;
+        // Step it with a fixed time step, on its own thread unless disabled. Headless, recorded and replayed runs step it
+        // in the render loop, by the virtual or recorded clock, so that every run goes through the same states
+        bool isRecording = !options.recordFile.empty();
+        bool isSimulationThreaded = options.simulationThread && !options.headless && !isRecording && !isReplaying;
+        SimulationThread simulationThread(simulation, 1.0 / 240.0);
+        simulationThread.setTimeWarp(options.timeWarp);
+        if (isSimulationThreaded) {
+            simulationThread.start();
         }
+        double lastSimulationTime = Clock::now();
+        bool wasSpacePressed = false, wasSlowerPressed = false, wasFasterPressed = false;
+
+        // Seed and inputs of every frame, saved after the run when recording
+        InputLog recordLog;
+        recordLog.seed = seed;
+
+        // Hierarchy of the bodies, following the simulation. Their meshes are placed on the bodies by the batch transform kernel
+        SceneGraph sceneGraph;
+        uint32_t sunNode = sceneGraph.addNode(SceneGraph::noParent);
+        uint32_t earthNode = sceneGraph.addNode(SceneGraph::noParent);
+        uint32_t moonNode = sceneGraph.addNode(earthNode);
+
+        // Placements of the sun, earth and moon meshes, and their model and normal matrices, refilled every frame
+        TransformBatch bodyBatch;
+        bodyBatch.resize(3);
+        std::vector<BodyTransform> bodyTransforms;
+
+        // Uniform buffer through which every shader program reads the camera of the frame
+        CameraUniforms cameraUniforms;
+
+        // Scripted camera movement, replacing the keyboard in headless mode
+        CameraPath cameraPath;
+        if (options.headless && !options.cameraPath.empty()) {
+            cameraPath.load(options.cameraPath);
+        }
+        if (options.headless && !options.dumpDirectory.empty()) {
+            std::filesystem::create_directories(options.dumpDirectory);
+        }
+
+        // CPU and GPU time of every frame
+        FrameTimer frameTimer;
+        if (window && options.benchmarkFrames > 0) {
+            // Do not wait for the vertical blank, so that the measured time is the actual cost of a frame
+            glfwSwapInterval(0);
+        }
+
+        // Render loop: the recorded frames when replaying, a fixed number of frames in headless mode, until the window closes otherwise
+        unsigned int frame = 0;
+        double startTime = Clock::now();
+        auto keepRendering = [&]() {
+            if (window && glfwWindowShouldClose(window)) {
+                return false;
+            }
+            if (isReplaying) {
+                return frame < replayLog.frameCount();
+            }
+            return !options.headless || frame < options.frames;
+        };
+        while (keepRendering()) {
+
+            // If ESCAPE was pressed..
+            if (window && glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+                // Exit the render loop
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+                break;
+            }
+
+            frameTimer.beginFrame();
+            PROFILE_BEGIN_FRAME();
+
+            // Upload the assets decoded since the last frame, so that their models appear in this one
+            if (assetLoader && loadedMilliseconds == 0.0) {
+                PROFILE_SCOPE("Asset uploads");
+                assetLoader->runCompletions();
+                if (assetLoader->pendingCount() == 0) {
+                    reportLoaded();
+                }
+            }
+
+            // Clear color and depth buffers to prevent old data from affecting the new frame
+            glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+
+            // SPACE pauses and resumes the simulation, '[' and ']' halve and double its time warp. Unless it runs on its own thread,
+            // advance it by the time elapsed since the last frame. Replays take all of these from the log instead.
+            // Then pick up the latest positions, without waiting for a step in progress
+            InputFrame input;
+            {
+                PROFILE_SCOPE("Simulation");
+                if (isReplaying) {
+                    input = replayLog.frame(frame);
+                }
+                else {
+                    bool isSpacePressed = window && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+                    bool isSlowerPressed = window && glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS;
+                    bool isFasterPressed = window && glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS;
+                    if (isSpacePressed && !wasSpacePressed) {
+                        simulationThread.setPaused(!simulationThread.isPaused());
+                    }
+                    if (isSlowerPressed && !wasSlowerPressed) {
+                        simulationThread.setTimeWarp(std::max(simulationThread.timeWarp() * 0.5, 1.0 / 16.0));
+                    }
+                    if (isFasterPressed && !wasFasterPressed) {
+                        simulationThread.setTimeWarp(std::min(simulationThread.timeWarp() * 2.0, 64.0));
+                    }
+                    wasSpacePressed = isSpacePressed;
+                    wasSlowerPressed = isSlowerPressed;
+                    wasFasterPressed = isFasterPressed;
 
-        // Clear color and depth buffers to prevent old data from affecting the new frame
-        glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+                    double currentTime = Clock::now();
+                    input.elapsedTime = currentTime - lastSimulationTime;
+                    input.timeWarp = simulationThread.timeWarp();
+                    input.paused = simulationThread.isPaused();
+                    lastSimulationTime = currentTime;
+                }
 
-        // Update the camera's position
-        camera.update();
-        glm::mat4 viewMatrix = camera.getViewMatrix();
+                simulationThread.setPaused(input.paused);
+                simulationThread.setTimeWarp(input.timeWarp);
+                if (!simulationThread.isRunning()) {
+                    simulationThread.advance(input.elapsedTime);
+                }
+                simulationThread.update();
+            }
+
+            // Follow the recorded camera when replaying, or the camera path in headless mode, then update the camera's position
+            // and upload it once for all the programs. Its frustum culls the objects of the frame, unless culling is disabled,
+            // and its projection chooses their levels of detail
+            Frustum frustum;
+            LevelOfDetailView lodView;
+            lodView.maxPixelError = options.lodError;
+            {
+                PROFILE_SCOPE("Camera update");
+                if (isReplaying) {
+                    camera.setOrientation(input.yaw, input.pitch);
+                }
+                else {
+                    if (options.headless) {
+                        float yaw, pitch;
+                        cameraPath.sample(static_cast<float>(Clock::now()), yaw, pitch);
+                        camera.setOrientation(yaw, pitch);
+                    }
+                    camera.update();
+                }
+
+                if (isRecording) {
+                    input.yaw = camera.getYaw();
+                    input.pitch = camera.getPitch();
+                    recordLog.record(input);
+                }
+
+                // Follow the size of the window's framebuffer, so that resizes keep the right aspect ratio
+                int framebufferWidth = options.width, framebufferHeight = options.height;
+                if (window) {
+                    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+                    glViewport(0, 0, framebufferWidth, framebufferHeight);
+                }
+                float aspectRatio = framebufferHeight > 0 ? static_cast<float>(framebufferWidth) / static_cast<float>(framebufferHeight) : 1.0f;
+
+                glm::mat4 view = camera.getViewMatrix();
+                glm::mat4 projection = camera.getProjectionMatrix(aspectRatio);
+                cameraUniforms.update(view, projection, camera.getPosition());
+                if (options.culling) {
+                    frustum = Frustum(projection * view);
+                }
+                lodView.cameraPosition = camera.getPosition();
+                lodView.pixelsPerUnit = 0.5f * static_cast<float>(framebufferHeight) * projection[1][1];
+            }
+
+            // Place the bodies in the scene graph between their last two simulated states, at the fraction of the next step already elapsed.
+            // The moon is placed relative to the earth. Each mesh is then placed on its body, with its spin and scale, by one call of the batch
+            // transform kernel, whose matrices are drawn as they are
+            {
+                PROFILE_SCOPE("Scene graph");
+                const SimulationSnapshot& bodies = simulationThread.snapshot();
+                float alpha = simulationThread.interpolationAlpha();
+                double simulatedTime = bodies.interpolatedTime(alpha);
+                SolarSystemPlacement placement;
+                if (isEphemerisShown) {
+                    placement = ephemerisPlacement(computeEphemeris(ephemerisStartDate + simulatedTime * ephemerisDaysPerSecond));
+                }
+                else {
+                    placement.sun = bodies.position(solarSystem.sun, alpha);
+                    placement.earth = bodies.position(solarSystem.earth, alpha);
+                    placement.moon = bodies.position(solarSystem.moon, alpha);
+                }
+                sceneGraph.setLocalMatrix(sunNode, glm::translate(glm::mat4(1.0f), placement.sun));
+                sceneGraph.setLocalMatrix(earthNode, glm::translate(glm::mat4(1.0f), placement.earth));
+                sceneGraph.setLocalMatrix(moonNode, glm::translate(glm::mat4(1.0f), placement.moon - placement.earth));
+                sceneGraph.updateWorldMatrices();
+                sunModel.placeMesh(bodyBatch, 0, glm::vec3(sceneGraph.worldMatrix(sunNode)[3]));
+                earthModel.placeMesh(bodyBatch, 1, glm::vec3(sceneGraph.worldMatrix(earthNode)[3]), simulatedTime);
+                moonModel.placeMesh(bodyBatch, 2, glm::vec3(sceneGraph.worldMatrix(moonNode)[3]), simulatedTime);
+                computeBatchTransforms(bodyBatch, bodyTransforms);
+            }
+
+            // Render the sun, earth, moon and the random planets whose bounding spheres intersect the frustum, each at the level of
+            // detail its size on the screen needs, counting the objects skipped, the triangles drawn, the draw calls and the binds, and
+            // bounding the error of the packed vertices on the screen. The objects are queued, then drawn all at once by the indirect
+            // renderer's submit() or the render queue's execute(). The CPU time spent culling and submitting is measured for both paths
+            CullingCounters counters;
+            std::chrono::steady_clock::time_point submissionStartTime = std::chrono::steady_clock::now();
+            auto renderBody = [&](auto& model, const BodyTransform& transform) {
+                // Bodies still loading are neither drawn nor counted
+                if (!model.isLoaded()) {
+                    return;
+                }
+                BoundingSphere worldBounds = transformBoundingSphere(model.bounds(), transform.model);
+                if (!frustum.intersects(worldBounds)) {
+                    ++counters.culled;
+                    return;
+                }
+                ++counters.visible;
+                model.selectLevel(lodView, worldBounds);
+                if (indirectRenderer) {
+                    model.queueDraw(*indirectRenderer, transform);
+                }
+                else {
+                    model.render(renderQueue, transform);
+                }
+                counters.triangles += model.triangleCount();
+                counters.addVertexError(model.quantizationError(), lodView.projectedRadius(worldBounds));
+            };
+            renderBody(sunModel, bodyTransforms[0]);
+            renderBody(earthModel, bodyTransforms[1]);
+            renderBody(moonModel, bodyTransforms[2]);
+            {
+                PROFILE_SCOPE("Planets");
+                buildPlanetHierarchy();
+                if (!planets.empty() && isPlanetHierarchyBuilt) {
+                    visiblePlanets.clear();
+                    planetHierarchy.query(frustum, visiblePlanets);
+                    counters.visible += static_cast<unsigned int>(visiblePlanets.size());
+                    counters.culled += static_cast<unsigned int>(planets.size() - visiblePlanets.size());
+                    for (uint32_t planet : visiblePlanets) {
+                        planets[planet]->selectLevel(lodView, planets[planet]->worldBounds());
+                        if (indirectRenderer) {
+                            planets[planet]->queueDraw(*indirectRenderer);
+                        }
+                        else {
+                            planets[planet]->render(renderQueue);
+                        }
+                        counters.triangles += planets[planet]->triangleCount();
+                        counters.addVertexError(planets[planet]->quantizationError(), lodView.projectedRadius(planets[planet]->worldBounds()));
+                    }
+                }
+                if (indirectRenderer && planetField) {
+                    planetField->queueDraws(frustum, lodView, counters, *indirectRenderer);
+                }
+            }
+            if (indirectRenderer) {
+                indirectRenderer->submit(counters);
+            }
+            else {
+                // The field draws after the queue, binding through the same tracker, and everything is unbound once at the end
+                renderQueue.execute(renderState, counters);
+                if (planetField) {
+                    planetField->render(frustum, lodView, renderState, counters);
+                }
+                renderState.reset();
+                counters.stateChanges += renderState.takeChangeCount();
+            }
+            frameTimer.recordSubmission(counters.drawCalls, counters.stateChanges, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submissionStartTime).count());
+            frameTimer.recordCounts(counters.visible, counters.culled, counters.triangles, counters.vertexErrorPixels);
+
+            frameTimer.endFrame();
+
+            if (options.headless) {
+                // Dump the frame, then move the virtual clock to the next one
+                if (!options.dumpDirectory.empty() && frame % options.dumpEvery == 0) {
+                    PROFILE_SCOPE("Frame dump");
+                    char fileName[32];
+                    std::snprintf(fileName, sizeof(fileName), "frame_%05u.png", frame);
+                    headless.saveFrame((std::filesystem::path(options.dumpDirectory) / fileName).string());
+                }
+                Clock::advance();
+            }
+            else {
+                // Swap the buffers
+                PROFILE_SCOPE("glfwSwapBuffers");
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            }
+
+            PROFILE_END_FRAME();
+
+            if (frame == 0) {
+                firstFrameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count();
+                std::cout << "Drew the first frame after " << firstFrameMilliseconds << " ms" << std::endl;
+            }
+
+            // Stop after the benchmarked frames
+            ++frame;
+            if (window && options.benchmarkFrames > 0 && frame == options.benchmarkFrames) {
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
 
-        // Render the sun, earth, moon and the random planets, given the camera's current position
-        sunModel.render(viewMatrix);
-        earthModel.render(viewMatrix);
-        moonModel.render(earthModel.getEarthPosition(), viewMatrix);
-        for (PlanetModel& planet : planets) {
-            planet.render(viewMatrix); 
         }
 
-        // Swap the buffers
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Report the frame timings and simulation rate of benchmark and headless runs
+        double runTime = Clock::now() - startTime;
+        simulationThread.stop();
+        frameTimer.finish();
+        if (options.headless || options.benchmarkFrames > 0) {
+            std::cout << "Benchmark: " << totalPlanets << " planets, " << (options.instancedPlanets ? "instanced" : "per-object") << " path, "
+                      << (indirectRenderer ? "indirect" : options.stateSorting ? "direct state-sorted" : "direct unsorted") << " submission, " << frameTimer.frameCount() << " frames" << std::endl;
+            frameTimer.printSummary(std::cout);
+            std::cout << "Startup (" << (assetLoader ? "async" : "serial") << " loading): first frame after " << firstFrameMilliseconds << " ms, fully loaded after ";
+            if (loadedMilliseconds > 0.0) {
+                std::cout << loadedMilliseconds << " ms" << std::endl;
+            }
+            else {
+                std::cout << "more than the run" << std::endl;
+            }
+            unsigned long steps = simulationThread.stepCount();
+            std::cout << std::fixed << std::setprecision(3)
+                      << "Simulation (" << (isSimulationThreaded ? "own thread" : "render loop") << ", "
+                      << simulation.bodyCount() << " bodies): " << steps << " steps, " << steps / runTime << " steps/s of 240, "
+                      << (steps > 0 ? simulationThread.busySeconds() * 1000.0 / steps : 0.0) << " ms per step"
+                      << std::defaultfloat << std::endl;
+        }
+
+        // Save the recorded inputs, and print the final state, which a replay must reproduce bit for bit
+        if (isRecording) {
+            recordLog.save(options.recordFile);
+        }
+        if (isRecording || isReplaying) {
+            std::cout << "Simulation state after " << simulationThread.stepCount() << " steps: hash " << std::hex << simulation.stateHash() << std::dec << std::endl;
+        }
+
+        // Report the profiled scopes
+#ifdef SOLAR_SYSTEM_PROFILING
+        Profiler::finish();
+        Profiler::printReport(std::cout);
+        if (!options.profileTrace.empty()) {
+            Profiler::writeTrace(options.profileTrace);
+        }
+#else
+        if (!options.profileTrace.empty()) {
+            std::cerr << "ERROR::MAIN::PROFILING_DISABLED: rebuild with SOLAR_SYSTEM_PROFILING defined to write " << options.profileTrace << std::endl;
+        }
+#endif
+        if (!options.timingsFile.empty()) {
+            std::ofstream timings(options.timingsFile);
+            if (timings) {
+                frameTimer.writeCsv(timings);
+            }
+            else {
+                std::cerr << "ERROR::MAIN::TIMINGS_FILE_NOT_WRITABLE: " << options.timingsFile << std::endl;
+            }
+        }
 
     }
 
     // Terminate the program, clearing all the previously allocated GLFW resources
-    glfwTerminate();
+    if (window) {
+        glfwTerminate();
+    }
     return 0;
 
 }